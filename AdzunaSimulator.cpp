@@ -0,0 +1,334 @@
+// Local Adzuna stand-in
+// Serves /v1/api/jobs/{country}/search/{page} with the same JSON shape as the real API, from a recorded
+// response or from synthetic jobs, so the search pipeline can be measured without network access or quota.
+// Like the API, it filters on what=, salary_min=, salary_max= and max_days_old= and sorts by date for sort_by=date.
+// Point the application at it with a base_url=http://localhost:8080 line in config.ini.
+//
+// Usage: AdzunaSimulator [--port 8080] [--fixture response.json] [--jobs 5000] [--seed 1] [--ignore-query]
+//                        [--latency 150] [--jitter 50] [--slow-rate 0.05 --slow-ms 2000] [--bandwidth 512]
+//                        [--error-rate 0.01] [--rate-limit 25] [--threads 64] [--verbose]
+
+#include "SyntheticData.h"
+// Includes the synthetic job generator used when no fixture is given
+
+#include <httplib.h>
+// Includes the HTTP server
+
+#include <json.hpp>
+// Includes the JSON library for reading fixtures and writing responses
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct SimulatorOptions {
+        int port = 8080;
+        const char* fixturePath = nullptr;
+        size_t syntheticJobs = 5000;
+        uint32_t seed = 1;
+        bool ignoreQuery = false;
+        int latencyMs = 0;
+        int jitterMs = 0;
+        double slowRate = 0.0;
+        int slowMs = 1000;
+        // Fraction of responses held back slowMs longer, the latency tail hedged requests are meant to cut
+        int bandwidthKBps = 0;
+        double errorRate = 0.0;
+        double rateLimit = 0.0;
+        int threads = 64;
+        bool verbose = false;
+    };
+    // Command-line settings of the simulator
+
+    struct ListedJob {
+        std::string json;
+        // The result object, serialized once up front so a response is a string concatenation
+        std::string searchText;
+        // Lowercase title and description, matched against the what= words
+        double salaryMin;
+        double salaryMax;
+        // Salary range, for the salary_min/salary_max filters
+        std::string created;
+        // Posting time ("2024-01-01T00:00:00Z"), for max_days_old and sort_by=date; these sort as strings
+    };
+    // One job of the served corpus
+
+    class TokenBucket {
+    public:
+        explicit TokenBucket(double ratePerSecond)
+            : rate(ratePerSecond), capacity(std::max(1.0, ratePerSecond)), tokens(capacity), last(std::chrono::steady_clock::now()) {}
+        // A bucket that refills at the given rate and holds at most one second of requests (at least one)
+
+        bool take() {
+            // Function to take a token; false when the client is over the rate limit
+            if (rate <= 0.0) return true;
+            std::lock_guard<std::mutex> lock(mutex);
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            tokens = std::min(capacity, tokens + std::chrono::duration<double>(now - last).count() * rate);
+            last = now;
+            if (tokens < 1.0) return false;
+            tokens -= 1.0;
+            return true;
+        }
+
+    private:
+        const double rate;
+        const double capacity;
+        double tokens;
+        std::chrono::steady_clock::time_point last;
+        std::mutex mutex;
+    };
+    // Request throttling, answered with 429 like the real API does when the quota runs out
+
+    std::string toLower(std::string text) {
+        // Function to lowercase ASCII letters
+        for (char& c : text) c = (char)std::tolower((unsigned char)c);
+        return text;
+    }
+
+    ListedJob listJob(const nlohmann::json& result) {
+        // Function to index one result object of the corpus
+        ListedJob listed;
+        listed.json = result.dump();
+        listed.searchText = toLower(result.value("title", "") + " " + result.value("description", ""));
+        listed.salaryMin = result.value("salary_min", 0.0);
+        listed.salaryMax = result.value("salary_max", listed.salaryMin);
+        listed.created = result.value("created", "");
+        return listed;
+    }
+
+    std::vector<ListedJob> loadFixture(const char* path) {
+        // Function to load the results of a recorded API response
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error(std::string("Unable to open fixture ") + path);
+        }
+        nlohmann::json response = nlohmann::json::parse(file);
+
+        std::vector<ListedJob> corpus;
+        for (const nlohmann::json& result : response.at("results")) {
+            corpus.push_back(listJob(result));
+        }
+        return corpus;
+    }
+
+    std::vector<ListedJob> makeSyntheticCorpus(size_t count, uint32_t seed) {
+        // Function to turn synthetic jobs into Adzuna result objects
+        std::vector<Job> jobs = generateJobs(count, seed);
+        std::vector<ListedJob> corpus;
+        corpus.reserve(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++) {
+            ListedJob listed;
+            listed.json = makeAdzunaResult(jobs[i], i);
+            listed.searchText = toLower(jobs[i].title + " " + jobs[i].description);
+            listed.salaryMin = jobs[i].salary;
+            listed.salaryMax = jobs[i].salary;
+            listed.created = jobs[i].created;
+            corpus.push_back(std::move(listed));
+        }
+        return corpus;
+    }
+
+    bool matches(const ListedJob& job, const std::vector<std::string>& words, double salaryMin, double salaryMax) {
+        // Function to apply the what= words and the salary filters to one job
+        for (const std::string& word : words) {
+            if (job.searchText.find(word) == std::string::npos) return false;
+        }
+        if (salaryMin > 0.0 && job.salaryMax < salaryMin) return false;
+        if (salaryMax > 0.0 && (job.salaryMin == 0.0 || job.salaryMin > salaryMax)) return false;
+        return true;
+    }
+
+    double parameter(const httplib::Request& req, const char* name, double fallback) {
+        // Function to read a numeric query parameter
+        return req.has_param(name) ? std::atof(req.get_param_value(name).c_str()) : fallback;
+    }
+
+    void sendBody(httplib::Response& res, std::string body, int bandwidthKBps) {
+        // Function to send a response body, paced to the simulated bandwidth
+        if (bandwidthKBps <= 0) {
+            res.set_content(body, "application/json");
+            return;
+        }
+
+        std::shared_ptr<std::string> shared = std::make_shared<std::string>(std::move(body));
+        const size_t chunk = 4096;
+        res.set_content_provider(shared->size(), "application/json",
+            [shared, chunk, bandwidthKBps](size_t offset, size_t length, httplib::DataSink& sink) {
+                size_t size = std::min(chunk, length);
+                std::this_thread::sleep_for(std::chrono::microseconds((long long)size * 1000000 / ((long long)bandwidthKBps * 1024)));
+                return sink.write(shared->data() + offset, size);
+            });
+    }
+}
+
+int main(int argc, char** argv) {
+    SimulatorOptions options;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--ignore-query") == 0) options.ignoreQuery = true;
+        else if (std::strcmp(arg, "--verbose") == 0) options.verbose = true;
+        else if (!value) {
+            std::fprintf(stderr, "Usage: %s [--port 8080] [--fixture response.json] [--jobs 5000] [--seed 1] [--ignore-query]\n"
+                "  [--latency ms] [--jitter ms] [--slow-rate 0..1] [--slow-ms ms] [--bandwidth KB/s] [--error-rate 0..1] [--rate-limit requests/s] [--threads 64] [--verbose]\n", argv[0]);
+            return 1;
+        }
+        else if (std::strcmp(arg, "--port") == 0) options.port = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--fixture") == 0) options.fixturePath = argv[++i];
+        else if (std::strcmp(arg, "--jobs") == 0) options.syntheticJobs = (size_t)std::atol(argv[++i]);
+        else if (std::strcmp(arg, "--seed") == 0) options.seed = (uint32_t)std::atol(argv[++i]);
+        else if (std::strcmp(arg, "--latency") == 0) options.latencyMs = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--jitter") == 0) options.jitterMs = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--slow-rate") == 0) options.slowRate = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--slow-ms") == 0) options.slowMs = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bandwidth") == 0) options.bandwidthKBps = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--error-rate") == 0) options.errorRate = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--rate-limit") == 0) options.rateLimit = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--threads") == 0) options.threads = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            return 1;
+        }
+    }
+    // Parse the command line
+
+    std::vector<ListedJob> corpus;
+    try {
+        corpus = options.fixturePath ? loadFixture(options.fixturePath) : makeSyntheticCorpus(options.syntheticJobs, options.seed);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    // The same corpus is served for every country
+
+    std::vector<const ListedJob*> byDate;
+    for (const ListedJob& job : corpus) byDate.push_back(&job);
+    std::stable_sort(byDate.begin(), byDate.end(), [](const ListedJob* a, const ListedJob* b) { return a->created > b->created; });
+    // The corpus newest first, for sort_by=date
+
+    TokenBucket throttle(options.rateLimit);
+    std::mutex randomMutex;
+    std::mt19937 random(options.seed);
+    std::atomic<long> requestCount(0);
+
+    httplib::Server server;
+    int threads = options.threads;
+    server.new_task_queue = [threads] { return new httplib::ThreadPool(threads); };
+    // Simulated latency parks a thread per request, so the pool must cover the concurrency under test
+
+    server.Get(R"(/v1/api/jobs/([a-z]{2})/search/(\d+))", [&](const httplib::Request& req, httplib::Response& res) {
+        long id = ++requestCount;
+
+        int delayMs = options.latencyMs;
+        bool fail = false;
+        {
+            std::lock_guard<std::mutex> lock(randomMutex);
+            if (options.jitterMs > 0) {
+                delayMs += std::uniform_int_distribution<int>(-options.jitterMs, options.jitterMs)(random);
+            }
+            if (options.slowRate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(random) < options.slowRate) {
+                delayMs += options.slowMs;
+            }
+            fail = options.errorRate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(random) < options.errorRate;
+        }
+        if (delayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        }
+        // Server think time before the response headers
+
+        if (!throttle.take()) {
+            res.status = 429;
+            res.set_header("Retry-After", "1");
+            res.set_content("{\"exception\":\"TOO_MANY_REQUESTS\",\"display\":\"Rate limit exceeded\"}", "application/json");
+        }
+        else if (fail) {
+            res.status = 500;
+            res.set_content("{\"exception\":\"INTERNAL_ERROR\",\"display\":\"Simulated failure\"}", "application/json");
+        }
+        else if (!req.has_param("app_id") || !req.has_param("app_key")) {
+            res.status = 401;
+            res.set_content("{\"exception\":\"AUTH_FAIL\",\"display\":\"Authorisation failed\"}", "application/json");
+        }
+        else {
+            int page = std::max(1, std::atoi(req.matches[2].str().c_str()));
+            size_t perPage = (size_t)std::max(1.0, std::min(50.0, parameter(req, "results_per_page", 10)));
+            double salaryMin = parameter(req, "salary_min", 0.0);
+            double salaryMax = parameter(req, "salary_max", 0.0);
+            int maxDaysOld = (int)parameter(req, "max_days_old", 0);
+            std::string oldest = maxDaysOld > 0 ? formatTimestamp((int64_t)std::time(nullptr) - (int64_t)maxDaysOld * 86400) : std::string();
+            bool sortByDate = req.get_param_value("sort_by") == "date";
+
+            std::vector<std::string> words;
+            if (!options.ignoreQuery) {
+                std::istringstream what(toLower(req.get_param_value("what")));
+                std::string word;
+                while (what >> word) words.push_back(word);
+            }
+
+            size_t count = 0;
+            double salaryTotal = 0.0;
+            size_t salaryCount = 0;
+            size_t first = (size_t)(page - 1) * perPage;
+            std::string results;
+            for (size_t i = 0; i < corpus.size(); i++) {
+                const ListedJob& job = sortByDate ? *byDate[i] : corpus[i];
+                if (!matches(job, words, salaryMin, salaryMax) || job.created < oldest) continue;
+                if (count >= first && count < first + perPage) {
+                    if (!results.empty()) results += ',';
+                    results += job.json;
+                }
+                count++;
+                if (job.salaryMin > 0.0) {
+                    salaryTotal += job.salaryMin;
+                    salaryCount++;
+                }
+            }
+            // Adzuna reports the total match count and mean salary alongside the requested page
+
+            std::ostringstream body;
+            body << "{\"__CLASS__\":\"Adzuna::API::Response::JobSearchResults\",\"count\":" << count
+                << ",\"mean\":" << (salaryCount > 0 ? salaryTotal / salaryCount : 0.0)
+                << ",\"results\":[" << results << "]}";
+            sendBody(res, body.str(), options.bandwidthKBps);
+        }
+
+        if (options.verbose) {
+            std::printf("#%ld %d %s\n", id, res.status, req.path.c_str());
+        }
+    });
+
+    server.set_error_handler([](const httplib::Request&, httplib::Response& res) {
+        if (res.status == 404) {
+            res.set_content("{\"exception\":\"NOT_FOUND\"}", "application/json");
+        }
+    });
+
+    std::printf("Serving %zu jobs on http://localhost:%d (latency %d+/-%d ms, %.3f slowed by %d ms, bandwidth %s, error rate %.3f, rate limit %s)\n",
+        corpus.size(), options.port, options.latencyMs, options.jitterMs, options.slowRate, options.slowMs,
+        options.bandwidthKBps > 0 ? (std::to_string(options.bandwidthKBps) + " KB/s").c_str() : "unlimited",
+        options.errorRate, options.rateLimit > 0.0 ? (std::to_string((int)options.rateLimit) + "/s").c_str() : "none");
+    std::fflush(stdout);
+
+    if (!server.listen("0.0.0.0", options.port)) {
+        std::fprintf(stderr, "Unable to listen on port %d\n", options.port);
+        return 1;
+    }
+    return 0;
+}
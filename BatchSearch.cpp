@@ -0,0 +1,335 @@
+// Headless batch search
+// Reads search specs from a JSONL file, runs them through the JobSearch engine with bounded parallelism and
+// streams one JSON line per fetched page to stdout or a file. Throughput and latency are printed at the end.
+//
+// Usage: BatchSearch <queries.jsonl | -> [--output results.jsonl] [--parallel 4] [--config config.ini] [--verbose]
+//                    [--record cassette.http | --replay cassette.http [--replay-speed 1]]
+//                    [--rate-limit 25] [--retries 3] [--hedge 0.05]
+//
+// Each input line is an object like
+//   {"query": "nurse", "country": "gb", "salary_range": "20000-40000", "results_per_page": 50, "pages": 2, "currency": "GBP"}
+// Only query and country are required; blank lines and lines starting with # are skipped.
+
+#include "JobSearch.h"
+// Includes the JobSearch class, the engine the searches run through
+
+#include "TaskScheduler.h"
+// Includes the task scheduler, sized to the requested parallelism
+
+#include <json.hpp>
+// Includes the JSON library for reading the specs and writing the results
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+    struct PendingSearch {
+        std::shared_ptr<SearchHandle> search;
+        // Handle of the search
+        size_t line;
+        // Input line the search came from
+    };
+    // A search that was started and not written yet
+
+    struct BatchStats {
+        size_t searches = 0;
+        size_t succeeded = 0;
+        size_t failed = 0;
+        size_t cancelled = 0;
+        size_t invalidLines = 0;
+        size_t jobs = 0;
+        std::vector<double> latencyMs;
+    };
+    // Totals reported at the end of the run
+
+    const char* statusName(SearchStatus status) {
+        // Function to get the name of a final search status
+        switch (status) {
+        case SearchStatusSucceeded: return "succeeded";
+        case SearchStatusFailed: return "failed";
+        case SearchStatusCancelled: return "cancelled";
+        default: return "running";
+        }
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        // Function to compute a percentile (nearest rank) of a sample
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t rank = (size_t)(p / 100.0 * (values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    }
+
+    bool parseSpec(const std::string& line, SearchRequest& request, int& pages, std::string& error) {
+        // Function to turn one JSONL line into a search request and a page count
+        try {
+            nlohmann::json spec = nlohmann::json::parse(line);
+            if (!spec.is_object()) {
+                error = "expected a JSON object";
+                return false;
+            }
+            request.query = spec.value("query", "");
+            request.country = spec.value("country", "");
+            request.salaryRange = spec.value("salary_range", "Any");
+            request.resultsPerPage = std::max(1, std::min(50, spec.value("results_per_page", 20)));
+            request.currencySymbol = spec.value("currency", "");
+            pages = std::max(1, spec.value("pages", 1));
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+            return false;
+        }
+
+        if (request.query.empty() || request.country.empty()) {
+            error = "query and country are required";
+            return false;
+        }
+        return true;
+    }
+
+    void writeResult(std::ostream& out, const PendingSearch& pending, BatchStats& stats) {
+        // Function to write one finished search as a JSON line and add it to the totals
+        const SearchHandle& search = *pending.search;
+        const SearchRequest& request = search.getRequest();
+
+        double latencyMs = 0.0;
+        for (int stage = 0; stage < SearchStageCount; stage++) {
+            latencyMs += search.getStageMs((SearchStage)stage);
+        }
+
+        nlohmann::json line;
+        line["line"] = pending.line;
+        line["query"] = request.query;
+        line["country"] = request.country;
+        line["salary_range"] = request.salaryRange;
+        line["page"] = request.page;
+        line["status"] = statusName(search.getStatus());
+        line["http_status"] = search.getHttpStatus();
+        line["latency_ms"] = latencyMs;
+        line["attempts"] = search.getAttemptCount();
+        if (!search.getError().empty()) {
+            line["error"] = search.getError();
+        }
+
+        nlohmann::json jobs = nlohmann::json::array();
+        std::shared_ptr<const std::vector<Job>> results = search.getResults();
+        for (const Job& job : *results) {
+            jobs.push_back({
+                {"title", job.title},
+                {"company", job.company},
+                {"location", job.location},
+                {"description", job.description},
+                {"salary", job.salary},
+                {"salaryCurrency", job.salaryCurrency},
+                {"contractType", job.contractType},
+                {"category", job.category},
+                {"url", job.url}
+                });
+        }
+        // Same job fields as favorites.json
+        line["jobs"] = std::move(jobs);
+
+        out << line.dump() << '\n';
+
+        stats.searches++;
+        stats.jobs += results->size();
+        stats.latencyMs.push_back(latencyMs);
+        switch (search.getStatus()) {
+        case SearchStatusSucceeded: stats.succeeded++; break;
+        case SearchStatusFailed: stats.failed++; break;
+        default: stats.cancelled++; break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    const char* configPath = "config.ini";
+    int parallel = 4;
+    bool verbose = false;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    double replaySpeed = 1.0;
+    double requestsPerMinute = -1.0;
+    int retries = -1;
+    double hedgeRatio = -1.0;
+    // Rate limiter settings; config.ini or the defaults apply unless given
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) outputPath = argv[++i];
+        else if (std::strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) parallel = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) configPath = argv[++i];
+        else if (std::strcmp(argv[i], "--verbose") == 0) verbose = true;
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc) replaySpeed = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--rate-limit") == 0 && i + 1 < argc) requestsPerMinute = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--retries") == 0 && i + 1 < argc) retries = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--hedge") == 0 && i + 1 < argc) hedgeRatio = std::atof(argv[++i]);
+        else if (!inputPath && (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0)) inputPath = argv[i];
+        else {
+            inputPath = nullptr;
+            break;
+        }
+    }
+    if (!inputPath || (recordPath && replayPath)) {
+        std::fprintf(stderr, "Usage: %s <queries.jsonl | -> [--output results.jsonl] [--parallel 4] [--config config.ini] [--verbose]\n"
+            "  [--record cassette.http | --replay cassette.http [--replay-speed 1]] [--rate-limit 25] [--retries 3] [--hedge 0.05]\n", argv[0]);
+        return 1;
+    }
+    // Parse the command line
+
+    std::ifstream inputFile;
+    if (std::strcmp(inputPath, "-") != 0) {
+        inputFile.open(inputPath);
+        if (!inputFile.is_open()) {
+            std::fprintf(stderr, "Unable to open %s\n", inputPath);
+            return 1;
+        }
+    }
+    std::istream& input = inputFile.is_open() ? inputFile : std::cin;
+
+    std::ofstream outputFile;
+    if (outputPath) {
+        outputFile.open(outputPath, std::ios::binary);
+        if (!outputFile.is_open()) {
+            std::fprintf(stderr, "Unable to open %s\n", outputPath);
+            return 1;
+        }
+    }
+    std::ostream& output = outputFile.is_open() ? outputFile : std::cout;
+
+    TaskScheduler pool((unsigned)parallel);
+    // A search blocks its worker on the network, so the pool size is the number of requests in flight
+    JobSearch engine(configPath, pool);
+    engine.setLogging(verbose);
+    if (requestsPerMinute >= 0.0) {
+        engine.setRateLimit(requestsPerMinute, 5, hedgeRatio > 0.0 ? parallel * 2 : parallel);
+    }
+    // --rate-limit 0 turns the quota off, e.g. against the local simulator; with hedging every search may have
+    // a second request out, so the ceiling leaves room for it
+    if (retries >= 0) {
+        engine.setMaxRetries(retries);
+    }
+    if (hedgeRatio >= 0.0) {
+        engine.setHedging(hedgeRatio);
+    }
+    // --hedge 0.05 lets up to 5% of the requests be hedged, --hedge 0 turns hedging off
+
+    if (recordPath || replayPath) {
+        try {
+            std::shared_ptr<HttpCassette> cassette = std::make_shared<HttpCassette>(recordPath ? recordPath : replayPath,
+                recordPath ? HttpCassette::ModeRecord : HttpCassette::ModeReplay);
+            cassette->setReplaySpeed(replaySpeed);
+            engine.setCassette(cassette);
+        }
+        catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+    // Record the responses for later runs, or replay them instead of using the network
+
+    std::mutex finishedMutex;
+    std::condition_variable finishedChanged;
+    std::deque<size_t> finished;
+    // Ids of searches that finished and have not been written yet, filled by the search callbacks
+
+    std::map<size_t, PendingSearch> inFlight;
+    size_t nextId = 0;
+    BatchStats stats;
+
+    auto drainFinished = [&](bool block) {
+        // Writes the searches that finished, waiting for at least one if requested
+        std::deque<size_t> ready;
+        {
+            std::unique_lock<std::mutex> lock(finishedMutex);
+            if (block) {
+                finishedChanged.wait(lock, [&] { return !finished.empty(); });
+            }
+            ready.swap(finished);
+        }
+        for (size_t id : ready) {
+            std::map<size_t, PendingSearch>::iterator it = inFlight.find(id);
+            it->second.search->wait();
+            // The callback runs right after the final status is stored; make sure it is visible here
+            writeResult(output, it->second, stats);
+            inFlight.erase(it);
+        }
+        output.flush();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::string text;
+    size_t lineNumber = 0;
+    while (std::getline(input, text)) {
+        lineNumber++;
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        if (text.empty() || text[0] == '#') continue;
+
+        SearchRequest request;
+        int pages = 1;
+        std::string error;
+        if (!parseSpec(text, request, pages, error)) {
+            std::fprintf(stderr, "line %zu: %s\n", lineNumber, error.c_str());
+            stats.invalidLines++;
+            continue;
+        }
+
+        for (int page = 1; page <= pages; page++) {
+            while ((int)inFlight.size() >= parallel) {
+                drainFinished(true);
+            }
+            // Bounded parallelism: wait for a slot before starting another request
+
+            request.page = page;
+            size_t id = nextId++;
+            PendingSearch pending;
+            pending.line = lineNumber;
+            pending.search = engine.searchJobs(request, [&, id](const SearchHandle&, SearchEvent event) {
+                if (event != SearchEventFinished) return;
+                {
+                    std::lock_guard<std::mutex> lock(finishedMutex);
+                    finished.push_back(id);
+                }
+                finishedChanged.notify_one();
+            });
+            inFlight[id] = pending;
+            drainFinished(false);
+        }
+    }
+
+    while (!inFlight.empty()) {
+        drainFinished(true);
+    }
+    // Write the remaining searches as they finish
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::fprintf(stderr, "\n%zu searches (%zu succeeded, %zu failed, %zu cancelled), %zu invalid lines, %zu jobs in %.2f s\n",
+        stats.searches, stats.succeeded, stats.failed, stats.cancelled, stats.invalidLines, stats.jobs, seconds);
+    std::fprintf(stderr, "Throughput: %.2f queries/s, %.1f jobs/s (parallelism %d)\n",
+        seconds > 0 ? stats.searches / seconds : 0.0, seconds > 0 ? stats.jobs / seconds : 0.0, parallel);
+    std::fprintf(stderr, "Latency: p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+        percentile(stats.latencyMs, 50), percentile(stats.latencyMs, 90), percentile(stats.latencyMs, 99),
+        percentile(stats.latencyMs, 100));
+    RateLimiterStats limiter = engine.getRateLimiterStats();
+    std::fprintf(stderr, "Requests: %ld sent, %ld throttled (429), %ld failed, %ld hedged (%ld answered first); concurrency limit %.1f\n",
+        limiter.requests, limiter.throttled, limiter.failures, limiter.hedges, limiter.hedgeWins, limiter.concurrencyLimit);
+    // The summary goes to stderr so stdout stays valid JSONL
+
+    return stats.failed > 0 ? 2 : 0;
+}
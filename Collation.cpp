@@ -0,0 +1,56 @@
+#include "Collation.h"
+// Includes the header file for the collation helpers
+
+std::string makeCollationKey(const std::string& text) {
+    // Function to fold the case of a UTF-8 string without changing its byte length
+    std::string key(text);
+    const size_t size = key.size();
+
+    for (size_t i = 0; i < size; i++) {
+        unsigned char c = (unsigned char)key[i];
+        if (c >= 'A' && c <= 'Z') {
+            key[i] = (char)(c + ('a' - 'A'));
+            // ASCII capitals
+        }
+        else if (c == 0xC3 && i + 1 < size) {
+            unsigned char next = (unsigned char)key[i + 1];
+            if (next >= 0x80 && next <= 0x9E && next != 0x97) {
+                key[i + 1] = (char)(next + 0x20);
+                // Latin-1 capitals U+00C0..U+00DE (except U+00D7, the multiplication sign)
+            }
+            i++;
+        }
+        else if (c == 0xD0 && i + 1 < size) {
+            unsigned char next = (unsigned char)key[i + 1];
+            if (next >= 0x80 && next <= 0x8F) {
+                key[i] = (char)0xD1;
+                key[i + 1] = (char)(next + 0x10);
+                // Cyrillic capitals U+0400..U+040F map to U+0450..U+045F
+            }
+            else if (next >= 0x90 && next <= 0x9F) {
+                key[i + 1] = (char)(next + 0x20);
+                // Cyrillic capitals U+0410..U+041F map to U+0430..U+043F
+            }
+            else if (next >= 0xA0 && next <= 0xAF) {
+                key[i] = (char)0xD1;
+                key[i + 1] = (char)(next - 0x20);
+                // Cyrillic capitals U+0420..U+042F map to U+0440..U+044F
+            }
+            i++;
+        }
+    }
+
+    return key;
+}
+
+uint64_t collationPrefix(const std::string& key) {
+    // Function to pack the leading bytes of a key big-endian, so integer order equals byte order
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; i++) {
+        prefix <<= 8;
+        if (i < key.size()) {
+            prefix |= (unsigned char)key[i];
+        }
+    }
+    return prefix;
+}
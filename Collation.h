@@ -0,0 +1,13 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <string>
+#include <cstdint>
+
+std::string makeCollationKey(const std::string& text);
+// Returns a case-folded copy of a UTF-8 string, so byte-wise comparison and substring search are case-insensitive
+// Folds ASCII, Latin-1 Supplement and Cyrillic capitals; every folded character keeps its byte length
+
+uint64_t collationPrefix(const std::string& key);
+// Packs the first 8 bytes of a collation key into an integer that orders the same way as the key
+// Used to sort with one integer comparison, falling back to the full key only on ties
@@ -0,0 +1,672 @@
+// Microbenchmarks for the core data paths
+// Times font atlas startup (cold and warm), response parsing, request path construction, salary formatting, favorites persistence, indexing and
+// querying fetched jobs, the results filter (substring scan and fuzzy), near-duplicate detection, facet counts and their cache, compressed bitmap AND/OR/AND NOT, opening, querying and appending to the job store, the seen-set and timer wheel of the saved searches, toggling a favorite, reading a search's results, a replayed search end to end and one UI
+// frame, on synthetic data with
+// realistic field lengths (or recorded responses from a cassette). Reports time and heap allocations per operation.
+//
+// Usage: CoreBenchmark [--filter name] [--json] [--cassette searches.http] [--max-seconds 2]
+// Run it from the project directory: the search and UI benchmarks read config.ini.
+// With --json each result is one JSON line, like UiBenchmark, so runs can be stored and compared.
+
+#include "JobSearch.h"
+// Includes the search engine (request paths, response parsing, replayed searches)
+
+#include "HttpCassette.h"
+// Includes the cassette, used to replay searches without network access
+
+#include "JobIndex.h"
+// Includes the full-text index of fetched jobs
+
+#include "TrigramIndex.h"
+// Includes the trigram index behind the typo-tolerant filter
+
+#include "TextArena.h"
+// Includes the text arena and substring kernels behind the results filter
+
+#include "DuplicateDetector.h"
+// Includes the near-duplicate detection of the results table
+
+#include "FacetEngine.h"
+// Includes the facet counts of the results table
+
+#include "RoaringBitmap.h"
+// Includes the compressed job sets behind the facet cache
+
+#include "JobStore.h"
+// Includes the persistent store of fetched jobs
+
+#include "SeenSet.h"
+// Includes the set of postings a saved search has seen
+
+#include "TimerWheel.h"
+// Includes the timer wheel the saved searches are refreshed on
+
+#include "Collation.h"
+// Includes the collation keys the trigram index is built over
+
+#include "FavoritesManager.h"
+// Includes the favorites persistence under test
+
+#include "UserInterface.h"
+// Includes the user interface, for toggling favorites and rendering a frame
+
+#include "ViewModelBuilder.h"
+// Includes formatSalary
+
+#include "SyntheticData.h"
+// Includes the synthetic job and response generators
+
+#include "Profiler.h"
+// Includes the profiler, whose counting operator new reports allocations per operation
+
+#include "FontAtlasCache.h"
+// Includes the font atlas cache, for the cold and warm startup benchmarks
+
+#include <imgui.h>
+// Includes the Dear ImGui library, for the headless frame
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    struct BenchmarkOptions {
+        const char* filter = nullptr;
+        bool json = false;
+        const char* cassettePath = nullptr;
+        double maxSeconds = 2.0;
+    };
+    // Command-line settings of the run
+
+    struct Measurement {
+        size_t operations;
+        double meanNs;
+        double p50Ns;
+        double p99Ns;
+        double allocationsPerOp;
+    };
+    // Timings of one benchmark, per operation
+
+    volatile size_t sink;
+    // Results are folded into this so the compiler cannot drop the measured work
+
+    double percentile(std::vector<double> values, double p) {
+        // Function to compute a percentile (nearest rank) of a sample
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t rank = (size_t)(p / 100.0 * (values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    }
+
+    bool selected(const BenchmarkOptions& options, const char* name) {
+        // Function to check a benchmark name against --filter
+        return !options.filter || std::strstr(name, options.filter) != nullptr;
+    }
+
+    Measurement measure(const BenchmarkOptions& options, const std::function<void()>& operation) {
+        // Function to time an operation: batches of calls long enough for the clock, repeated for a stable percentile
+        operation();
+        // Warm-up call (caches, lazy initialization)
+
+        size_t batch = 1;
+        while (true) {
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < batch; i++) operation();
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (ms >= 1.0 || batch >= (1u << 24)) break;
+            batch *= 2;
+        }
+        // Smallest power of two batch that takes at least a millisecond
+
+        std::vector<double> samples;
+        size_t allocationsBefore = Profiler::getAllocationCount();
+        Clock::time_point runStart = Clock::now();
+        while (samples.size() < 100) {
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < batch; i++) operation();
+            samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / batch);
+            if (samples.size() >= 5 && std::chrono::duration<double>(Clock::now() - runStart).count() > options.maxSeconds) break;
+        }
+        // At least 5 samples, at most 100 or the time budget
+
+        Measurement result;
+        result.operations = samples.size() * batch;
+        result.meanNs = 0.0;
+        for (double ns : samples) result.meanNs += ns;
+        result.meanNs /= samples.size();
+        result.p50Ns = percentile(samples, 50);
+        result.p99Ns = percentile(samples, 99);
+        result.allocationsPerOp = (double)(Profiler::getAllocationCount() - allocationsBefore) / result.operations;
+        return result;
+    }
+
+    void report(const BenchmarkOptions& options, const char* name, size_t size, const Measurement& result, size_t bytesPerOp) {
+        // Function to print one result as a table row or a JSON line
+        double mbPerSecond = bytesPerOp > 0 && result.meanNs > 0.0 ? bytesPerOp / result.meanNs * 1e9 / (1024.0 * 1024.0) : 0.0;
+        if (options.json) {
+            std::printf("{\"benchmark\":\"%s\",\"size\":%zu,\"operations\":%zu,\"mean_ns\":%.1f,\"p50_ns\":%.1f,\"p99_ns\":%.1f,"
+                "\"allocs_per_op\":%.2f,\"mb_per_s\":%.2f}\n",
+                name, size, result.operations, result.meanNs, result.p50Ns, result.p99Ns, result.allocationsPerOp, mbPerSecond);
+        }
+        else {
+            std::printf("%-22s %8zu %14.1f %14.1f %14.1f %12.2f %10.2f\n",
+                name, size, result.meanNs, result.p50Ns, result.p99Ns, result.allocationsPerOp, mbPerSecond);
+        }
+        std::fflush(stdout);
+    }
+
+    void run(const BenchmarkOptions& options, const char* name, size_t size, size_t bytesPerOp, const std::function<void()>& operation) {
+        // Function to measure and report a benchmark unless it is filtered out
+        if (!selected(options, name)) return;
+        report(options, name, size, measure(options, operation), bytesPerOp);
+    }
+
+    void setUpHeadlessImGui() {
+        // Function to create an ImGui context that runs frames without a platform or renderer backend
+        Profiler::installImGuiAllocator();
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(1200, 600);
+        io.IniFilename = nullptr;
+        io.Fonts->AddFontDefault();
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        io.Fonts->SetTexID((ImTextureID)1);
+        // The built-in font is enough here; UiBenchmark measures frames with the application's font
+    }
+
+    void renderFrame(UserInterface& ui) {
+        // Function to run one headless frame
+        ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+        ui.render();
+        ImGui::Render();
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) options.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--json") == 0) options.json = true;
+        else if (std::strcmp(argv[i], "--cassette") == 0 && i + 1 < argc) options.cassettePath = argv[++i];
+        else if (std::strcmp(argv[i], "--max-seconds") == 0 && i + 1 < argc) options.maxSeconds = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "Usage: %s [--filter name] [--json] [--cassette searches.http] [--max-seconds 2]\n", argv[0]);
+            return 1;
+        }
+    }
+    // Parse the command line
+
+    Profiler::setEnabled(true);
+    // Count allocations for the whole run
+
+    if (!options.json) {
+        std::printf("%-22s %8s %14s %14s %14s %12s %10s\n", "benchmark", "size", "mean ns", "p50 ns", "p99 ns", "allocs/op", "MB/s");
+    }
+
+    for (size_t size : { 10, 50 }) {
+        std::string body = makeSearchResponse(generateJobs(size, 1));
+        run(options, "parse_response", size, body.size(), [&] {
+            sink = JobSearch::parseResults(body, "GBP").size();
+        });
+    }
+    // One results page; Adzuna returns up to 50 jobs per page
+
+    if (options.cassettePath && selected(options, "parse_cassette")) {
+        try {
+            HttpCassette cassette(options.cassettePath, HttpCassette::ModeReplay);
+            std::vector<std::string> bodies;
+            size_t bytes = 0;
+            for (const HttpInteraction& interaction : cassette.getRecordings()) {
+                if (interaction.status != 200) continue;
+                bodies.push_back(interaction.body);
+                bytes += interaction.body.size();
+            }
+            if (!bodies.empty()) {
+                size_t next = 0;
+                run(options, "parse_cassette", bodies.size(), bytes / bodies.size(), [&] {
+                    sink = JobSearch::parseResults(bodies[next], "GBP").size();
+                    next = (next + 1) % bodies.size();
+                });
+            }
+        }
+        catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+    // Recorded responses, one after the other
+
+    if (selected(options, "format_salary")) {
+        std::vector<Job> jobs = generateJobs(1000, 2);
+        size_t next = 0;
+        run(options, "format_salary", 1, 0, [&] {
+            const Job& job = jobs[next];
+            sink = formatSalary(job.salary, job.salaryCurrency).size();
+            next = (next + 1) % jobs.size();
+        });
+    }
+
+    for (size_t count : { 10000, 1000000 }) {
+        if (!selected(options, "index_add") && !selected(options, "index_query")) break;
+        std::vector<Job> jobs = generateJobs(count, 8);
+        JobIndex index;
+        std::vector<double> pageNs;
+        size_t allocationsBefore = Profiler::getAllocationCount();
+        for (size_t first = 0; first < jobs.size(); first += 50) {
+            std::vector<Job> page(jobs.begin() + first, jobs.begin() + std::min(first + 50, jobs.size()));
+            Clock::time_point start = Clock::now();
+            index.add(page);
+            pageNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+        }
+        // Built the way searches feed it, one 50-job page at a time; each page is timed once, since adding
+        // the same page again would only hit the duplicate check
+        if (selected(options, "index_add")) {
+            Measurement added;
+            added.operations = pageNs.size();
+            added.meanNs = 0.0;
+            for (double ns : pageNs) added.meanNs += ns;
+            added.meanNs /= pageNs.size();
+            added.p50Ns = percentile(pageNs, 50);
+            added.p99Ns = percentile(pageNs, 99);
+            added.allocationsPerOp = (double)(Profiler::getAllocationCount() - allocationsBefore) / pageNs.size();
+            report(options, "index_add", count, added, 0);
+        }
+        jobs.clear();
+        jobs.shrink_to_fit();
+
+        const char* const queries[] = { "senior python developer", "healthcare nursing", "flexible hybrid remote role",
+            "customer service manager", "c++ cloud security engineer", "warehouse operative" };
+        size_t next = 0;
+        run(options, "index_query", count, 0, [&] {
+            sink = index.search(queries[next], 20).size();
+            next = (next + 1) % (sizeof(queries) / sizeof(queries[0]));
+        });
+        // Top 20 of a few typical refinements
+    }
+
+    if (selected(options, "filter_scan_scalar") || selected(options, "filter_scan_sse2") ||
+        selected(options, "filter_scan_avx2") || selected(options, "filter_find_tolower")) {
+        const size_t count = 100000;
+        std::vector<Job> jobs = generateJobs(count, 10);
+        TextArena arena;
+        for (const Job& job : jobs) {
+            arena.addRecord();
+            for (const std::string* field : { &job.title, &job.company, &job.location, &job.contractType, &job.category, &job.description }) {
+                arena.addField(makeCollationKey(*field));
+            }
+        }
+        // The same arena the results filter scans
+
+        const char* const needles[] = { "kubernetes", "zz top", "m\xC3\xBCnchen", "\xD0\xBC\xD0\xBE\xD1\x81\xD0\xBA" };
+        // Filters that match no job or few, so every kernel scans the whole arena: ASCII, Latin-1 and Cyrillic
+        const SubstringKernel kernels[] = { SubstringKernelScalar, SubstringKernelSse2, SubstringKernelAvx2 };
+        const char* const kernelNames[] = { "filter_scan_scalar", "filter_scan_sse2", "filter_scan_avx2" };
+        for (int kernel = 0; kernel < 3; kernel++) {
+            if (!isSubstringKernelSupported(kernels[kernel])) continue;
+            size_t next = 0;
+            run(options, kernelNames[kernel], count, arena.getByteCount(), [&] {
+                sink = arena.findRecords(makeCollationKey(needles[next]), kernels[kernel]).size();
+                next = (next + 1) % (sizeof(needles) / sizeof(needles[0]));
+            });
+        }
+
+        size_t next = 0;
+        run(options, "filter_find_tolower", count, arena.getByteCount(), [&] {
+            std::string needle = needles[next];
+            std::transform(needle.begin(), needle.end(), needle.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+            size_t matches = 0;
+            for (const Job& job : jobs) {
+                for (const std::string* field : { &job.title, &job.company, &job.location, &job.contractType, &job.category, &job.description }) {
+                    std::string lower = *field;
+                    std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+                    if (lower.find(needle) != std::string::npos) {
+                        matches++;
+                        break;
+                    }
+                }
+            }
+            sink = matches;
+            next = (next + 1) % (sizeof(needles) / sizeof(needles[0]));
+        });
+        // The straightforward filter, for comparison (it folds ASCII only, so it misses "M\xC3\x9CNCHEN")
+    }
+
+    for (size_t count : { 10000, 100000 }) {
+        if (!selected(options, "fuzzy_filter") && !selected(options, "fuzzy_scan")) break;
+        std::vector<Job> jobs = generateJobs(count, 9);
+        std::vector<std::string> texts;
+        TrigramIndex index;
+        for (const Job& job : jobs) {
+            texts.push_back(makeCollationKey(job.title));
+            texts.push_back(makeCollationKey(job.company));
+            index.add(texts[texts.size() - 2]);
+            index.add(texts.back());
+        }
+        // Built like the results filter builds it: the title and company keys of every job
+
+        const char* const typos[] = { "sofware engineer", "devloper", "custmer service", "warehose", "helthcare",
+            "recruitmnet" };
+        size_t next = 0;
+        run(options, "fuzzy_filter", count, 0, [&] {
+            std::string needle = typos[next];
+            sink = index.find(needle, TrigramIndex::getMaxEdits(needle.size())).size();
+            next = (next + 1) % (sizeof(typos) / sizeof(typos[0]));
+        });
+        run(options, "fuzzy_scan", count, 0, [&] {
+            std::string needle = typos[next];
+            int maxEdits = TrigramIndex::getMaxEdits(needle.size());
+            size_t matches = 0;
+            for (const std::string& text : texts) {
+                if (TrigramIndex::containsApproximately(text, needle, maxEdits)) matches++;
+            }
+            sink = matches;
+            next = (next + 1) % (sizeof(typos) / sizeof(typos[0]));
+        });
+        // The same lookups as an edit distance against every title and company, for comparison
+    }
+
+    for (size_t count : { 10000, 100000 }) {
+        if (!selected(options, "dedup_new") && !selected(options, "dedup_cached")) break;
+        std::vector<Job> jobs = generateJobs(count, 12);
+        addReposts(jobs, 0.2, 13);
+        DuplicateDetector detector;
+        run(options, "dedup_new", jobs.size(), 0, [&] {
+            detector.clear();
+            sink = detector.group(jobs).size();
+        });
+        // Every job signed: a snapshot of jobs never seen before
+        run(options, "dedup_cached", jobs.size(), 0, [&] { sink = detector.group(jobs).size(); });
+        // Signatures cached: what a snapshot costs after a page is added to it
+    }
+
+    if (selected(options, "facet_counts") || selected(options, "facet_cache_hit") || selected(options, "facet_cache_miss")) {
+        const size_t count = 100000;
+        std::vector<Job> jobs = generateJobs(count, 14);
+        FacetEngine engine;
+        engine.build(jobs);
+        const RoaringBitmap everyJob = RoaringBitmap::range((uint32_t)count);
+
+        const char* const categories[] = { "IT Jobs", "Sales Jobs", "Engineering Jobs", "Admin Jobs", "Retail Jobs" };
+        const char* const contracts[] = { "permanent", "contract" };
+        const char* const bands[] = { "20k-40k", "40k-60k", "60k-80k", "80k-100k", "100k+" };
+        std::vector<FacetSelection> selections;
+        for (const char* band : bands) {
+            for (const char* contract : contracts) {
+                for (const char* category : categories) {
+                    FacetSelection selection;
+                    selection.values[FacetSalary].push_back(band);
+                    selection.values[FacetContractType].push_back(contract);
+                    selection.values[FacetCategory].push_back(category);
+                    selections.push_back(selection);
+                }
+            }
+        }
+        // Salary band x contract type x category: 50 combinations
+        std::vector<FacetValue> facets[FacetCount];
+        size_t next = 0;
+
+        run(options, "facet_counts", count, 0, [&] {
+            sink = engine.apply(&everyJob, selections[next], 8, facets).getCardinality();
+            next = (next + 1) % 4;
+        });
+        // With a text filter: counted over the filtered jobs every time
+        run(options, "facet_cache_hit", count, 0, [&] {
+            sink = engine.apply(nullptr, selections[next], 8, facets).getCardinality();
+            next = (next + 1) % 4;
+        });
+        // Flipping between four combinations: every call after the first four is a lookup
+
+        if (selected(options, "facet_cache_miss")) {
+            for (const FacetSelection& selection : std::vector<FacetSelection>(selections)) {
+                for (const char* category : { "Teaching Jobs", "Legal Jobs" }) {
+                    FacetSelection wider = selection;
+                    wider.values[FacetCategory].push_back(category);
+                    selections.push_back(wider);
+                }
+            }
+            // 150 combinations, cycled: least-recently-used eviction drops each one before it comes back
+            run(options, "facet_cache_miss", count, 0, [&] {
+                sink = engine.apply(nullptr, selections[next], 8, facets).getCardinality();
+                next = (next + 1) % selections.size();
+            });
+        }
+    }
+
+    if (selected(options, "roaring_and") || selected(options, "roaring_or") || selected(options, "roaring_andnot")) {
+        const size_t count = 100000;
+        std::vector<Job> jobs = generateJobs(count, 15);
+        RoaringBitmap permanent;
+        RoaringBitmap itJobs;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (jobs[i].contractType == "permanent") permanent.append((uint32_t)i);
+            if (jobs[i].category == "IT Jobs") itJobs.append((uint32_t)i);
+        }
+        // A dense set (a third of the jobs, bitmap containers) and a sparse one (array containers)
+        run(options, "roaring_and", count, 0, [&] { sink = RoaringBitmap::intersect(permanent, itJobs).getCardinality(); });
+        run(options, "roaring_or", count, 0, [&] { sink = RoaringBitmap::unite(permanent, itJobs).getCardinality(); });
+        run(options, "roaring_andnot", count, 0, [&] { sink = RoaringBitmap::subtract(permanent, itJobs).getCardinality(); });
+    }
+
+    if (selected(options, "store_add") || selected(options, "store_add_unchanged") || selected(options, "store_open") ||
+        selected(options, "store_find") || selected(options, "store_read_recent")) {
+        const size_t count = 100000;
+        std::vector<Job> jobs = generateJobs(count, 16);
+        {
+            JobStore store("bench_core_store");
+            store.clear();
+            for (size_t start = 0; start < count; start += 50) {
+                store.add(std::vector<Job>(jobs.begin() + start, jobs.begin() + start + 50));
+            }
+        }
+        // A store of 100000 jobs added a page at a time, as the searches do, then sealed
+
+        run(options, "store_open", count, 0, [&] {
+            JobStore reopened("bench_core_store");
+            sink = reopened.getSegmentCount();
+        });
+        // Maps the segments and their indexes; no job is read
+
+        {
+            JobStore store("bench_core_store");
+            size_t next = 0;
+            run(options, "store_find", count, 0, [&] {
+                Job job;
+                sink = store.find(jobs[next].id, job);
+                next = (next + 7919) % count;
+            });
+            run(options, "store_read_recent", count, 0, [&] { sink = store.readRecent(count).size(); });
+            // Every stored job, as Browse Stored and the startup indexing read them
+
+            std::vector<Job> page(jobs.begin(), jobs.begin() + 50);
+            run(options, "store_add_unchanged", 50, 0, [&] { sink = store.add(page); });
+            // A page of jobs already stored: hashed and skipped
+
+            uint64_t nextId = 9000000000ULL;
+            size_t nextPage = 0;
+            run(options, "store_add", 50, 0, [&] {
+                for (size_t i = 0; i < page.size(); i++) {
+                    page[i] = jobs[nextPage + i];
+                    page[i].id = std::to_string(nextId++);
+                }
+                nextPage = (nextPage + 50) % count;
+                sink = store.add(page);
+            });
+            // A page of new jobs: appended to the active segment, sealing and compacting in the background as it fills
+
+            store.clear();
+        }
+        JobStore::destroy("bench_core_store");
+    }
+    // Writes a separate directory, so the user's stored jobs are untouched, and deletes it afterwards
+
+    if (selected(options, "seen_set_new") || selected(options, "seen_set_seen")) {
+        const size_t count = 100000;
+        std::vector<Job> jobs = generateJobs(count * 2, 17);
+        SeenSet seen;
+        for (size_t i = 0; i < count; i++) {
+            seen.insert(jobs[i].id);
+        }
+        size_t next = 0;
+        run(options, "seen_set_new", count, 0, [&] {
+            sink = seen.contains(jobs[count + next].id);
+            next = (next + 1) % count;
+        });
+        // A posting never seen: answered by the Bloom filter
+        run(options, "seen_set_seen", count, 0, [&] {
+            sink = seen.contains(jobs[next].id);
+            next = (next + 1) % count;
+        });
+        // A posting seen before: the filter's hit is confirmed against the exact ids
+    }
+
+    if (selected(options, "timer_wheel")) {
+        const size_t count = 10000;
+        TimerWheel wheel;
+        for (size_t i = 0; i < count; i++) {
+            wheel.schedule(i, 60 + (i * 7919) % 86400);
+        }
+        // Saved searches refreshed every minute to every day
+        std::vector<uint64_t> expired;
+        run(options, "timer_wheel", count, 0, [&] {
+            expired.clear();
+            wheel.advance(1, expired);
+            for (uint64_t id : expired) {
+                wheel.schedule(id, 60 + (id * 7919) % 86400);
+            }
+            sink = expired.size();
+        });
+        // One tick of the timer: fire the due refreshes and schedule their next ones
+    }
+
+    if (selected(options, "font_atlas_cold") || selected(options, "font_atlas_warm")) {
+        static const ImWchar ranges[] = {
+            0x0020, 0x00FF, 0x2000, 0x206F, 0x3000, 0x30FF, 0x31F0, 0x31FF, 0xFF00, 0xFFEF, 0x4e00, 0x9FAF,
+            0x20A0, 0x20CF, 0x0100, 0x024F, 0x0370, 0x03FF, 0x0400, 0x04FF, 0x0500, 0x052F, 0,
+        };
+        // The application's font and glyph ranges
+        auto buildAtlas = [&](bool cold) {
+            if (cold) std::remove("bench_core_fontatlas.cache");
+            ImFontAtlas atlas;
+            if (atlas.AddFontFromFileTTF("calibri.ttf", 20.0f, NULL, ranges) == nullptr) {
+                throw std::runtime_error("Unable to load calibri.ttf");
+            }
+            FontAtlasCache cache("bench_core_fontatlas.cache");
+            sink = cache.build(&atlas);
+        };
+        try {
+            run(options, "font_atlas_cold", 1, 0, [&] { buildAtlas(true); });
+            // No cache file: the glyphs are rasterized and packed, then the cache is written
+            run(options, "font_atlas_warm", 1, 0, [&] { buildAtlas(false); });
+            // The atlas restored from the cache the warm-up call wrote
+        }
+        catch (const std::exception& e) {
+            std::fprintf(stderr, "Skipping the font atlas benchmarks: %s\n", e.what());
+        }
+        std::remove("bench_core_fontatlas.cache");
+    }
+    // Startup cost of the font atlas, cold and warm; writes a separate cache file, so the application's is untouched
+
+    for (size_t count : { 1000, 10000, 100000 }) {
+        if (!selected(options, "favorites_save") && !selected(options, "favorites_load")) break;
+        std::vector<Job> favorites = generateJobs(count, 3);
+        FavoritesManager manager("bench_core_favorites.json");
+        run(options, "favorites_save", count, 0, [&] { manager.saveFavorites(favorites); });
+        manager.saveFavorites(favorites);
+        run(options, "favorites_load", count, 0, [&] { sink = manager.loadFavorites().size(); });
+    }
+    std::remove("bench_core_favorites.json");
+    // Writes a separate file, so the user's favorites are untouched
+
+    bool needsEngine = selected(options, "build_search_path") || selected(options, "get_results") ||
+        selected(options, "search_replay") || selected(options, "toggle_favorite") || selected(options, "render_frame");
+    if (needsEngine) {
+        try {
+            JobSearch engine("config.ini");
+            engine.setLogging(false);
+
+            SearchRequest request;
+            request.query = "senior software engineer";
+            request.country = "gb";
+            request.salaryRange = "40000-60000";
+            request.resultsPerPage = 50;
+            request.currencySymbol = "GBP";
+
+            run(options, "build_search_path", 1, 0, [&] { sink = engine.buildSearchPath(request).size(); });
+
+            {
+                HttpCassette writer("bench_core.http", HttpCassette::ModeRecord);
+                HttpInteraction interaction;
+                interaction.path = engine.buildSearchPath(request);
+                interaction.status = 200;
+                interaction.contentType = "application/json";
+                interaction.body = makeSearchResponse(generateJobs(50, 4));
+                writer.record(interaction);
+            }
+            std::shared_ptr<HttpCassette> cassette = std::make_shared<HttpCassette>("bench_core.http", HttpCassette::ModeReplay);
+            cassette->setReplaySpeed(0.0);
+            engine.setCassette(cassette);
+            // A one-page cassette replayed instantly: searches run the whole pipeline except the network
+
+            std::shared_ptr<SearchHandle> search = engine.searchJobs(request);
+            search->wait();
+            run(options, "get_results", search->getResults()->size(), 0, [&] { sink = search->getResults()->size(); });
+
+            run(options, "search_replay", 50, 0, [&] {
+                std::shared_ptr<SearchHandle> replayed = engine.searchJobs(request);
+                replayed->wait();
+                sink = replayed->getResults()->size();
+            });
+            // Scheduling, replayed response, parsing and publishing of one 50-job page
+            std::remove("bench_core.http");
+
+            for (size_t count : { 1000, 10000 }) {
+                if (!selected(options, "toggle_favorite")) break;
+                FavoritesManager("bench_core_favorites.json").saveFavorites(generateJobs(count, 5));
+                UserInterface ui("bench_core_favorites.json", "bench_core_store", "bench_core_saved_searches.json");
+                Job job = generateJobs(1, 6).front();
+                run(options, "toggle_favorite", count, 0, [&] { ui.toggleFavorite(job); });
+                // Adds and removes the same job in turn; the save runs in the background and is coalesced
+            }
+            std::remove("bench_core_favorites.json");
+            SavedSearches::destroy("bench_core_saved_searches.json");
+
+            if (selected(options, "render_frame")) {
+                setUpHeadlessImGui();
+                {
+                    FavoritesManager("bench_core_favorites.json").saveFavorites(std::vector<Job>());
+                    UserInterface ui("bench_core_favorites.json", "bench_core_store", "bench_core_saved_searches.json");
+                    ui.showResults(std::make_shared<const std::vector<Job>>(generateJobs(1000, 7)));
+                    Clock::time_point warmupStart = Clock::now();
+                    while (!ui.isResultsViewReady() && Clock::now() - warmupStart < std::chrono::seconds(30)) {
+                        renderFrame(ui);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    // Wait for the background view model of the result set
+                    run(options, "render_frame", 1000, 0, [&] { renderFrame(ui); });
+                }
+                ImGui::DestroyContext();
+                std::remove("bench_core_favorites.json");
+                SavedSearches::destroy("bench_core_saved_searches.json");
+            }
+        }
+        catch (const std::exception& e) {
+            std::fprintf(stderr, "Skipping the search and UI benchmarks: %s\n", e.what());
+        }
+        JobStore::destroy("bench_core_store");
+    }
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include "DuplicateDetector.h"
+// Includes the header file for the DuplicateDetector class
+
+#include "Collation.h"
+// Includes the collation keys, so case does not change a signature
+
+#include "TaskScheduler.h"
+// Includes parallelFor, which hashes new jobs across the workers
+
+#include <algorithm>
+// Includes std::fill
+
+#include <numeric>
+// Includes std::iota
+
+namespace {
+    const int bandCount = 8;
+    const int bandRows = DuplicateDetector::hashCount / bandCount;
+    // Jobs are compared only when all 4 values of one of the 8 bands agree: a pair with 90% of its word pairs in
+    // common is compared with a probability over 99.9%, a pair with 30% in common with 6%
+
+    const int bucketBits = 16;
+    // Band values are hashed into 65536 buckets
+
+    const double minSimilarity = 0.6;
+    // Compared jobs this similar are the same posting
+
+    const uint32_t noJob = 0xFFFFFFFFu;
+    // End of a bucket chain
+
+    uint64_t mix(uint64_t value) {
+        // Function to scramble a hash so every output bit depends on every input bit (splitmix64 finalizer)
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ULL;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBULL;
+        value ^= value >> 31;
+        return value;
+    }
+
+    struct HashFunctions {
+        uint64_t multipliers[DuplicateDetector::hashCount];
+        // Odd multipliers of the multiply-shift hash functions
+
+        HashFunctions() {
+            for (int i = 0; i < DuplicateDetector::hashCount; i++) {
+                multipliers[i] = mix(0x9E3779B97F4A7C15ULL * (i + 1)) | 1;
+            }
+        }
+    };
+
+    const HashFunctions hashFunctions;
+    // Fixed, so signatures of the same text are always equal
+
+    void appendWordHashes(const std::string& text, std::vector<uint64_t>& words) {
+        // Function to split a collation key into words (letters, digits and any non-ASCII byte) and hash each one
+        uint64_t hash = 0;
+        bool inWord = false;
+        for (size_t i = 0; i <= text.size(); i++) {
+            unsigned char c = i < text.size() ? (unsigned char)text[i] : ' ';
+            bool wordByte = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80;
+            if (wordByte) {
+                if (!inWord) hash = 0xCBF29CE484222325ULL;
+                hash = (hash ^ c) * 0x100000001B3ULL;
+                inWord = true;
+            }
+            else if (inWord) {
+                words.push_back(hash);
+                inWord = false;
+            }
+        }
+        // FNV-1a over the bytes of each word
+    }
+
+    uint32_t findRoot(std::vector<uint32_t>& parent, uint32_t job) {
+        // Function to find the first job of a group, halving the path on the way
+        while (parent[job] != job) {
+            parent[job] = parent[parent[job]];
+            job = parent[job];
+        }
+        return job;
+    }
+}
+
+DuplicateDetector::DuplicateDetector() {
+    // Constructor for the DuplicateDetector class
+}
+
+void DuplicateDetector::clear() {
+    signatures.clear();
+}
+
+double DuplicateDetector::getSimilarity(const Signature& a, const Signature& b) {
+    // Function to count the equal MinHash values
+    int equal = 0;
+    for (int i = 0; i < hashCount; i++) {
+        if (a.minHashes[i] == b.minHashes[i]) equal++;
+    }
+    return (double)equal / hashCount;
+}
+
+DuplicateDetector::Signature DuplicateDetector::computeSignature(const Job& job) {
+    // Function to keep, for each hash function, the smallest hash of any word pair
+    Signature signature;
+    std::fill(signature.minHashes, signature.minHashes + hashCount, 0xFFFFFFFFu);
+
+    std::vector<uint64_t> words;
+    appendWordHashes(makeCollationKey(job.title), words);
+    appendWordHashes(makeCollationKey(job.description), words);
+    signature.usable = words.size() >= 9;
+    if (!signature.usable) return signature;
+    // Fewer than 8 word pairs: blank or boilerplate descriptions would all look alike
+
+    for (size_t i = 1; i < words.size(); i++) {
+        uint64_t pair = mix(words[i - 1] * 31 + words[i]);
+        for (int function = 0; function < hashCount; function++) {
+            uint32_t hash = (uint32_t)((pair * hashFunctions.multipliers[function]) >> 32);
+            if (hash < signature.minHashes[function]) signature.minHashes[function] = hash;
+        }
+    }
+    // Word pairs rather than single words, so the order of the text counts and shared vocabulary alone does not
+    return signature;
+}
+
+std::vector<uint32_t> DuplicateDetector::group(const std::vector<Job>& jobs) {
+    // Function to sign the new jobs, then link similar jobs found through equal bands
+    const size_t count = jobs.size();
+    std::vector<const Signature*> jobSignatures(count);
+    std::vector<uint32_t> missing;
+    for (size_t i = 0; i < count; i++) {
+        std::unordered_map<std::string, Signature>::const_iterator cached = signatures.find(jobs[i].url);
+        if (cached != signatures.end()) {
+            jobSignatures[i] = &cached->second;
+        }
+        else {
+            missing.push_back((uint32_t)i);
+        }
+    }
+
+    std::vector<Signature> computed(missing.size());
+    parallelFor(missing.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            computed[i] = computeSignature(jobs[missing[i]]);
+        }
+    });
+    // Each new job writes only its own slot
+
+    if (signatures.size() + missing.size() > 4 * count + 4096) {
+        std::unordered_map<std::string, Signature> kept;
+        for (size_t i = 0; i < count; i++) {
+            if (jobSignatures[i]) kept[jobs[i].url] = *jobSignatures[i];
+        }
+        signatures.swap(kept);
+    }
+    // The cache holds mostly jobs of earlier searches: start over with the snapshot's jobs
+    for (size_t i = 0; i < missing.size(); i++) {
+        signatures[jobs[missing[i]].url] = computed[i];
+    }
+    for (size_t i = 0; i < count; i++) {
+        jobSignatures[i] = &signatures.find(jobs[i].url)->second;
+    }
+    // Looked up again, since the cache may have been rebuilt
+
+    std::vector<uint32_t> parent(count);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    std::vector<uint32_t> head((size_t)1 << bucketBits);
+    std::vector<uint32_t> next(count);
+    std::vector<uint64_t> bandKeys(count);
+    for (int band = 0; band < bandCount; band++) {
+        std::fill(head.begin(), head.end(), noJob);
+        for (uint32_t job = 0; job < (uint32_t)count; job++) {
+            const Signature& signature = *jobSignatures[job];
+            if (!signature.usable) continue;
+            uint64_t key = 0;
+            for (int row = 0; row < bandRows; row++) {
+                key = mix(key + signature.minHashes[band * bandRows + row]);
+            }
+            bandKeys[job] = key;
+            uint32_t bucket = (uint32_t)(key & (((uint64_t)1 << bucketBits) - 1));
+
+            int compared = 0;
+            for (uint32_t other = head[bucket]; other != noJob && compared < 32; other = next[other]) {
+                if (bandKeys[other] != key) continue;
+                compared++;
+                if (getSimilarity(signature, *jobSignatures[other]) < minSimilarity) continue;
+                uint32_t a = findRoot(parent, job);
+                uint32_t b = findRoot(parent, other);
+                if (a != b) {
+                    parent[a > b ? a : b] = a > b ? b : a;
+                }
+                // The lower index becomes the root, so a group is represented by its first job
+            }
+            // The chain also holds unrelated jobs whose band only shares the bucket (about count / 65536 of them,
+            // skipped by the key check); the cap on comparisons keeps a big group from making this quadratic
+
+            next[job] = head[bucket];
+            head[bucket] = job;
+        }
+    }
+
+    std::vector<uint32_t> representative(count);
+    for (uint32_t job = 0; job < (uint32_t)count; job++) {
+        representative[job] = findRoot(parent, job);
+    }
+    return representative;
+}
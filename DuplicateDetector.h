@@ -0,0 +1,47 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include "Job.h"
+// Includes the Job header file - contains the Job struct definition
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+class DuplicateDetector {
+public:
+    static const int hashCount = 32;
+    // MinHash values per signature: 8 LSH bands of 4
+
+    struct Signature {
+        uint32_t minHashes[hashCount];
+        // Smallest value of each hash function over the pairs of consecutive words of the title and description
+        bool usable;
+        // False when the text is too short to tell postings apart
+    };
+    // MinHash signature of a job: the share of equal values estimates the overlap (Jaccard similarity) of the
+    // word pairs of two jobs
+
+    DuplicateDetector();
+    // Constructor with an empty signature cache
+
+    std::vector<uint32_t> group(const std::vector<Job>& jobs);
+    // Function to find the near-duplicate postings of a result snapshot: returns, for every job, the index of the
+    // first job of its group (its own index if it has no duplicate). Runs in linear time; signatures are cached
+    // by URL, so when a snapshot grows page by page only the new jobs are hashed
+
+    void clear();
+    // Function to drop the cached signatures
+
+    static Signature computeSignature(const Job& job);
+    // Function to compute the MinHash signature of a job
+
+    static double getSimilarity(const Signature& a, const Signature& b);
+    // Share of equal MinHash values of two signatures; reposts with a few words changed score about 0.9,
+    // unrelated postings close to 0
+
+private:
+    std::unordered_map<std::string, Signature> signatures;
+    // Signature of every URL seen recently
+};
@@ -0,0 +1,244 @@
+#include "FacetEngine.h"
+// Includes the header file for the FacetEngine class
+
+#include <algorithm>
+// Includes std::partial_sort, std::sort and std::find
+
+namespace {
+    const size_t selectionCacheCapacity = 64;
+    // Selections kept; users flip between a handful, so this holds a whole session's worth
+
+    const size_t fieldCacheCapacity = 256;
+    // Field matches kept before the field cache starts over
+
+    const char* const salaryBands[] = { "Not specified", "Under 20k", "20k-40k", "40k-60k", "60k-80k", "80k-100k", "100k+" };
+    // Labels of the salary bands, lowest first
+
+    std::string getFieldValue(const Job& job, int field) {
+        // Function to read a facet field of a job; a blank value gets a visible label
+        if (field == FacetSalary) {
+            if (job.salary <= 0.0) return salaryBands[0];
+            int band = job.salary < 20000.0 ? 1 : std::min(6, 2 + (int)((job.salary - 20000.0) / 20000.0));
+            return salaryBands[band];
+        }
+        const std::string* value = &job.category;
+        switch (field) {
+        case FacetContractType: value = &job.contractType; break;
+        case FacetLocation: value = &job.location; break;
+        case FacetCompany: value = &job.company; break;
+        default: break;
+        }
+        return value->empty() ? "(none)" : *value;
+    }
+
+    std::string makeFieldKey(int field, std::vector<std::string> values) {
+        // Function to build the cache key of a field's selection: the field and its values, in sorted order
+        std::sort(values.begin(), values.end());
+        std::string key(1, (char)('0' + field));
+        for (const std::string& value : values) {
+            key += '\x1F';
+            key += value;
+        }
+        return key;
+    }
+}
+
+FacetEngine::FacetEngine() : useCounter(0), cacheHits(0) {
+    // Constructor for the FacetEngine class
+}
+
+void FacetEngine::build(const std::vector<Job>& jobs) {
+    // Function to give every distinct value of each field an id, in order of first appearance, and to append
+    // every job to the postings of its values
+    for (int field = 0; field < FacetCount; field++) {
+        columns[field].resize(jobs.size());
+        labels[field].clear();
+        ids[field].clear();
+        postings[field].clear();
+        for (size_t i = 0; i < jobs.size(); i++) {
+            std::string value = getFieldValue(jobs[i], field);
+            std::unordered_map<std::string, uint32_t>::iterator found = ids[field].find(value);
+            if (found == ids[field].end()) {
+                found = ids[field].emplace(value, (uint32_t)labels[field].size()).first;
+                labels[field].push_back(value);
+                postings[field].push_back(RoaringBitmap());
+            }
+            columns[field][i] = found->second;
+            postings[field][found->second].append((uint32_t)i);
+        }
+    }
+    // Counting and matching then work on integers and bitmaps, never on strings
+
+    fieldCache.clear();
+    selectionCache.clear();
+    useCounter = 0;
+    cacheHits = 0;
+}
+
+size_t FacetEngine::getJobCount() const {
+    return columns[0].size();
+}
+
+size_t FacetEngine::getCacheHits() const {
+    return cacheHits;
+}
+
+const char* FacetEngine::getFieldName(FacetField field) {
+    switch (field) {
+    case FacetCategory: return "Category";
+    case FacetContractType: return "Contract Type";
+    case FacetSalary: return "Salary";
+    case FacetLocation: return "Location";
+    case FacetCompany: return "Company";
+    default: return "";
+    }
+}
+
+const RoaringBitmap& FacetEngine::getFieldMatches(int field, const std::vector<std::string>& values) {
+    // Function to unite the postings of the selected values of a field
+    std::string key = makeFieldKey(field, values);
+    std::unordered_map<std::string, RoaringBitmap>::iterator cached = fieldCache.find(key);
+    if (cached != fieldCache.end()) return cached->second;
+
+    RoaringBitmap matches;
+    for (const std::string& value : values) {
+        std::unordered_map<std::string, uint32_t>::const_iterator found = ids[field].find(value);
+        if (found != ids[field].end()) {
+            matches = RoaringBitmap::unite(matches, postings[field][found->second]);
+        }
+        // A selected value missing from the snapshot matches no job
+    }
+    return fieldCache.emplace(key, std::move(matches)).first->second;
+}
+
+FacetEngine::CachedSelection& FacetEngine::getSelection(const FacetSelection& selection) {
+    // Function to look a selection up, or to intersect the matches of its fields
+    std::string key;
+    for (int field = 0; field < FacetCount; field++) {
+        if (selection.values[field].empty()) continue;
+        key += makeFieldKey(field, selection.values[field]);
+        key += '\x1E';
+    }
+
+    std::unordered_map<std::string, CachedSelection>::iterator cached = selectionCache.find(key);
+    if (cached != selectionCache.end()) {
+        cacheHits++;
+        cached->second.lastUse = ++useCounter;
+        return cached->second;
+    }
+
+    if (selectionCache.size() >= selectionCacheCapacity) {
+        std::unordered_map<std::string, CachedSelection>::iterator oldest = selectionCache.begin();
+        for (std::unordered_map<std::string, CachedSelection>::iterator entry = selectionCache.begin(); entry != selectionCache.end(); ++entry) {
+            if (entry->second.lastUse < oldest->second.lastUse) oldest = entry;
+        }
+        selectionCache.erase(oldest);
+    }
+    // Evict the least recently used selection
+
+    if (fieldCache.size() + FacetCount > fieldCacheCapacity) {
+        fieldCache.clear();
+    }
+    // Cleared before, not while, collecting the field matches below, which point into the cache. The selection
+    // cache keeps its own copies, so starting over only costs the next new combinations a union
+
+    const RoaringBitmap everyJob = RoaringBitmap::range((uint32_t)getJobCount());
+    const RoaringBitmap* fieldMatches[FacetCount];
+    for (int field = 0; field < FacetCount; field++) {
+        fieldMatches[field] = selection.values[field].empty() ? nullptr : &getFieldMatches(field, selection.values[field]);
+    }
+
+    CachedSelection entry;
+    entry.matching = everyJob;
+    for (int field = 0; field < FacetCount; field++) {
+        if (fieldMatches[field]) entry.matching = RoaringBitmap::intersect(entry.matching, *fieldMatches[field]);
+    }
+    for (int field = 0; field < FacetCount; field++) {
+        if (!fieldMatches[field]) continue;
+        entry.others[field] = everyJob;
+        for (int other = 0; other < FacetCount; other++) {
+            if (other != field && fieldMatches[other]) entry.others[field] = RoaringBitmap::intersect(entry.others[field], *fieldMatches[other]);
+        }
+    }
+    // Only fields with selections need their own set; the others count over matching
+    entry.countedLimit = 0;
+    entry.lastUse = ++useCounter;
+    return selectionCache.emplace(key, std::move(entry)).first->second;
+}
+
+std::vector<FacetValue> FacetEngine::countValues(int field, const RoaringBitmap& jobs, const std::vector<std::string>& selected, size_t limit) const {
+    // Function to count each value id over the jobs, then rank the ids
+    std::vector<uint32_t> counts(labels[field].size(), 0);
+    const std::vector<uint32_t>& column = columns[field];
+    jobs.forEach([&](uint32_t job) { counts[column[job]]++; });
+
+    std::vector<uint32_t> ranked;
+    for (uint32_t id = 0; id < (uint32_t)counts.size(); id++) {
+        if (counts[id] > 0) ranked.push_back(id);
+    }
+    size_t shown = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + shown, ranked.end(), [&](uint32_t a, uint32_t b) {
+        if (counts[a] != counts[b]) return counts[a] > counts[b];
+        return labels[field][a] < labels[field][b];
+    });
+    ranked.resize(shown);
+
+    std::vector<FacetValue> values;
+    for (uint32_t id : ranked) {
+        FacetValue value;
+        value.label = labels[field][id];
+        value.count = counts[id];
+        value.selected = std::find(selected.begin(), selected.end(), value.label) != selected.end();
+        value.text = value.label + " (" + std::to_string(value.count) + ")";
+        values.push_back(std::move(value));
+    }
+    for (const std::string& label : selected) {
+        bool listed = false;
+        for (const FacetValue& value : values) {
+            listed = listed || value.label == label;
+        }
+        if (listed) continue;
+        std::unordered_map<std::string, uint32_t>::const_iterator found = ids[field].find(label);
+        FacetValue value;
+        value.label = label;
+        value.count = found == ids[field].end() ? 0 : counts[found->second];
+        value.selected = true;
+        value.text = label + " (" + std::to_string(value.count) + ")";
+        values.push_back(std::move(value));
+    }
+    // Selected values stay listed even when rare or missing from the snapshot, so they can be unselected
+    return values;
+}
+
+RoaringBitmap FacetEngine::apply(const RoaringBitmap* candidates, const FacetSelection& selection, size_t limit,
+    std::vector<FacetValue> (&facets)[FacetCount]) {
+    // Function to combine the candidates with the cached job sets of the selection
+    CachedSelection& entry = getSelection(selection);
+
+    if (!candidates) {
+        if (entry.countedLimit != limit) {
+            for (int field = 0; field < FacetCount; field++) {
+                const RoaringBitmap& counted = selection.values[field].empty() ? entry.matching : entry.others[field];
+                entry.facets[field] = countValues(field, counted, selection.values[field], limit);
+            }
+            entry.countedLimit = limit;
+        }
+        for (int field = 0; field < FacetCount; field++) {
+            facets[field] = entry.facets[field];
+        }
+        return entry.matching;
+    }
+    // Without a text filter the counts depend on the selection only, so they are cached with it
+
+    RoaringBitmap matching = RoaringBitmap::intersect(*candidates, entry.matching);
+    for (int field = 0; field < FacetCount; field++) {
+        if (selection.values[field].empty()) {
+            facets[field] = countValues(field, matching, selection.values[field], limit);
+        }
+        else {
+            facets[field] = countValues(field, RoaringBitmap::intersect(*candidates, entry.others[field]), selection.values[field], limit);
+        }
+    }
+    // With a text filter the counts are over the filtered jobs
+    return matching;
+}
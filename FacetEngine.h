@@ -0,0 +1,119 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include "Job.h"
+// Includes the Job header file - contains the Job struct definition
+
+#include "RoaringBitmap.h"
+// Includes the compressed bitmaps the job sets are kept in
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+enum FacetField {
+    FacetCategory,
+    FacetContractType,
+    FacetSalary,
+    // Salary band ("40k-60k"), in the job's currency
+    FacetLocation,
+    FacetCompany,
+    FacetCount
+};
+// Job fields the results can be narrowed by
+
+struct FacetSelection {
+    std::vector<std::string> values[FacetCount];
+    // Selected values of each field; a job matches a field with selections if it has any of them, and a field
+    // without selections matches every job
+};
+// Facet values the user clicked
+
+struct FacetValue {
+    std::string label;
+    // The field value, as in the jobs
+    uint32_t count;
+    // Number of jobs with this value among those matching the filter and the other fields' selections
+    bool selected;
+    // Whether the value is part of the selection
+    std::string text;
+    // "label (count)", preformatted for the UI
+};
+// One entry of a facet list
+
+class FacetEngine {
+public:
+    FacetEngine();
+    // Constructor for an empty engine
+
+    void build(const std::vector<Job>& jobs);
+    // Function to intern the facet fields of a result snapshot (one small integer per job and field) and to
+    // build the set of jobs of every value; clears the caches
+
+    RoaringBitmap apply(const RoaringBitmap* candidates, const FacetSelection& selection, size_t limit,
+        std::vector<FacetValue> (&facets)[FacetCount]);
+    // Function to narrow a set of jobs (nullptr for all of them) to those matching the selection, and to count
+    // the values of each field among the candidates matching the other fields' selections, so a field's
+    // alternatives stay visible after one of them is clicked. Each field lists its limit most frequent values,
+    // plus the selected ones
+    // The job sets of recent selections are cached, and so are their counts over all jobs, so flipping between
+    // the same few combinations costs a lookup; a new combination reuses the cached sets of its fields
+
+    size_t getJobCount() const;
+    // Number of jobs of the snapshot
+
+    size_t getCacheHits() const;
+    // Number of apply() calls answered from the selection cache since build()
+
+    static const char* getFieldName(FacetField field);
+    // Heading of a field in the UI
+
+private:
+    struct CachedSelection {
+        RoaringBitmap matching;
+        // Jobs matching every field of the selection
+        RoaringBitmap others[FacetCount];
+        // Jobs matching every field but one, for the counts of a field with selections
+        size_t countedLimit;
+        // limit of the counts in facets, 0 until they are computed
+        std::vector<FacetValue> facets[FacetCount];
+        // Counts over all jobs
+        uint64_t lastUse;
+        // Value of useCounter when last used, for the eviction
+    };
+    // The job sets of one selection
+
+    std::vector<uint32_t> columns[FacetCount];
+    // Value id of each job, per field
+
+    std::vector<std::string> labels[FacetCount];
+    // Value of each id, per field
+
+    std::unordered_map<std::string, uint32_t> ids[FacetCount];
+    // Id of each value, per field, to resolve selections
+
+    std::vector<RoaringBitmap> postings[FacetCount];
+    // Jobs with each value id, per field
+
+    std::unordered_map<std::string, RoaringBitmap> fieldCache;
+    // Union of the postings of a field's selected values, by field and values
+
+    std::unordered_map<std::string, CachedSelection> selectionCache;
+    // Recent selections, by their fields and values
+
+    uint64_t useCounter;
+    // Number of apply() calls, the clock of the least-recently-used eviction
+
+    size_t cacheHits;
+    // Number of apply() calls answered from selectionCache
+
+    const RoaringBitmap& getFieldMatches(int field, const std::vector<std::string>& values);
+    // Function to get the jobs having any of the values of a field, from fieldCache or by uniting postings
+
+    CachedSelection& getSelection(const FacetSelection& selection);
+    // Function to get the job sets of a selection, from selectionCache or by intersecting field matches
+
+    std::vector<FacetValue> countValues(int field, const RoaringBitmap& jobs, const std::vector<std::string>& selected, size_t limit) const;
+    // Function to count the values of a field over a set of jobs and list the most frequent and the selected ones
+};
@@ -1,23 +1,75 @@
 #include "FavoritesManager.h"
 // Includes the FavoritesManager header file
 
+#include "Trace.h"
+// Includes the tracer, which records favorites persistence in the timeline
+
+#include "TaskScheduler.h"
+// Includes the shared task scheduler the disk flushes run on
+
 #include <fstream>
 // Includes the file stream classes for file I/O operations
 
 #include <json.hpp>
 // Includes the JSON library for parsing and creating JSON data
 
-FavoritesManager::FavoritesManager() {}
+FavoritesManager::FavoritesManager(const std::string& filename) : filename(filename), savePending(false), flushScheduled(false) {}
 // Constructor implementation
 
+FavoritesManager::~FavoritesManager() {
+    flush();
+    // Don't lose the last change on exit
+}
+
+void FavoritesManager::saveFavoritesAsync(std::vector<Job> favorites) {
+    // Function to queue a save of the favorites
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        pendingFavorites = std::move(favorites);
+        savePending = true;
+        if (flushScheduled) return;
+        // The running flush writes the new list when it finishes the current one
+        flushScheduled = true;
+    }
+    TaskScheduler::shared().submit([this]() { runFlushes(); }, TaskPriorityLow);
+}
+
+void FavoritesManager::flush() {
+    // Function to wait for queued saves
+    std::unique_lock<std::mutex> lock(flushMutex);
+    flushed.wait(lock, [this] { return !flushScheduled; });
+}
+
+void FavoritesManager::runFlushes() {
+    // Function that runs as a task on the scheduler
+    while (true) {
+        std::vector<Job> favorites;
+        {
+            std::lock_guard<std::mutex> lock(flushMutex);
+            if (!savePending) {
+                flushScheduled = false;
+                flushed.notify_all();
+                return;
+            }
+            favorites.swap(pendingFavorites);
+            savePending = false;
+        }
+        // Take the latest list; only the newest of several quick saves is written
+
+        saveFavorites(favorites);
+    }
+}
+
 void FavoritesManager::saveFavorites(const std::vector<Job>& favorites) {
     // Function to save favorite jobs to a JSON file
+    TRACE_SCOPE("FavoritesManager::saveFavorites", "favorites");
     nlohmann::json j;
     // Create a JSON object
 
     for (const auto& job : favorites) {
         // Iterate through each job in the favorites vector
         j.push_back({
+            {"id", job.id},
             {"title", job.title},
             {"company", job.company},
             {"location", job.location},
@@ -40,6 +92,7 @@ void FavoritesManager::saveFavorites(const std::vector<Job>& favorites) {
 
 std::vector<Job> FavoritesManager::loadFavorites() {
     // Function to load favorite jobs from a JSON file
+    TRACE_SCOPE("FavoritesManager::loadFavorites", "favorites");
     std::vector<Job> favorites;
     // Vector to store loaded favorite jobs
 
@@ -63,6 +116,8 @@ std::vector<Job> FavoritesManager::loadFavorites() {
             Job job;
             // Create a new Job object
 
+            job.id = jobJson.value("id", "");
+            // Favorites saved by older versions have no id
             job.title = jobJson["title"];
             job.company = jobJson["company"];
             job.location = jobJson["location"];
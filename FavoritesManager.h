@@ -6,20 +6,51 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
+// Includes the mutex class protecting the pending save
+#include <condition_variable>
+// Includes the condition_variable class used to wait for the last flush
 
 class FavoritesManager {
 public:
-    FavoritesManager();
-    // Constructor for the FavoritesManager class
+    explicit FavoritesManager(const std::string& filename = "favorites.json");
+    // Constructor for the FavoritesManager class, with the file used for saving/loading favorites
+
+    ~FavoritesManager();
+    // Destructor: waits until the last queued save is on disk
 
     void saveFavorites(const std::vector<Job>& favorites);
     // Function to save a vector of favorite jobs
 
+    void saveFavoritesAsync(std::vector<Job> favorites);
+    // Function to save favorites as a low-priority task; saves queued while one is being written are coalesced
+
+    void flush();
+    // Function to wait until the last queued save is on disk
+
     std::vector<Job> loadFavorites();
     // Function to load and return a vector of favorite jobs
 
 private:
-    const std::string filename = "favorites.json";
+    const std::string filename;
     // Constant string to store the filename for saving/loading favorites
+
+    std::mutex flushMutex;
+    // Mutex for the pending save shared with the flush task
+
+    std::condition_variable flushed;
+    // Condition variable signalled when the flush task finishes
+
+    std::vector<Job> pendingFavorites;
+    // Latest favorites not yet written
+
+    bool savePending;
+    // Flag to indicate pendingFavorites holds a save that has not been written
+
+    bool flushScheduled;
+    // Flag to indicate a flush task is queued or running; flushes never overlap
+
+    void runFlushes();
+    // Function that runs as a task: writes the latest favorites until no new save is pending
 };
 
@@ -0,0 +1,266 @@
+#include "FontAtlasCache.h"
+// Includes the header file for the FontAtlasCache class
+
+#include <imgui_internal.h>
+// Includes the internal font builder API (ImFontBuilderIO, ImFontAtlasBuildInit, ImFontAtlasBuildFinish)
+
+#include <fstream>
+// Includes the file stream classes for reading and writing the cache file
+
+#include <chrono>
+// Includes the chrono library for timing the atlas build
+
+#include <cstring>
+// Includes memcpy
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x41465342; // "BSFA"
+    const uint32_t CACHE_VERSION = 1;
+    // Identifies the cache file format; bump the version when the layout changes
+
+    const void* pendingAtlas = nullptr;
+    // Cached atlas handed to buildFromCache() during ImFontAtlas::Build()
+    // ImFontBuilderIO only takes a function pointer, so the data has to be passed through here
+
+    uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+        // 64-bit FNV-1a hash, used to key the cache on everything that affects rasterization
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t fnv1a(uint64_t hash, const T& value) {
+        return fnv1a(hash, &value, sizeof(T));
+    }
+
+    template <typename T>
+    void appendPod(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    // Appends the raw bytes of a trivially copyable value to the output buffer
+
+    class Reader {
+    public:
+        Reader(const std::vector<char>& data) : data(data), offset(0) {}
+
+        template <typename T>
+        bool read(T& value) {
+            return readBytes(&value, sizeof(T));
+        }
+
+        bool readBytes(void* out, size_t size) {
+            if (offset + size > data.size()) return false;
+            std::memcpy(out, data.data() + offset, size);
+            offset += size;
+            return true;
+        }
+
+        bool atEnd() const { return offset == data.size(); }
+
+    private:
+        const std::vector<char>& data;
+        size_t offset;
+    };
+    // Bounds-checked reader over the in-memory copy of the cache file
+}
+
+FontAtlasCache::FontAtlasCache(const std::string& cachePath) : cachePath(cachePath), lastBuildMs(0.0) {}
+
+bool FontAtlasCache::build(ImFontAtlas* atlas) {
+    // Function to build the font atlas, preferring the baked copy on disk
+    auto start = std::chrono::steady_clock::now();
+
+    uint64_t key = computeKey(atlas);
+
+    CachedAtlas cached;
+    bool fromCache = false;
+    if (load(key, cached)) {
+        static ImFontBuilderIO cacheBuilder;
+        cacheBuilder.FontBuilder_Build = &FontAtlasCache::buildFromCache;
+        // Builder that copies cached pixels and glyphs instead of running stb_truetype
+
+        const ImFontBuilderIO* previousBuilder = atlas->FontBuilderIO;
+        atlas->FontBuilderIO = &cacheBuilder;
+        pendingAtlas = &cached;
+        fromCache = atlas->Build();
+        pendingAtlas = nullptr;
+        atlas->FontBuilderIO = previousBuilder;
+        // Restore the default builder so later rebuilds rasterize normally
+    }
+
+    if (!fromCache) {
+        atlas->Build();
+        save(atlas, key);
+        // Cold start: rasterize the TrueType font and refresh the cache for the next launch
+    }
+
+    lastBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return fromCache;
+}
+
+double FontAtlasCache::getLastBuildMs() const {
+    return lastBuildMs;
+}
+
+uint64_t FontAtlasCache::computeKey(const ImFontAtlas* atlas) const {
+    // Function to compute the cache key from every input that affects the baked atlas
+    uint64_t hash = 14695981039346656037ULL;
+    hash = fnv1a(hash, (int)IMGUI_VERSION_NUM);
+    hash = fnv1a(hash, sizeof(ImFontGlyph));
+    hash = fnv1a(hash, atlas->Flags);
+    hash = fnv1a(hash, atlas->TexDesiredWidth);
+    hash = fnv1a(hash, atlas->TexGlyphPadding);
+
+    for (const ImFontConfig& cfg : atlas->ConfigData) {
+        hash = fnv1a(hash, cfg.FontData, (size_t)cfg.FontDataSize);
+        // The font file contents, so a replaced calibri.ttf invalidates the cache
+        hash = fnv1a(hash, cfg.FontNo);
+        hash = fnv1a(hash, cfg.SizePixels);
+        hash = fnv1a(hash, cfg.OversampleH);
+        hash = fnv1a(hash, cfg.OversampleV);
+        hash = fnv1a(hash, cfg.PixelSnapH);
+        hash = fnv1a(hash, cfg.GlyphExtraSpacing);
+        hash = fnv1a(hash, cfg.GlyphOffset);
+        hash = fnv1a(hash, cfg.GlyphMinAdvanceX);
+        hash = fnv1a(hash, cfg.GlyphMaxAdvanceX);
+        hash = fnv1a(hash, cfg.MergeMode);
+        hash = fnv1a(hash, cfg.RasterizerMultiply);
+        hash = fnv1a(hash, cfg.RasterizerDensity);
+        hash = fnv1a(hash, cfg.EllipsisChar);
+        for (const ImWchar* range = cfg.GlyphRanges; range && range[0]; range += 2) {
+            hash = fnv1a(hash, range[0]);
+            hash = fnv1a(hash, range[1]);
+        }
+        // The requested glyph ranges
+    }
+    return hash;
+}
+
+bool FontAtlasCache::load(uint64_t key, CachedAtlas& cached) const {
+    // Function to read and validate the cache file
+    std::ifstream file(cachePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+
+    std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+    std::vector<char> data((size_t)size);
+    file.seekg(0);
+    if (!file.read(data.data(), size)) return false;
+    // Read the whole file with a single read
+
+    Reader reader(data);
+    uint32_t magic = 0, version = 0, rectCount = 0, fontCount = 0;
+    uint64_t storedKey = 0;
+    if (!reader.read(magic) || magic != CACHE_MAGIC) return false;
+    if (!reader.read(version) || version != CACHE_VERSION) return false;
+    if (!reader.read(storedKey) || storedKey != key) return false;
+    // Stale or foreign cache, fall back to rasterizing
+
+    if (!reader.read(cached.texWidth) || !reader.read(cached.texHeight)) return false;
+    if (cached.texWidth <= 0 || cached.texHeight <= 0) return false;
+
+    if (!reader.read(rectCount)) return false;
+    cached.customRectPositions.resize(rectCount);
+    for (ImVec2& position : cached.customRectPositions) {
+        if (!reader.read(position)) return false;
+    }
+
+    if (!reader.read(fontCount)) return false;
+    cached.fonts.resize(fontCount);
+    for (CachedFont& font : cached.fonts) {
+        uint32_t glyphCount = 0;
+        if (!reader.read(font.ascent) || !reader.read(font.descent) || !reader.read(glyphCount)) return false;
+        font.glyphs.resize(glyphCount);
+        if (glyphCount > 0 && !reader.readBytes(font.glyphs.data(), glyphCount * sizeof(ImFontGlyph))) return false;
+    }
+
+    cached.pixels.resize((size_t)cached.texWidth * cached.texHeight);
+    if (!reader.readBytes(cached.pixels.data(), cached.pixels.size())) return false;
+
+    return reader.atEnd();
+}
+
+void FontAtlasCache::save(const ImFontAtlas* atlas, uint64_t key) const {
+    // Function to write the baked atlas (pixels, custom rects and glyph metrics) to disk
+    if (atlas->TexPixelsAlpha8 == nullptr) return;
+    // Only the Alpha8 atlas produced by the stb_truetype builder is cached
+
+    std::string out;
+    appendPod(out, CACHE_MAGIC);
+    appendPod(out, CACHE_VERSION);
+    appendPod(out, key);
+    appendPod(out, atlas->TexWidth);
+    appendPod(out, atlas->TexHeight);
+
+    appendPod(out, (uint32_t)atlas->CustomRects.Size);
+    for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+        appendPod(out, ImVec2((float)rect.X, (float)rect.Y));
+    }
+
+    appendPod(out, (uint32_t)atlas->Fonts.Size);
+    for (const ImFont* font : atlas->Fonts) {
+        appendPod(out, font->Ascent);
+        appendPod(out, font->Descent);
+        appendPod(out, (uint32_t)font->Glyphs.Size);
+        out.append(reinterpret_cast<const char*>(font->Glyphs.Data), font->Glyphs.Size * sizeof(ImFontGlyph));
+    }
+
+    out.append(reinterpret_cast<const char*>(atlas->TexPixelsAlpha8), (size_t)atlas->TexWidth * atlas->TexHeight);
+
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    file.write(out.data(), (std::streamsize)out.size());
+    // Write the cache with a single write
+}
+
+bool FontAtlasCache::buildFromCache(ImFontAtlas* atlas) {
+    // Font builder callback: restores the atlas without any TrueType rasterization
+    const CachedAtlas& cached = *static_cast<const CachedAtlas*>(pendingAtlas);
+
+    ImFontAtlasBuildInit(atlas);
+    // Registers the default custom rectangles (mouse cursors, baked lines)
+
+    if (atlas->CustomRects.Size != (int)cached.customRectPositions.size() || atlas->Fonts.Size != (int)cached.fonts.size()) {
+        return false;
+        // Layout no longer matches the cache, let the caller rasterize instead
+    }
+
+    for (int i = 0; i < atlas->CustomRects.Size; i++) {
+        atlas->CustomRects[i].X = (unsigned short)cached.customRectPositions[i].x;
+        atlas->CustomRects[i].Y = (unsigned short)cached.customRectPositions[i].y;
+    }
+    // Custom rects keep their packed positions so the default texture data lands in the same place
+
+    atlas->TexWidth = cached.texWidth;
+    atlas->TexHeight = cached.texHeight;
+    atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
+    atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(cached.pixels.size());
+    std::memcpy(atlas->TexPixelsAlpha8, cached.pixels.data(), cached.pixels.size());
+    // Copy the baked pixels into the atlas texture
+
+    for (ImFontConfig& cfg : atlas->ConfigData) {
+        if (cfg.MergeMode) continue;
+        int fontIndex = atlas->Fonts.index_from_ptr(atlas->Fonts.find(cfg.DstFont));
+        const CachedFont& cachedFont = cached.fonts[fontIndex];
+        ImFontAtlasBuildSetupFont(atlas, cfg.DstFont, &cfg, cachedFont.ascent, cachedFont.descent);
+    }
+    // Set up each destination font with its cached metrics
+
+    for (int i = 0; i < atlas->Fonts.Size; i++) {
+        ImFont* font = atlas->Fonts[i];
+        const std::vector<ImFontGlyph>& glyphs = cached.fonts[i].glyphs;
+        font->Glyphs.resize((int)glyphs.size());
+        if (!glyphs.empty()) {
+            std::memcpy(font->Glyphs.Data, glyphs.data(), glyphs.size() * sizeof(ImFontGlyph));
+        }
+        font->DirtyLookupTables = true;
+    }
+    // Glyphs are stored after all ImFontConfig adjustments, so they are copied as-is
+
+    ImFontAtlasBuildFinish(atlas);
+    // Renders the default texture data and builds the glyph lookup tables
+    return true;
+}
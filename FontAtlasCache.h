@@ -0,0 +1,58 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <imgui.h>
+// Includes the Dear ImGui library for the ImFontAtlas type
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class FontAtlasCache {
+public:
+    explicit FontAtlasCache(const std::string& cachePath);
+    // Constructor: remembers where the baked atlas is stored on disk
+
+    bool build(ImFontAtlas* atlas);
+    // Builds the atlas from the cache when the key matches, otherwise rasterizes it and refreshes the cache
+    // Returns true when the atlas was restored from the cache (warm start)
+
+    double getLastBuildMs() const;
+    // Time spent in the last build() call, used to compare cold and warm startup
+
+private:
+    struct CachedFont {
+        float ascent;
+        float descent;
+        std::vector<ImFontGlyph> glyphs;
+    };
+    // Metrics and baked glyphs of one destination font
+
+    struct CachedAtlas {
+        int texWidth;
+        int texHeight;
+        std::vector<ImVec2> customRectPositions;
+        // Packed positions of the custom rectangles (mouse cursors, baked lines)
+        std::vector<CachedFont> fonts;
+        std::vector<unsigned char> pixels;
+        // Alpha8 texture data
+    };
+
+    std::string cachePath;
+    // Path of the cache file
+
+    double lastBuildMs;
+    // Duration of the last build
+
+    uint64_t computeKey(const ImFontAtlas* atlas) const;
+    // Hashes the font file data, sizes, glyph ranges and builder settings
+
+    bool load(uint64_t key, CachedAtlas& cached) const;
+    // Reads the cache file in one read and validates it against the key
+
+    void save(const ImFontAtlas* atlas, uint64_t key) const;
+    // Writes the freshly built atlas to the cache file
+
+    static bool buildFromCache(ImFontAtlas* atlas);
+    // Font builder callback that fills the atlas from cached data instead of rasterizing
+};
@@ -0,0 +1,167 @@
+#include "HttpCassette.h"
+// Includes the header file for the HttpCassette class
+
+#include <json.hpp>
+// Includes the JSON library for the interaction headers
+
+#include <stdexcept>
+// Includes std::runtime_error
+
+// Cassette format: a "HTTPCASSETTE 1" line, then per interaction a one-line JSON header
+// ({"path", "status", "content_type", "headers_ms", "chunks": [[end, ms], ...], "body_length"}),
+// the raw body bytes and a newline. Bodies are stored unescaped, so replay returns the exact bytes.
+
+namespace {
+    const char* const cassetteMagic = "HTTPCASSETTE 1";
+}
+
+HttpCassette::HttpCassette(const std::string& filename, Mode mode)
+    : filename(filename), mode(mode), replaySpeed(1.0), interactionCount(0) {
+    // Constructor for the HttpCassette class
+    if (mode == ModeRecord) {
+        output.open(filename, std::ios::binary | std::ios::trunc);
+        if (!output.is_open()) {
+            throw std::runtime_error("Unable to create cassette: " + filename);
+        }
+        output << cassetteMagic << '\n';
+        output.flush();
+    }
+    else {
+        load();
+    }
+}
+
+HttpCassette::Mode HttpCassette::getMode() const {
+    return mode;
+}
+
+void HttpCassette::setReplaySpeed(double speed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    replaySpeed = speed < 0.0 ? 0.0 : speed;
+}
+
+double HttpCassette::getReplaySpeed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return replaySpeed;
+}
+
+void HttpCassette::record(const HttpInteraction& interaction) {
+    // Function to append an interaction to the cassette file
+    nlohmann::json chunks = nlohmann::json::array();
+    for (const HttpChunk& chunk : interaction.chunks) {
+        chunks.push_back({ chunk.end, chunk.atMs });
+    }
+    nlohmann::json header = {
+        {"path", scrub(interaction.path)},
+        {"status", interaction.status},
+        {"content_type", interaction.contentType},
+        {"headers_ms", interaction.headersAtMs},
+        {"chunks", chunks},
+        {"body_length", interaction.body.size()}
+    };
+    std::string line = header.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (mode != ModeRecord) return;
+    output << line << '\n';
+    output.write(interaction.body.data(), interaction.body.size());
+    output << '\n';
+    output.flush();
+    // Flushed per interaction, so a recording survives the application being closed at any point
+    interactionCount++;
+}
+
+bool HttpCassette::findReplay(const std::string& path, HttpInteraction& interaction) {
+    // Function to get the next recording of a request path
+    std::string key = scrub(path);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, std::vector<HttpInteraction>>::const_iterator found = recordings.find(key);
+    if (found == recordings.end()) {
+        return false;
+    }
+    size_t& next = nextRecording[key];
+    interaction = found->second[next];
+    next = (next + 1) % found->second.size();
+    return true;
+}
+
+size_t HttpCassette::getInteractionCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return interactionCount;
+}
+
+std::vector<HttpInteraction> HttpCassette::getRecordings() const {
+    // Function to list the loaded interactions
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<HttpInteraction> all;
+    for (const auto& path : recordings) {
+        all.insert(all.end(), path.second.begin(), path.second.end());
+    }
+    return all;
+}
+
+std::string HttpCassette::scrub(const std::string& path) {
+    // Function to replace the credential values in a request path
+    std::string scrubbed = path;
+    const char* const names[] = { "app_id=", "app_key=" };
+    for (const char* name : names) {
+        size_t start = scrubbed.find(name);
+        while (start != std::string::npos) {
+            if (start == 0 || scrubbed[start - 1] == '?' || scrubbed[start - 1] == '&') {
+                size_t valueStart = start + std::string(name).size();
+                size_t valueEnd = scrubbed.find('&', valueStart);
+                scrubbed.replace(valueStart, (valueEnd == std::string::npos ? scrubbed.size() : valueEnd) - valueStart, "REDACTED");
+            }
+            start = scrubbed.find(name, start + 1);
+        }
+    }
+    return scrubbed;
+}
+
+void HttpCassette::load() {
+    // Function to read every interaction of the cassette file
+    std::ifstream input(filename, std::ios::binary);
+    if (!input.is_open()) {
+        throw std::runtime_error("Unable to open cassette: " + filename);
+    }
+
+    std::string line;
+    if (!std::getline(input, line) || line != cassetteMagic) {
+        throw std::runtime_error("Not a cassette file: " + filename);
+    }
+
+    while (std::getline(input, line)) {
+        if (line.empty()) continue;
+
+        HttpInteraction interaction;
+        size_t bodyLength = 0;
+        try {
+            nlohmann::json header = nlohmann::json::parse(line);
+            interaction.path = header.at("path").get<std::string>();
+            interaction.status = header.at("status").get<int>();
+            interaction.contentType = header.value("content_type", "");
+            interaction.headersAtMs = header.value("headers_ms", 0.0);
+            for (const nlohmann::json& chunk : header.at("chunks")) {
+                HttpChunk recorded;
+                recorded.end = chunk.at(0).get<size_t>();
+                recorded.atMs = chunk.at(1).get<double>();
+                interaction.chunks.push_back(recorded);
+            }
+            bodyLength = header.at("body_length").get<size_t>();
+        }
+        catch (const std::exception& e) {
+            throw std::runtime_error("Corrupt cassette " + filename + ": " + e.what());
+        }
+
+        interaction.body.resize(bodyLength);
+        if (bodyLength > 0 && !input.read(&interaction.body[0], bodyLength)) {
+            throw std::runtime_error("Truncated cassette: " + filename);
+        }
+        input.ignore(1);
+        // Skip the newline after the body
+
+        recordings[interaction.path].push_back(std::move(interaction));
+        interactionCount++;
+    }
+}
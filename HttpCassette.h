@@ -0,0 +1,103 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <string>
+#include <map>
+#include <fstream>
+// Includes the file stream the recorded interactions are appended to
+#include <mutex>
+// Includes the mutex class, since searches record and replay from several workers
+
+struct HttpChunk {
+    size_t end;
+    // Size of the body received once this chunk arrived
+    double atMs;
+    // Time the chunk arrived, in milliseconds since the request started
+};
+// One chunk of a recorded response body
+
+struct HttpInteraction {
+    std::string path;
+    // Request path and query, with the credentials scrubbed
+    int status;
+    // HTTP status of the response
+    std::string contentType;
+    // Content-Type of the response
+    double headersAtMs;
+    // Time the response headers arrived, in milliseconds since the request started
+    std::vector<HttpChunk> chunks;
+    // Arrival profile of the body
+    std::string body;
+    // Response body, byte for byte
+
+    HttpInteraction() : status(0), headersAtMs(0.0) {}
+};
+// One recorded request/response pair
+
+class HttpCassette {
+public:
+    enum Mode {
+        ModeRecord,
+        // Requests go to the network and every response is appended to the cassette
+        ModeReplay
+        // Requests are answered from the cassette; nothing goes to the network
+    };
+
+    HttpCassette(const std::string& filename, Mode mode);
+    // Constructor: starts a new cassette file for recording, or loads one for replay
+    // Throws std::runtime_error if the file cannot be opened or is not a cassette
+
+    Mode getMode() const;
+    // Whether this cassette records or replays
+
+    void setReplaySpeed(double speed);
+    // Scales the recorded timing on replay: 1 reproduces it, 2 runs twice as fast, 0 delivers at once
+
+    double getReplaySpeed() const;
+    // Current replay speed
+
+    void record(const HttpInteraction& interaction);
+    // Function to append an interaction to the cassette file (record mode)
+
+    bool findReplay(const std::string& path, HttpInteraction& interaction);
+    // Function to get the next recording of a request path (replay mode)
+    // Repeated requests get the recordings in order and start over after the last one; false if there are none
+
+    size_t getInteractionCount() const;
+    // Number of interactions recorded or loaded
+
+    std::vector<HttpInteraction> getRecordings() const;
+    // Every loaded interaction (replay mode), for benchmarks that run on recorded payloads
+
+    static std::string scrub(const std::string& path);
+    // Function to replace the app_id and app_key values of a request path, so cassettes can be shared
+
+private:
+    const std::string filename;
+    // File the cassette is stored in
+
+    const Mode mode;
+    // Record or replay
+
+    mutable std::mutex mutex;
+    // Mutex for the members below
+
+    double replaySpeed;
+    // Timing scale used on replay
+
+    std::ofstream output;
+    // Cassette file being recorded
+
+    size_t interactionCount;
+    // Number of interactions recorded or loaded
+
+    std::map<std::string, std::vector<HttpInteraction>> recordings;
+    // Loaded interactions by request path (replay mode)
+
+    std::map<std::string, size_t> nextRecording;
+    // Index of the recording each path gets next (replay mode)
+
+    void load();
+    // Function to read every interaction of the cassette file
+};
@@ -5,6 +5,8 @@
 
 struct Job {
     // Defines the Job struct to represent a job listing
+    std::string id;
+    // Adzuna id of the posting; empty for favorites saved before ids were kept
     std::string title;
     std::string company;
     std::string location;
@@ -18,6 +20,8 @@ struct Job {
     // Category of the job
     std::string url;
     // URL for more details about the job
+    std::string created;
+    // Time the job was posted, as the API sends it ("2024-01-01T00:00:00Z"); empty if unknown
 
     Job() : salary(0.0), salaryCurrency("") {}
     // Default constructor: initializes salary to 0.0 and salaryCurrency to an empty string
@@ -0,0 +1,463 @@
+#include "JobIndex.h"
+// Includes the header file for the JobIndex class
+
+#include "Collation.h"
+// Includes makeCollationKey, so terms match regardless of case
+
+#include <algorithm>
+// Includes std::sort, std::min and std::lower_bound
+
+#include <cmath>
+// Includes std::log
+
+#include <queue>
+// Includes the priority queue holding the best matches
+
+#include <memory>
+// Includes unique_ptr for the cursors
+
+#include <functional>
+// Includes std::greater
+
+namespace {
+    const size_t blockSize = 128;
+    // Postings per compressed block
+
+    const uint32_t noMoreJobs = UINT32_MAX;
+    // Position of a cursor past the end of its list
+
+    const double k1 = 1.2;
+    const double b = 0.75;
+    // BM25 term frequency saturation and length normalization
+
+    struct WeightedField {
+        std::string Job::*field;
+        uint16_t weight;
+    };
+
+    const WeightedField indexedFields[] = {
+        { &Job::title, 3 }, { &Job::company, 2 }, { &Job::category, 1 }, { &Job::description, 1 }
+    };
+    // Fields searched, with the weight of a term found in each (a simple BM25F)
+
+    void tokenize(const std::string& text, std::vector<std::string>& terms) {
+        // Function to split a text into case-folded terms: runs of letters and digits, plus "+" and "#" after
+        // them so "C++" and "C#" stay searchable. Non-ASCII bytes count as letters, so UTF-8 words stay whole
+        std::string key = makeCollationKey(text);
+        std::string term;
+        for (char c : key) {
+            unsigned char byte = (unsigned char)c;
+            if ((byte >= 'a' && byte <= 'z') || (byte >= '0' && byte <= '9') || byte >= 0x80 ||
+                (!term.empty() && (byte == '+' || byte == '#'))) {
+                term += c;
+            }
+            else if (!term.empty()) {
+                terms.push_back(term);
+                term.clear();
+            }
+        }
+        if (!term.empty()) {
+            terms.push_back(term);
+        }
+    }
+
+    void writeVarint(std::vector<uint8_t>& bytes, uint32_t value) {
+        // Function to append an integer in 7-bit groups, low bits first; small gaps take one byte
+        while (value >= 0x80) {
+            bytes.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back((uint8_t)value);
+    }
+
+    uint32_t readVarint(const uint8_t*& data) {
+        // Function to read an integer written by writeVarint
+        uint32_t value = 0;
+        int shift = 0;
+        while (*data & 0x80) {
+            value |= (uint32_t)(*data++ & 0x7F) << shift;
+            shift += 7;
+        }
+        value |= (uint32_t)(*data++) << shift;
+        return value;
+    }
+
+    struct Scorer {
+        double averageLength;
+        // Average weighted job length
+
+        double termScore(double idf, uint32_t frequency, uint32_t length) const {
+            // Function to compute the BM25 contribution of one term to one job
+            double norm = k1 * (1.0 - b + b * length / averageLength);
+            return idf * frequency * (k1 + 1.0) / (frequency + norm);
+        }
+
+        double scoreBound(double idf, uint32_t maxFrequency, double minLengthPerFrequency) const {
+            // Function to bound the score of a term over a set of jobs. The score is
+            // idf * (k1 + 1) / (1 + k1 * (1 - b) / frequency + k1 * b / averageLength * length / frequency),
+            // so the highest frequency and the lowest length / frequency ratio give a bound that holds for every
+            // average length, unlike a score computed when the block was written
+            return idf * (k1 + 1.0) / (1.0 + k1 * (1.0 - b) / maxFrequency + k1 * b / averageLength * minLengthPerFrequency);
+        }
+    };
+}
+
+class JobIndex::Cursor {
+public:
+    Cursor(const PostingList& list, double idf, const Scorer& scorer)
+        : list(list), idf(idf), scorer(scorer), block(0), count(0), position(0), job(noMoreJobs), boundBlock(SIZE_MAX), blockBound(0.0) {
+        // Constructor: positions the cursor on the first posting
+        blockCount = list.blocks.size() + (list.tailJobs.empty() ? 0 : 1);
+        upperBound = scorer.scoreBound(idf, list.maxFrequency, list.minLengthPerFrequency);
+        if (blockCount > 0) {
+            decode(0);
+        }
+    }
+
+    uint32_t getJob() const {
+        return job;
+    }
+
+    double getUpperBound() const {
+        // Highest score this term gives any job
+        return upperBound;
+    }
+
+    double score(const std::vector<uint32_t>& lengths) const {
+        // Function to get the term's score for the current job
+        return scorer.termScore(idf, blockFrequencies[position], lengths[job]);
+    }
+
+    void next() {
+        // Function to move to the next posting
+        if (++position < count) {
+            job = blockJobs[position];
+        }
+        else if (block + 1 < blockCount) {
+            decode(block + 1);
+        }
+        else {
+            job = noMoreJobs;
+        }
+    }
+
+    void advanceTo(uint32_t target) {
+        // Function to move to the first posting at or after a job number, skipping whole blocks unread
+        if (job >= target) return;
+        size_t found = findBlock(target);
+        if (found >= blockCount) {
+            job = noMoreJobs;
+            return;
+        }
+        if (found != block) {
+            decode(found);
+        }
+        while (blockJobs[position] < target) {
+            position++;
+        }
+        job = blockJobs[position];
+    }
+
+    double getBlockBound(uint32_t target, uint32_t& blockEnd) {
+        // Function to get the highest score this term gives any job in the block holding target, and the end of
+        // that block, without decoding it
+        size_t found = findBlock(target);
+        if (found >= blockCount) {
+            blockEnd = noMoreJobs;
+            return 0.0;
+        }
+        if (found < list.blocks.size()) {
+            const PostingBlock& skip = list.blocks[found];
+            blockEnd = skip.lastJob;
+            if (found != boundBlock) {
+                boundBlock = found;
+                blockBound = scorer.scoreBound(idf, skip.maxFrequency, skip.minLengthPerFrequency);
+            }
+            // The same block is usually asked about many times in a row
+            return blockBound;
+        }
+        blockEnd = list.tailJobs.back();
+        return upperBound;
+        // The tail block is small; the list-wide bound is close enough
+    }
+
+private:
+    const PostingList& list;
+    // List being read
+    const double idf;
+    // Inverse document frequency of the term
+    const Scorer& scorer;
+    // Shared BM25 parameters of the search
+    double upperBound;
+    // Highest score of the term in any job
+    size_t blockCount;
+    // Full blocks plus the tail block, if any
+    size_t block;
+    // Block decoded into blockJobs and blockFrequencies
+    uint32_t blockJobs[blockSize];
+    uint16_t blockFrequencies[blockSize];
+    size_t count;
+    // Postings of the decoded block
+    size_t position;
+    // Current posting in the decoded block
+    uint32_t job;
+    // Current job number, noMoreJobs past the end
+    size_t boundBlock;
+    double blockBound;
+    // Score bound of the block getBlockBound() looked at last
+
+    size_t findBlock(uint32_t target) const {
+        // Function to find the first block, from the current one on, whose last job is at or after target
+        if (block < list.blocks.size() && list.blocks[block].lastJob >= target) {
+            return block;
+        }
+        // Usually the current one
+        if (block >= list.blocks.size()) {
+            return !list.tailJobs.empty() && list.tailJobs.back() >= target ? list.blocks.size() : blockCount;
+        }
+        std::vector<PostingBlock>::const_iterator found = std::lower_bound(list.blocks.begin() + block, list.blocks.end(), target,
+            [](const PostingBlock& skip, uint32_t value) { return skip.lastJob < value; });
+        if (found != list.blocks.end()) {
+            return found - list.blocks.begin();
+        }
+        return !list.tailJobs.empty() && list.tailJobs.back() >= target ? list.blocks.size() : blockCount;
+    }
+
+    void decode(size_t index) {
+        // Function to read a block into blockJobs and blockFrequencies
+        block = index;
+        position = 0;
+        if (index < list.blocks.size()) {
+            const PostingBlock& skip = list.blocks[index];
+            const uint8_t* data = list.bytes.data() + skip.offset;
+            uint32_t previous = index > 0 ? list.blocks[index - 1].lastJob : 0;
+            for (size_t i = 0; i < skip.count; i++) {
+                previous += readVarint(data);
+                blockJobs[i] = previous;
+                blockFrequencies[i] = (uint16_t)readVarint(data);
+            }
+            count = skip.count;
+        }
+        else {
+            count = list.tailJobs.size();
+            std::copy(list.tailJobs.begin(), list.tailJobs.end(), blockJobs);
+            std::copy(list.tailFrequencies.begin(), list.tailFrequencies.end(), blockFrequencies);
+        }
+        job = blockJobs[0];
+    }
+};
+
+JobIndex::JobIndex() : totalLength(0), postingBytes(0) {
+    // Constructor for the JobIndex class
+}
+
+size_t JobIndex::add(const std::vector<Job>& newJobs) {
+    // Function to index jobs, appending their postings to the term lists
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t added = 0;
+    std::vector<std::string> terms;
+    std::vector<std::pair<std::string, uint16_t>> weighted;
+    for (const Job& job : newJobs) {
+        if (!indexedUrls.insert(std::make_pair(job.url, (uint32_t)jobs.size())).second) {
+            continue;
+        }
+        // The same job comes back from every search that matches it
+
+        weighted.clear();
+        for (const WeightedField& field : indexedFields) {
+            terms.clear();
+            tokenize(job.*field.field, terms);
+            for (std::string& term : terms) {
+                weighted.push_back(std::make_pair(std::move(term), field.weight));
+            }
+        }
+        std::sort(weighted.begin(), weighted.end());
+        // Equal terms end up next to each other
+
+        uint32_t number = (uint32_t)jobs.size();
+        uint32_t length = 0;
+        for (const std::pair<std::string, uint16_t>& term : weighted) {
+            length += term.second;
+        }
+        lengths.push_back(length);
+        totalLength += length;
+        for (size_t i = 0; i < weighted.size();) {
+            uint32_t frequency = 0;
+            size_t end = i;
+            while (end < weighted.size() && weighted[end].first == weighted[i].first) {
+                frequency += weighted[end].second;
+                end++;
+            }
+            appendPosting(postings[weighted[i].first], number, (uint16_t)std::min<uint32_t>(frequency, UINT16_MAX));
+            i = end;
+        }
+        // Job numbers only grow, so every posting goes to the end of its list
+
+        jobs.push_back(job);
+        added++;
+    }
+    return added;
+}
+
+void JobIndex::appendPosting(PostingList& list, uint32_t job, uint16_t frequency) {
+    // Function to add a posting and compress the tail block once it is full
+    list.tailJobs.push_back(job);
+    list.tailFrequencies.push_back(frequency);
+    list.maxFrequency = std::max(list.maxFrequency, frequency);
+    list.minLengthPerFrequency = std::min(list.minLengthPerFrequency, (double)lengths[job] / frequency);
+    list.jobCount++;
+
+    if (list.tailJobs.size() < blockSize) return;
+
+    PostingBlock skip;
+    skip.offset = (uint32_t)list.bytes.size();
+    skip.count = (uint16_t)list.tailJobs.size();
+    skip.lastJob = list.tailJobs.back();
+    skip.maxFrequency = 0;
+    skip.minLengthPerFrequency = 1e30;
+    uint32_t previous = list.blocks.empty() ? 0 : list.blocks.back().lastJob;
+    for (size_t i = 0; i < list.tailJobs.size(); i++) {
+        writeVarint(list.bytes, list.tailJobs[i] - previous);
+        writeVarint(list.bytes, list.tailFrequencies[i]);
+        previous = list.tailJobs[i];
+        skip.maxFrequency = std::max(skip.maxFrequency, list.tailFrequencies[i]);
+        skip.minLengthPerFrequency = std::min(skip.minLengthPerFrequency, (double)lengths[list.tailJobs[i]] / list.tailFrequencies[i]);
+    }
+    // Gaps between job numbers are small, so most postings take two bytes
+    list.blocks.push_back(skip);
+    postingBytes += list.bytes.size() - skip.offset;
+    list.tailJobs.clear();
+    list.tailFrequencies.clear();
+}
+
+std::vector<Job> JobIndex::search(const std::string& query, size_t limit) const {
+    // Function to find the top matches with block-max WAND: jobs whose score bound cannot reach the current
+    // top results are skipped, a block at a time where the block bounds allow it
+    std::vector<std::string> terms;
+    tokenize(query, terms);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Job> matches;
+    if (jobs.empty() || limit == 0) return matches;
+
+    Scorer scorer;
+    scorer.averageLength = std::max(1.0, (double)totalLength / jobs.size());
+
+    std::vector<std::unique_ptr<Cursor>> owned;
+    std::vector<Cursor*> cursors;
+    for (const std::string& term : terms) {
+        std::unordered_map<std::string, PostingList>::const_iterator found = postings.find(term);
+        if (found == postings.end()) continue;
+        double df = found->second.jobCount;
+        double idf = std::log(1.0 + (jobs.size() - df + 0.5) / (df + 0.5));
+        owned.push_back(std::unique_ptr<Cursor>(new Cursor(found->second, idf, scorer)));
+        cursors.push_back(owned.back().get());
+    }
+    // Terms that occur nowhere cannot match; the others need not all match (a ranked OR query)
+
+    typedef std::pair<double, uint32_t> Match;
+    std::priority_queue<Match, std::vector<Match>, std::greater<Match>> best;
+    // The best matches so far, worst on top
+
+    while (true) {
+        for (size_t i = 1; i < cursors.size(); i++) {
+            for (size_t j = i; j > 0 && cursors[j]->getJob() < cursors[j - 1]->getJob(); j--) {
+                std::swap(cursors[j], cursors[j - 1]);
+            }
+        }
+        while (!cursors.empty() && cursors.back()->getJob() == noMoreJobs) {
+            cursors.pop_back();
+        }
+        // Sorted by current job; only the cursors that moved are out of place, so an insertion sort is cheapest
+        double threshold = best.size() < limit ? 0.0 : best.top().first;
+
+        size_t pivot = cursors.size();
+        double bound = 0.0;
+        for (size_t i = 0; i < cursors.size(); i++) {
+            bound += cursors[i]->getUpperBound();
+            if (bound > threshold) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot == cursors.size()) break;
+        // No job from here on can beat the current top results
+
+        uint32_t pivotJob = cursors[pivot]->getJob();
+        while (pivot + 1 < cursors.size() && cursors[pivot + 1]->getJob() == pivotJob) {
+            pivot++;
+        }
+
+        double blockBound = 0.0;
+        uint32_t nextCandidate = noMoreJobs;
+        for (size_t i = 0; i <= pivot; i++) {
+            uint32_t blockEnd = noMoreJobs;
+            blockBound += cursors[i]->getBlockBound(pivotJob, blockEnd);
+            nextCandidate = std::min(nextCandidate, blockEnd);
+        }
+        if (blockBound <= threshold) {
+            nextCandidate = nextCandidate == noMoreJobs ? noMoreJobs : nextCandidate + 1;
+            if (pivot + 1 < cursors.size()) {
+                nextCandidate = std::min(nextCandidate, cursors[pivot + 1]->getJob());
+            }
+            for (size_t i = 0; i <= pivot; i++) {
+                cursors[i]->advanceTo(nextCandidate);
+            }
+            continue;
+        }
+        // The blocks holding the pivot cannot beat the top results: skip to the end of the shortest of them
+
+        if (cursors[0]->getJob() == pivotJob) {
+            double score = 0.0;
+            for (size_t i = 0; i <= pivot; i++) {
+                score += cursors[i]->score(lengths);
+                cursors[i]->next();
+            }
+            if (best.size() < limit) {
+                best.push(Match(score, pivotJob));
+            }
+            else if (score > best.top().first) {
+                best.pop();
+                best.push(Match(score, pivotJob));
+            }
+        }
+        // Every term at or before the pivot is on the pivot job: score it
+        else {
+            for (size_t i = 0; i < pivot && cursors[i]->getJob() < pivotJob; i++) {
+                cursors[i]->advanceTo(pivotJob);
+            }
+        }
+        // Otherwise move the terms before the pivot up to it; the jobs they skip cannot reach the threshold
+    }
+
+    std::vector<Match> ranked;
+    while (!best.empty()) {
+        ranked.push_back(best.top());
+        best.pop();
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const Match& a, const Match& c) {
+        return a.first != c.first ? a.first > c.first : a.second < c.second;
+    });
+    matches.reserve(ranked.size());
+    for (const Match& match : ranked) {
+        matches.push_back(jobs[match.second]);
+    }
+    return matches;
+}
+
+size_t JobIndex::getJobCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+size_t JobIndex::getTermCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return postings.size();
+}
+
+size_t JobIndex::getPostingBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return postingBytes;
+}
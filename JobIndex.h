@@ -0,0 +1,93 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <mutex>
+// Includes the mutex class, since searches add jobs from the workers while the UI queries
+#include "Job.h"
+// Includes the Job header file - contains the Job struct definition
+
+class JobIndex {
+public:
+    JobIndex();
+    // Constructor for an empty index
+
+    size_t add(const std::vector<Job>& jobs);
+    // Function to index jobs; a job whose URL is already indexed is skipped. Returns the number of jobs added
+
+    std::vector<Job> search(const std::string& query, size_t limit) const;
+    // Function to find the best matches of a free-text query in the title, company, category and description
+    // Ranked by BM25 (a title match weighs three times a description match, a company match twice), best first
+
+    size_t getJobCount() const;
+    // Number of jobs indexed
+
+    size_t getTermCount() const;
+    // Number of distinct terms
+
+    size_t getPostingBytes() const;
+    // Size of the compressed postings
+
+private:
+    struct PostingBlock {
+        uint32_t lastJob;
+        // Highest job number in the block
+        uint32_t offset;
+        // Start of the block in PostingList::bytes
+        uint16_t count;
+        // Number of postings in the block
+        uint16_t maxFrequency;
+        double minLengthPerFrequency;
+        // Highest term frequency and lowest job length / term frequency of the block; together they bound the
+        // score of any job in it (BM25 rises with the frequency and falls with the length)
+    };
+    // A compressed block of postings
+
+    struct PostingList {
+        std::vector<uint8_t> bytes;
+        // Full blocks: job number gaps and term frequencies as variable-length integers
+        std::vector<PostingBlock> blocks;
+        // Where each full block starts, with its skip and score-bound data
+        std::vector<uint32_t> tailJobs;
+        std::vector<uint16_t> tailFrequencies;
+        // Postings of the block being filled, uncompressed until it is full
+        uint16_t maxFrequency;
+        double minLengthPerFrequency;
+        // Bounds over the whole list
+        uint32_t jobCount;
+        // Number of jobs containing the term
+
+        PostingList() : maxFrequency(0), minLengthPerFrequency(1e30), jobCount(0) {}
+    };
+    // The jobs containing one term, in job number order
+
+    class Cursor;
+    // Position in a posting list during a search (defined in JobIndex.cpp)
+
+    mutable std::mutex mutex;
+    // Mutex for the members below
+
+    std::vector<Job> jobs;
+    // Indexed jobs; a job's number is its position
+
+    std::vector<uint32_t> lengths;
+    // Weighted number of terms of each job, for BM25's length normalization (set before the job's postings)
+
+    uint64_t totalLength;
+    // Sum of lengths, for the average
+
+    std::unordered_map<std::string, PostingList> postings;
+    // Posting list of each term
+
+    std::unordered_map<std::string, uint32_t> indexedUrls;
+    // Job number of each indexed URL, so a job fetched twice is indexed once
+
+    size_t postingBytes;
+    // Size of the compressed postings
+
+    void appendPosting(PostingList& list, uint32_t job, uint16_t frequency);
+    // Function to add a posting to the tail block, compressing the block when it is full
+};
@@ -1,208 +1,870 @@
-#define CPPHTTPLIB_OPENSSL_SUPPORT
-// Define this macro to enable OpenSSL support in the httplib library
-
 #include "JobSearch.h"
 // Include the header file for the JobSearch class
 
+#include "Profiler.h"
+// Include the profiler, which receives the stage timings of each search
+
+#include "Trace.h"
+// Include the tracer, which records the search pipeline as a timeline
+
+
 #include <sstream>
 // Include the string stream library for string manipulation
 
-JobSearch::JobSearch() : stopThread(false), searchRequested(false) {
+#include <thread>
+// Include the thread library for pacing replayed responses and running hedged requests
+
+#include <algorithm>
+// Include std::max and std::min_element
+
+#include <cctype>
+// Include std::tolower and std::isspace for normalizing queries
+
+#include <ctime>
+// Include std::time for the time of a fetch, which the created times of the postings are compared with
+
+#include <unordered_set>
+// Include the set of ids a delta sync has read
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const int deltaPageSize = 10;
+    // Postings per delta request; a repeated search with nothing new costs one small page
+
+    const int maxDeltaPages = 5;
+    // Delta requests per search at most; with more new postings than that the results are fetched in full
+
+    const std::chrono::hours maxDeltaAge(6);
+    // Time after a full fetch when a repeated search is fetched in full again, so the ranking and the expired
+    // postings are brought up to date
+
+    const int64_t ingestDelaySeconds = 3600;
+    // Postings can reach the API a while after their created time; a sync reads back to this long before the last
+    // fetch, so a posting that shows up later than that is only found by the next full fetch
+
+    const size_t deltaCacheCapacity = 64;
+    // Searches whose results are kept for delta syncs; the least recently used is dropped first
+
+    const std::string& getJobKey(const Job& job) {
+        // Function to get what identifies a posting: its Adzuna id, or its URL if it has none
+        return job.id.empty() ? job.url : job.id;
+    }
+
+    int64_t parseTimestamp(const std::string& text) {
+        // Function to turn a created time ("2024-01-01T00:00:00Z") into seconds since 1970; 0 if malformed
+        if (text.size() < 19 || text[4] != '-' || text[7] != '-' || text[10] != 'T' || text[13] != ':' || text[16] != ':') {
+            return 0;
+        }
+        int64_t year = std::atoi(text.substr(0, 4).c_str());
+        const int64_t month = std::atoi(text.substr(5, 2).c_str());
+        const int64_t day = std::atoi(text.substr(8, 2).c_str());
+        const int64_t seconds = std::atoi(text.substr(11, 2).c_str()) * 3600 + std::atoi(text.substr(14, 2).c_str()) * 60 +
+            std::atoi(text.substr(17, 2).c_str());
+
+        year -= month <= 2 ? 1 : 0;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const int64_t yearOfEra = year - era * 400;
+        const int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return (era * 146097 + dayOfEra - 719468) * 86400 + seconds;
+        // Days since 1970 of a civil date (Howard Hinnant's days-from-civil algorithm); the API's times are UTC
+    }
+
+    struct StageClock {
+        Clock::time_point requested;
+        Clock::time_point started;
+        Clock::time_point handshakeStarted;
+        Clock::time_point handshakeDone;
+        Clock::time_point headersReceived;
+        Clock::time_point bodyReceived;
+        Clock::time_point parsed;
+        Clock::time_point published;
+    };
+    // Time points between the stages of one search
+
+    void tlsInfoCallback(const SSL* ssl, int where, int) {
+        // Function called by OpenSSL during the handshake; records its start and end
+        StageClock* stages = static_cast<StageClock*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+        if (!stages) return;
+        if (where & SSL_CB_HANDSHAKE_START) stages->handshakeStarted = Clock::now();
+        if (where & SSL_CB_HANDSHAKE_DONE) stages->handshakeDone = Clock::now();
+    }
+
+    double elapsedMs(Clock::time_point from, Clock::time_point to) {
+        // Function to get the duration between two time points, zero if a stage was not reached
+        if (from == Clock::time_point() || to == Clock::time_point() || to < from) return 0.0;
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    void sleepUntilMs(Clock::time_point start, double ms, double speed) {
+        // Function to wait until a recorded time offset, scaled by the replay speed
+        if (speed <= 0.0) return;
+        std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms / speed)));
+    }
+
+    httplib::Result replayInteraction(const HttpInteraction& interaction, double speed, Clock::time_point start,
+        const httplib::ResponseHandler& onHeaders, const httplib::ContentReceiver& onData) {
+        // Function to deliver a recorded response through the same callbacks as a network response, with its timing
+        std::unique_ptr<httplib::Response> response(new httplib::Response());
+        response->status = interaction.status;
+        response->set_header("Content-Type", interaction.contentType);
+
+        sleepUntilMs(start, interaction.headersAtMs, speed);
+        if (!onHeaders(*response)) {
+            return httplib::Result(nullptr, httplib::Error::Canceled);
+        }
+
+        size_t offset = 0;
+        for (const HttpChunk& chunk : interaction.chunks) {
+            size_t end = std::min(chunk.end, interaction.body.size());
+            if (end <= offset) continue;
+            sleepUntilMs(start, chunk.atMs, speed);
+            if (!onData(interaction.body.data() + offset, end - offset)) {
+                return httplib::Result(nullptr, httplib::Error::Canceled);
+            }
+            offset = end;
+        }
+        if (offset < interaction.body.size() && !onData(interaction.body.data() + offset, interaction.body.size() - offset)) {
+            return httplib::Result(nullptr, httplib::Error::Canceled);
+        }
+        // Same chunk boundaries as the recording
+
+        return httplib::Result(std::move(response), httplib::Error::Success);
+    }
+}
+
+struct JobSearch::DeltaEntry {
+    std::vector<Job> results;
+    // Results shown the last time, new postings first
+    std::unordered_set<std::string> ids;
+    // Ids of the results and of every posting a delta sync has read since the full fetch
+    int64_t cutoff;
+    // Created time, in seconds since 1970, up to which no posting is new: the time of the last fetch or sync less
+    // the ingest delay
+    Clock::time_point fetchedAt;
+    // Time of the last full fetch
+    uint64_t lastUse;
+    // Use counter value of the last search that read the entry, for the least-recently-used eviction
+};
+
+struct JobSearch::RequestAttempt {
+    StageClock stages;
+    // Stage times of this request
+    std::string body;
+    // Body received so far
+    HttpInteraction interaction;
+    // Timing profile of the response, for the cassette
+    httplib::Result res;
+    // Response, or the error if there was none
+    RequestOutcome outcome;
+    // How the request went, as reported to the rate limiter
+    double retryAfter;
+    // Retry-After of the response in seconds, 0 if none
+    bool done;
+    // Set under race->mutex once the fields above are final
+    std::atomic<bool> abandoned;
+    // Set when the other request of a hedged pair won; the download stops at its next chunk
+    std::shared_ptr<RequestRace> race;
+    // State shared with the other request of the pair
+
+    RequestAttempt() : stages(), outcome(RequestOutcomeCancelled), retryAfter(0.0), done(false), abandoned(false) {}
+};
+
+struct JobSearch::RequestRace {
+    std::mutex mutex;
+    // Mutex for the done flags of both requests
+    std::condition_variable finished;
+    // Signalled when one of the requests finishes
+    std::atomic<const RequestAttempt*> reporter;
+    // The request whose progress the handle reports: the first to receive usable headers
+
+    RequestRace() : reporter(nullptr) {}
+};
+
+JobSearch::JobSearch(const std::string& configPath, TaskScheduler& scheduler)
+    : scheduler(scheduler), logging(true), searchesInFlight(0), baseUrl("https://api.adzuna.com"), maxRetries(3), hedgeRatio(0.0),
+    deltaSync(false), deltaUses(0) {
     // Constructor for the JobSearch class
-    // Initialize stopThread and searchRequested to false
+    // Initialize with no search running
 
-    updateApiCredentials(app_id, api_key, "config.ini");
+    updateApiCredentials(app_id, api_key, configPath);
 
-    startSearchThread();
-    // Start the search thread when the object is created
+    if (!cassettePath.empty()) {
+        cassette = std::make_shared<HttpCassette>(cassettePath,
+            cassetteMode == "record" ? HttpCassette::ModeRecord : HttpCassette::ModeReplay);
+    }
+    // A cassette selected in config.ini; replay unless cassette_mode=record
 }
 
 JobSearch::~JobSearch() {
     // Destructor for the JobSearch class
-    stopSearchThread();
-    // Stop the search thread when the object is destroyed
+    std::unique_lock<std::mutex> lock(searchMutex);
+    cv.wait(lock, [this] { return searchesInFlight == 0; });
+    // Wait for the search tasks still using this object
 }
 
-void JobSearch::searchJobs(const std::string& query, const std::string& country,
-    const std::string& salaryRange,
-    int resultsPerPage, const std::string& currencySymbol) {
+std::shared_ptr<SearchHandle> JobSearch::searchJobs(const SearchRequest& request, SearchCallback callback) {
     // Function to initiate a job search with the given parameters
-        {
-            std::lock_guard<std::mutex> lock(searchMutex);
-            // Lock the mutex to ensure thread-safe access to shared data
+    TRACE_SCOPE("JobSearch::searchJobs", "search");
+
+    std::shared_ptr<SearchHandle> search = std::make_shared<SearchHandle>(request, std::move(callback));
+    // The handle owns a copy of the parameters and will receive this search's own results
 
-            results.clear();  // Clear previous results
-            // Clear the previous search results
+    {
+        std::lock_guard<std::mutex> lock(searchMutex);
+        searchesInFlight++;
+    }
 
-            currentQuery = query;
-            currentCountry = country;
-            currentSalaryRange = salaryRange;
-            currentResultsPerPage = resultsPerPage;
-            currentCurrencySymbol = currencySymbol;
-            // Store the search parameters
+    scheduler.submit([this, search]() {
+        admitSearch(search);
+    }, TaskPriorityHigh);
+    // Run the search on the shared scheduler; the UI is waiting for it, so it goes ahead of background work
 
-            searchRequested = true;
-            // Set the flag to indicate a search has been requested
-        }
-    cv.notify_one();
-    // Notify the search thread that a new search has been requested
+    return search;
 }
 
-std::vector<Job> JobSearch::getResults() const {
-    // Function to retrieve the current search results
-    std::lock_guard<std::mutex> lock(searchMutex);
-    // Lock the mutex to ensure thread-safe access to the results
+void JobSearch::admitSearch(const std::shared_ptr<SearchHandle>& search) {
+    // Function to run a search as soon as the rate limiter allows its first request
+    bool admitted = false;
+    if (!search->isCancelRequested() && !(cassette && cassette->getMode() == HttpCassette::ModeReplay)) {
+        std::chrono::steady_clock::duration retryIn;
+        if (!rateLimiter.tryAcquire(retryIn)) {
+            scheduler.submitAfter(retryIn, [this, search]() {
+                admitSearch(search);
+            }, TaskPriorityHigh);
+            return;
+        }
+        admitted = true;
+    }
+    // Over the quota, the search waits on the scheduler's timer instead of a worker: an all-countries search
+    // trickles out at the quota's pace without taking the workers away from the rest of the application.
+    // A replayed search sends nothing, so it does not wait
 
-    return results;
-    // Return a copy of the results vector
-}
+    performSearch(search, admitted);
 
-void JobSearch::startSearchThread() {
-    // Function to start the search thread
-    searchThread = std::thread(&JobSearch::searchThreadFunction, this);
-    // Create and start a new thread, running the searchThreadFunction
+    std::lock_guard<std::mutex> lock(searchMutex);
+    searchesInFlight--;
+    cv.notify_all();
 }
 
-void JobSearch::stopSearchThread() {
-    // Function to stop the search thread
-    {
-        std::lock_guard<std::mutex> lock(searchMutex);
-        // Lock the mutex
+void JobSearch::setLogging(bool enabled) {
+    logging = enabled;
+}
 
-        stopThread = true;
-        // Set the flag to stop the thread
-    }
+void JobSearch::setRateLimit(double requestsPerMinute, int burst, int maxConcurrency) {
+    rateLimiter.configure(requestsPerMinute / 60.0, burst, maxConcurrency);
+}
 
-    cv.notify_one();
-    // Notify the search thread to check its stop condition
-    if (searchThread.joinable()) {
-        searchThread.join();
-        // Wait for the search thread to finish if it's joinable
-    }
+void JobSearch::setMaxRetries(int retries) {
+    maxRetries = retries < 0 ? 0 : retries;
 }
 
-void JobSearch::searchThreadFunction() {
-    // The main function that runs in the search thread
-    while (!stopThread) {
-        // Continue running until stopThread is set to true
-        std::unique_lock<std::mutex> lock(searchMutex);
-        // Lock the mutex
+void JobSearch::setHedging(double maxHedgeRatio) {
+    hedgeRatio = maxHedgeRatio < 0.0 ? 0.0 : maxHedgeRatio;
+}
 
-        cv.wait(lock, [this] { return searchRequested || stopThread; });
-        // Wait for a search request or a stop signal
+RateLimiterStats JobSearch::getRateLimiterStats() const {
+    return rateLimiter.getStats();
+}
 
-        if (stopThread) break;
-        // If stop is requested, exit the loop
+void JobSearch::setCassette(std::shared_ptr<HttpCassette> newCassette) {
+    cassette = newCassette;
+}
 
-        if (searchRequested) {
+void JobSearch::setIndex(std::shared_ptr<JobIndex> newIndex) {
+    index = newIndex;
+}
 
-            lock.unlock();
-            // Unlock the mutex before performing the search
+void JobSearch::setStore(std::shared_ptr<JobStore> newStore) {
+    store = newStore;
+}
 
-            performSearch();
-            // Perform the actual search
+void JobSearch::setDeltaSync(bool enabled) {
+    deltaSync = enabled;
+}
 
-            lock.lock();
-            // Lock the mutex before Reset the search request flag
-            searchRequested = false;
-            // Reset the search request flag
+std::string JobSearch::getDeltaKey(const SearchRequest& request) {
+    // Function to identify a search regardless of the case and spacing of its query
+    std::string key;
+    for (char c : request.query) {
+        if (std::isspace((unsigned char)c)) {
+            if (!key.empty() && key.back() != ' ') key += ' ';
+        }
+        else {
+            key += (char)std::tolower((unsigned char)c);
         }
     }
+    if (!key.empty() && key.back() == ' ') key.pop_back();
+    return key + '|' + request.country + '|' + request.salaryRange + '|' + std::to_string(request.resultsPerPage) + '|' + request.currencySymbol;
 }
 
-bool JobSearch::getSearchRequested() {
-    std::lock_guard<std::mutex> lock(searchMutex);
-    // Lock the mutex
-    return searchRequested;
+std::shared_ptr<const JobSearch::DeltaEntry> JobSearch::findDelta(const std::string& key) {
+    // Function to look up the last results of a search, if they can still be brought up to date
+    std::lock_guard<std::mutex> lock(deltaMutex);
+    std::unordered_map<std::string, std::shared_ptr<DeltaEntry>>::iterator found = deltaCache.find(key);
+    if (found == deltaCache.end()) return nullptr;
+    if (Clock::now() - found->second->fetchedAt > maxDeltaAge) {
+        deltaCache.erase(found);
+        return nullptr;
+    }
+    found->second->lastUse = ++deltaUses;
+    return found->second;
 }
 
-void JobSearch::performSearch() {
-    // Function to perform the actual job search
+void JobSearch::recordDelta(const std::string& key, const std::vector<Job>& results, int64_t fetchTime) {
+    // Function to keep the results of a full fetch for the next delta sync
+    std::shared_ptr<DeltaEntry> entry = std::make_shared<DeltaEntry>();
+    entry->results = results;
+    entry->cutoff = fetchTime - ingestDelaySeconds;
+    // Postings already published that ranked below the results are not new the next time either
+    for (const Job& job : results) {
+        entry->ids.insert(getJobKey(job));
+    }
+    entry->fetchedAt = Clock::now();
+
+    std::lock_guard<std::mutex> lock(deltaMutex);
+    entry->lastUse = ++deltaUses;
+    deltaCache[key] = entry;
+    if (deltaCache.size() > deltaCacheCapacity) {
+        std::unordered_map<std::string, std::shared_ptr<DeltaEntry>>::iterator oldest = std::min_element(deltaCache.begin(), deltaCache.end(),
+            [](const std::pair<const std::string, std::shared_ptr<DeltaEntry>>& a, const std::pair<const std::string, std::shared_ptr<DeltaEntry>>& b) {
+                return a.second->lastUse < b.second->lastUse;
+            });
+        deltaCache.erase(oldest);
+    }
+}
 
-    std::string encodedQuery = httplib::detail::encode_url(currentQuery);
-    // URL-encode the search query
+std::vector<Job> JobSearch::mergeDelta(const std::string& key, const DeltaEntry& known, const std::vector<Job>& delta, size_t limit,
+    int64_t fetchTime) {
+    // Function to put the new postings in front of the last results and keep the merged list for the next sync
+    std::shared_ptr<DeltaEntry> entry = std::make_shared<DeltaEntry>();
+    entry->results.reserve(std::min(limit, delta.size() + known.results.size()));
+    entry->ids = known.ids;
+    entry->cutoff = std::max(known.cutoff, fetchTime - ingestDelaySeconds);
+
+    std::unordered_set<std::string> merged;
+    for (const Job& job : delta) {
+        entry->ids.insert(getJobKey(job));
+        // Read now, so not new the next time even if it does not make the page
+        if (entry->results.size() < limit && merged.insert(getJobKey(job)).second) {
+            entry->results.push_back(job);
+        }
+    }
+    for (const Job& job : known.results) {
+        if (entry->results.size() >= limit) break;
+        if (!merged.insert(getJobKey(job)).second) continue;
+        // Reposted, or changed: the fresh copy is already in front
+        entry->results.push_back(job);
+    }
+    entry->fetchedAt = known.fetchedAt;
+    // The age limit counts from the full fetch, which the merged results are still ranked by
 
-    std::stringstream ss;
-    ss << "/v1/api/jobs/" << currentCountry << "/search/1?app_id=" << app_id
-        << "&app_key=" << api_key
-        << "&results_per_page=" << currentResultsPerPage
-        << "&what=" << encodedQuery;
-    // Construct the API request URL
+    std::lock_guard<std::mutex> lock(deltaMutex);
+    entry->lastUse = ++deltaUses;
+    deltaCache[key] = entry;
+    return entry->results;
+}
 
-    if (currentSalaryRange != "Any") {
-        size_t dashPos = currentSalaryRange.find('-');
-        if (dashPos != std::string::npos) {
-            ss << "&salary_min=" << currentSalaryRange.substr(0, dashPos)
-                << "&salary_max=" << currentSalaryRange.substr(dashPos + 1);
-        }
-        else if (currentSalaryRange == "100000+") {
-            ss << "&salary_min=100000";
+void JobSearch::performSearch(const std::shared_ptr<SearchHandle>& handle, bool admitted) {
+    // Function to perform the actual job search
+    TRACE_SCOPE("JobSearch::performSearch", "search");
+    SearchHandle& search = *handle;
+    const SearchRequest& request = search.getRequest();
+
+    StageClock stages = StageClock();
+    stages.requested = search.queuedAt;
+    stages.started = Clock::now();
+    // Every search measures its stages; the handle carries them and the profiler shows the latest
+    // With retries the stages describe the last attempt, with hedging the request that answered first;
+    // waiting for the rate limiter and backoff count as queue wait
+
+    if (search.isCancelRequested()) {
+        if (admitted) {
+            rateLimiter.release(RequestOutcomeCancelled, 0.0, 0.0);
         }
+        search.finish(SearchStatusCancelled);
+        return;
     }
-    // Add salary range parameters to the URL if specified
+    // Cancelled while it was queued; the request it was admitted for is not sent
 
-    std::string path = ss.str();
-    std::cout << "Full URL: https://api.adzuna.com" << path << std::endl;
-    // Log the full URL for debugging purposes
+    search.status.store(SearchStatusRunning, std::memory_order_release);
+    search.notify(SearchEventStarted);
 
-    httplib::SSLClient cli("api.adzuna.com");
-    cli.set_connection_timeout(10);
-    // Create an SSL client with a 10-second timeout
+    std::string path = buildSearchPath(request);
+    if (logging) std::clog << "Full URL: " << baseUrl << path << std::endl;
+    // Log the full URL for debugging purposes
 
-    httplib::Headers headers = {
-        { "Accept", "application/json" }
+    httplib::Result res;
+    std::string body;
+    HttpInteraction interaction;
+    // Timing profile of the response, kept when recording to a cassette
+
+    bool notRecorded = false;
+    int requestsSent = 0;
+    // Requests sent before the current one, retries included
+    auto fetch = [&](const std::string& requestPath) {
+        res = httplib::Result();
+        body.clear();
+        interaction = HttpInteraction();
+        notRecorded = false;
+        {
+            TRACE_SCOPE("Network", "search");
+            if (cassette && cassette->getMode() == HttpCassette::ModeReplay) {
+                httplib::ResponseHandler onHeaders = [&](const httplib::Response&) {
+                    stages.headersReceived = Clock::now();
+                    search.notify(SearchEventHeadersReceived);
+                    return !search.isCancelRequested();
+                };
+                httplib::ContentReceiver onData = [&](const char* data, size_t length) {
+                    body.append(data, length);
+                    search.bytesReceived.store(body.size(), std::memory_order_relaxed);
+                    search.notify(SearchEventDataReceived);
+                    return !search.isCancelRequested();
+                };
+
+                HttpInteraction recorded;
+                search.attempts = requestsSent + 1;
+                if (cassette->findReplay(requestPath, recorded)) {
+                    res = replayInteraction(recorded, cassette->getReplaySpeed(), stages.started, onHeaders, onData);
+                }
+                else {
+                    notRecorded = true;
+                }
+            }
+            // Replay: answer from the cassette with the recorded bytes and timing, without touching the network
+            else {
+                for (int attempt = 0; ; attempt++) {
+                    search.attempts = requestsSent + attempt + 1;
+                    std::shared_ptr<RequestAttempt> sent = sendRequest(requestPath, handle, admitted);
+                    admitted = false;
+                    // Only the first request was admitted before the search started; the others wait here
+                    if (!sent) {
+                        res = httplib::Result(nullptr, httplib::Error::Canceled);
+                        break;
+                    }
+                    // Cancelled while waiting for the rate limiter
+
+                    stages = sent->stages;
+                    body = std::move(sent->body);
+                    interaction = std::move(sent->interaction);
+                    res = std::move(sent->res);
+
+                    if (sent->outcome == RequestOutcomeSuccess || sent->outcome == RequestOutcomeCancelled || attempt >= maxRetries) {
+                        break;
+                    }
+
+                    double delayMs = rateLimiter.getRetryDelayMs(attempt, sent->retryAfter);
+                    if (logging) {
+                        std::clog << "Request failed (" << (res ? "HTTP " + std::to_string(res->status) : httplib::to_string(res.error()))
+                            << "), retrying in " << (int)delayMs << " ms" << std::endl;
+                    }
+                    Clock::time_point retryAt = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(delayMs));
+                    while (Clock::now() < retryAt && !search.isCancelRequested()) {
+                        std::this_thread::sleep_for(std::min<Clock::duration>(retryAt - Clock::now(), std::chrono::milliseconds(50)));
+                    }
+                    // Jittered exponential backoff, cut short by a cancel
+                }
+                // Throttling, server errors and network failures are retried; other responses are final
+
+                if (cassette && res && !search.isCancelRequested()) {
+                    interaction.path = requestPath;
+                    interaction.status = res->status;
+                    interaction.body = body;
+                    cassette->record(interaction);
+                }
+                // Record: the cassette scrubs the credentials from the path
+            }
+        }
+        requestsSent = search.attempts;
     };
-    // Set the request headers
-
-    auto res = cli.Get(path.c_str(), headers);
-    // Send the GET request to the API
+    // Function to send a GET request to the API, reporting progress and collecting the body
 
     std::vector<Job> newResults;
     // Vector to store the new search results
 
-    if (res && res->status == 200) {
+    const std::string deltaKey = deltaSync && request.page == 1 && !request.sortByDate ? getDeltaKey(request) : std::string();
+    std::shared_ptr<const DeltaEntry> known = deltaKey.empty() ? nullptr : findDelta(deltaKey);
+    // The results of the last time this search was run, if they are recent enough to update
+
+    bool synced = false;
+    bool fullFetch = true;
+    std::vector<Job> delta;
+    const int64_t fetchTime = (int64_t)std::time(nullptr);
+    // Postings created after this, less the ingest delay, are new to the next sync
+    if (known) {
+        TRACE_SCOPE("DeltaSync", "search");
+        SearchRequest deltaRequest = request;
+        deltaRequest.sortByDate = true;
+        deltaRequest.resultsPerPage = deltaPageSize;
+        deltaRequest.maxDaysOld = (int)std::max<int64_t>(1, (fetchTime - known->cutoff) / 86400 + 1);
+        // Newest first, and nothing from before the day of the cutoff
+
+        std::unordered_set<std::string> fresh;
+        bool undated = false;
+        for (deltaRequest.page = 1; deltaRequest.page <= maxDeltaPages && !synced && !undated; deltaRequest.page++) {
+            fetch(buildSearchPath(deltaRequest));
+            if (search.isCancelRequested() || !res || res->status != 200) break;
+
+            std::vector<Job> page;
+            try {
+                page = parseResults(body, request.currencySymbol);
+            }
+            catch (const std::exception&) {
+                break;
+            }
+
+            for (Job& job : page) {
+                const std::string& key = getJobKey(job);
+                const int64_t created = parseTimestamp(job.created);
+                if (created == 0) {
+                    undated = true;
+                    break;
+                }
+                // A missing or malformed created time says nothing about where the new postings end
+                if (created <= known->cutoff) {
+                    synced = true;
+                    break;
+                }
+                // Everything from here on was published over an hour before the last fetch
+                if (known->ids.count(key)) continue;
+                // Read by the last fetch or sync; one that reached the API late can still follow it
+                if (fresh.insert(key).second) {
+                    delta.push_back(std::move(job));
+                }
+                // A posting published meanwhile shifts the next page, repeating one already read
+            }
+            if (!undated && (int)page.size() < deltaRequest.resultsPerPage) {
+                synced = true;
+            }
+            // The last page of postings
+        }
+        if (logging && synced) std::clog << "Synced " << delta.size() << " new jobs with " << requestsSent << " requests." << std::endl;
+
+        fullFetch = !synced && !search.isCancelRequested() && (notRecorded || (res && res->status == 200));
+        // Too many new postings to read a page at a time, a posting without a usable created time, a malformed
+        // response or a cassette recorded without the delta requests: fetch the results in full. A failed request
+        // fails the search, as a full fetch would
+    }
+    if (fullFetch) {
+        fetch(path);
+    }
+
+    stages.bodyReceived = Clock::now();
+
+    SearchStatus finalStatus = SearchStatusSucceeded;
+    if (search.isCancelRequested()) {
+        finalStatus = SearchStatusCancelled;
+    }
+    else if (synced) {
+        TRACE_SCOPE("Merge", "search");
+        newResults = mergeDelta(deltaKey, *known, delta, (size_t)request.resultsPerPage, fetchTime);
+        // The new postings first, then the results of the last time without the ones that came again, one page long
+
+        if (index) {
+            index->add(delta);
+        }
+        if (store) {
+            store->add(delta);
+        }
+        // Only the new postings: the others were indexed and stored when they were first fetched
+    }
+    else if (res && res->status == 200) {
         // If the request was successful (HTTP status 200)
-            auto json = nlohmann::json::parse(res->body);
+        TRACE_SCOPE("Parse", "search");
+        try {
+            newResults = parseResults(body, request.currencySymbol);
             // Parse the JSON response
 
-            for (const auto& result : json["results"]) {
-                // Iterate through each job in the results
-                Job job;
-                job.title = result.value("title", "Not specified");
-                job.company = result.value("company", nlohmann::json::object()).value("display_name", "Not specified");
-                job.location = result.value("location", nlohmann::json::object()).value("display_name", "Not specified");
-                job.description = result.value("description", "No description available");
-                job.salary = result.value("salary_min", 0.0);
-                job.salaryCurrency = currentCurrencySymbol;
-                job.category = result.value("category", nlohmann::json::object()).value("label", "Not specified");
-                job.contractType = result.value("contract_type", "Not specified");
-                job.url = result.value("redirect_url", "Not specified");
-                // Populate a Job object with data from the JSON
-
-                newResults.push_back(job);
-                // Add the job to the new results vector
+            if (logging) std::clog << "Found " << newResults.size() << " jobs." << std::endl;
+            // Log the number of jobs found
+
+            if (index) {
+                index->add(newResults);
             }
+            // Index the new jobs here on the worker, so later refinements can be answered locally
 
-            std::cout << "Found " << newResults.size() << " jobs." << std::endl;
-            // Log the number of jobs found
+            if (store) {
+                store->add(newResults);
+            }
+            // Keep them on disk for later sessions; jobs already stored unchanged are skipped
+
+            if (!deltaKey.empty()) {
+                recordDelta(deltaKey, newResults, fetchTime);
+            }
+            // The next time this search is run, only the postings published since are fetched
+        }
+        catch (const std::exception& e) {
+            newResults.clear();
+            search.error = std::string("Invalid response: ") + e.what();
+            finalStatus = SearchStatusFailed;
+            if (logging) std::cerr << search.error << std::endl;
+        }
+        // A malformed response fails this search instead of taking the worker down
     }
     else {
-        std::cerr << "API request failed.\n Check if you have the right api_key and app_id (You can find on the README file.\n Status: " << (res ? std::to_string(res->status) : "No response") << std::endl;
-        if (res) {
-            std::cerr << "Response body: " << res->body << std::endl;
+        search.error = notRecorded ? "No recorded response for " + HttpCassette::scrub(path)
+            : res ? "HTTP " + std::to_string(res->status) : "No response (" + httplib::to_string(res.error()) + ")";
+        if (search.attempts > 1) {
+            search.error += " after " + std::to_string(search.attempts) + " attempts";
+        }
+        finalStatus = SearchStatusFailed;
+        if (logging) {
+            std::cerr << "API request failed.\n Check if you have the right api_key and app_id (You can find on the README file.\n Status: " << (res ? std::to_string(res->status) : "No response") << std::endl;
+            if (res) {
+                std::cerr << "Response body: " << body << std::endl;
+            }
         }
         // Log API request failures
     }
 
+    stages.parsed = Clock::now();
+
+    {
+        TRACE_SCOPE("Publish", "search");
+        search.results = std::make_shared<const std::vector<Job>>(std::move(newResults));
+        search.httpStatus = res ? res->status : 0;
+        // Hand the results to this search's handle as an immutable snapshot
+        // Use std::move for efficiency, transferring ownership of newResults to the snapshot
+    }
+
+    stages.published = Clock::now();
+
+    Clock::time_point connected = stages.handshakeStarted != Clock::time_point() ? stages.handshakeStarted : stages.headersReceived;
+    Clock::time_point secured = stages.handshakeDone != Clock::time_point() ? stages.handshakeDone : connected;
+    // Fall back gracefully if the handshake callbacks did not fire
+
+    search.stageMs[SearchStageQueueWait] = elapsedMs(stages.requested, stages.started);
+    search.stageMs[SearchStageConnect] = elapsedMs(stages.started, connected);
+    search.stageMs[SearchStageTls] = elapsedMs(connected, secured);
+    search.stageMs[SearchStageTtfb] = elapsedMs(secured, stages.headersReceived);
+    search.stageMs[SearchStageDownload] = elapsedMs(stages.headersReceived, stages.bodyReceived);
+    search.stageMs[SearchStageParse] = elapsedMs(stages.bodyReceived, stages.parsed);
+    search.stageMs[SearchStagePublish] = elapsedMs(stages.parsed, stages.published);
+    if (Profiler::isEnabled()) {
+        Profiler::recordSearch(search.stageMs);
+    }
+
+    search.finish(finalStatus);
+    // Wake anyone waiting on the handle and report completion
+}
+
+std::shared_ptr<JobSearch::RequestAttempt> JobSearch::sendRequest(const std::string& path, const std::shared_ptr<SearchHandle>& handle, bool admitted) {
+    // Function to send one request, and a duplicate of it if the first one is slow
+    SearchHandle& search = *handle;
+    if (!admitted && !rateLimiter.acquire([&search]() { return search.isCancelRequested(); })) {
+        return nullptr;
+    }
+    // Every request to the API goes through the shared quota and concurrency limit
+
+    std::shared_ptr<RequestAttempt> primary = std::make_shared<RequestAttempt>();
+    primary->race = std::make_shared<RequestRace>();
+    primary->stages.requested = search.queuedAt;
+
+    double hedgeDelayMs = hedgeRatio > 0.0 ? rateLimiter.getHedgeDelayMs() : 0.0;
+    if (hedgeDelayMs <= 0.0) {
+        runRequest(*primary, path, search);
+        return primary;
+    }
+    // Without hedging, or until enough latencies are known, the request runs on this worker
+
+    RequestRace& race = *primary->race;
+    std::shared_ptr<RequestAttempt> hedge;
+    startRequest(primary, path, handle);
+
+    std::unique_lock<std::mutex> lock(race.mutex);
+    if (!race.finished.wait_for(lock, std::chrono::duration<double, std::milli>(hedgeDelayMs), [&primary]() { return primary->done; })) {
+        lock.unlock();
+        if (!search.isCancelRequested() && rateLimiter.tryAcquireHedge(hedgeRatio)) {
+            hedge = std::make_shared<RequestAttempt>();
+            hedge->race = primary->race;
+            hedge->stages.requested = search.queuedAt;
+            startRequest(hedge, path, handle);
+        }
+        lock.lock();
+    }
+    // Slower than the p95: send the same request again on its own connection, if the hedge budget allows
+
+    auto answered = [](const std::shared_ptr<RequestAttempt>& attempt) {
+        return attempt && attempt->done && attempt->outcome == RequestOutcomeSuccess;
+    };
+    race.finished.wait(lock, [&]() {
+        return answered(primary) || answered(hedge) || (primary->done && (!hedge || hedge->done));
+    });
+    // The first answer wins; a failure only counts once neither request can still answer
+
+    std::shared_ptr<RequestAttempt> winner = answered(hedge) && !answered(primary) ? hedge : primary;
+    std::shared_ptr<RequestAttempt> loser = winner == primary ? hedge : primary;
+    if (loser) {
+        loser->abandoned = true;
+    }
+    if (winner == hedge) {
+        rateLimiter.recordHedgeWin();
+    }
+    return winner;
+}
+
+void JobSearch::startRequest(const std::shared_ptr<RequestAttempt>& attempt, const std::string& path, const std::shared_ptr<SearchHandle>& handle) {
+    // Function to run a request on a thread of its own
     {
         std::lock_guard<std::mutex> lock(searchMutex);
-        results = std::move(newResults);
-        // Update the results vector with the new search results
-        // Use std::move for efficiency, transferring ownership of newResults to results
+        searchesInFlight++;
     }
+    // Counted like a search, so the destructor waits for an abandoned request too
+
+    std::thread([this, attempt, path, handle]() {
+        runRequest(*attempt, path, *handle);
+
+        std::lock_guard<std::mutex> lock(searchMutex);
+        searchesInFlight--;
+        cv.notify_all();
+    }).detach();
+    // Not on the scheduler: a request waiting on the network must not hold up a queued search
+}
+
+void JobSearch::runRequest(RequestAttempt& attempt, const std::string& path, SearchHandle& search) {
+    // Function to send one GET request and report how it went to the rate limiter
+    RequestRace& race = *attempt.race;
+
+    httplib::Client cli(baseUrl);
+    cli.set_connection_timeout(10);
+    // Create a client for the configured host (HTTPS for the real API) with a 10-second timeout
+    // Each request has its own client, so a hedge goes out on a connection of its own
+
+    if (SSL_CTX* context = cli.ssl_context()) {
+        SSL_CTX_set_app_data(context, &attempt.stages);
+        SSL_CTX_set_info_callback(context, tlsInfoCallback);
+    }
+    // Let OpenSSL report when the TLS handshake starts and ends; a plain HTTP host has no TLS stage
+
+    httplib::Headers headers = {
+        { "Accept", "application/json" }
+    };
+    // Set the request headers
+
+    httplib::ResponseHandler onHeaders = [&](const httplib::Response& response) {
+        if (response.status == 429 || response.status >= 500) {
+            return true;
+        }
+        // A response that will be retried is not reported
+        attempt.stages.headersReceived = Clock::now();
+        attempt.interaction.headersAtMs = elapsedMs(attempt.stages.started, attempt.stages.headersReceived);
+        attempt.interaction.contentType = response.get_header_value("Content-Type");
+        const RequestAttempt* noReporter = nullptr;
+        if (race.reporter.compare_exchange_strong(noReporter, &attempt)) {
+            search.notify(SearchEventHeadersReceived);
+        }
+        return !attempt.abandoned && !search.isCancelRequested();
+    };
+    httplib::ContentReceiver onData = [&](const char* data, size_t length) {
+        attempt.body.append(data, length);
+        HttpChunk chunk;
+        chunk.end = attempt.body.size();
+        chunk.atMs = elapsedMs(attempt.stages.started, Clock::now());
+        attempt.interaction.chunks.push_back(chunk);
+        if (race.reporter.load() == &attempt) {
+            search.bytesReceived.store(attempt.body.size(), std::memory_order_relaxed);
+            search.notify(SearchEventDataReceived);
+        }
+        // Only one request of a hedged pair reports progress, so the handle sees a single download
+        return !attempt.abandoned && !search.isCancelRequested();
+        // Returning false aborts the download
+    };
+
+    attempt.stages.started = Clock::now();
+    attempt.res = cli.Get(path.c_str(), headers, onHeaders, onData);
+
+    attempt.outcome = attempt.abandoned || search.isCancelRequested() ? RequestOutcomeCancelled
+        : !attempt.res ? RequestOutcomeNetworkError
+        : attempt.res->status == 429 ? RequestOutcomeThrottled
+        : attempt.res->status >= 500 ? RequestOutcomeServerError
+        : RequestOutcomeSuccess;
+    attempt.retryAfter = attempt.res && attempt.res->has_header("Retry-After") ? std::atof(attempt.res->get_header_value("Retry-After").c_str()) : 0.0;
+    // Retry-After in seconds; the HTTP-date form is not used by the API
+    rateLimiter.release(attempt.outcome, elapsedMs(attempt.stages.started, Clock::now()), attempt.retryAfter);
+
+    {
+        std::lock_guard<std::mutex> lock(race.mutex);
+        attempt.done = true;
+    }
+    race.finished.notify_all();
+}
+
+std::string JobSearch::buildSearchPath(const SearchRequest& request) const {
+    // Function to build the request path and query string of a search
+    std::string encodedQuery = httplib::detail::encode_url(request.query);
+    // URL-encode the search query
+
+    std::stringstream ss;
+    ss << "/v1/api/jobs/" << request.country << "/search/" << request.page << "?app_id=" << app_id
+        << "&app_key=" << api_key
+        << "&results_per_page=" << request.resultsPerPage
+        << "&what=" << encodedQuery;
+    // Construct the API request URL
+
+    if (request.sortByDate) {
+        ss << "&sort_by=date";
+    }
+    // Newest first, so a refresh can stop at the first posting it has seen
+
+    if (request.maxDaysOld > 0) {
+        ss << "&max_days_old=" << request.maxDaysOld;
+    }
+    // Leaves out the postings older than the last sync
+
+    if (request.salaryRange != "Any") {
+        size_t dashPos = request.salaryRange.find('-');
+        if (dashPos != std::string::npos) {
+            ss << "&salary_min=" << request.salaryRange.substr(0, dashPos)
+                << "&salary_max=" << request.salaryRange.substr(dashPos + 1);
+        }
+        else if (!request.salaryRange.empty() && request.salaryRange.back() == '+') {
+            ss << "&salary_min=" << request.salaryRange.substr(0, request.salaryRange.size() - 1);
+        }
+        // "100000+", or a converted bound such as "79000+" from a multi-country search
+    }
+    // Add salary range parameters to the URL if specified
+
+    return ss.str();
+}
+
+std::vector<Job> JobSearch::parseResults(const std::string& body, const std::string& currencySymbol) {
+    // Function to turn an Adzuna search response into jobs
+    std::vector<Job> jobs;
+    auto json = nlohmann::json::parse(body);
+    // Parse the JSON response
+
+    for (const auto& result : json["results"]) {
+        // Iterate through each job in the results
+        Job job;
+        const auto id = result.find("id");
+        if (id != result.end()) {
+            job.id = id->is_string() ? id->get<std::string>() : id->dump();
+        }
+        // Adzuna sends the id as a string; a number is accepted too
+        job.title = result.value("title", "Not specified");
+        job.company = result.value("company", nlohmann::json::object()).value("display_name", "Not specified");
+        job.location = result.value("location", nlohmann::json::object()).value("display_name", "Not specified");
+        job.description = result.value("description", "No description available");
+        job.salary = result.value("salary_min", 0.0);
+        job.salaryCurrency = currencySymbol;
+        job.category = result.value("category", nlohmann::json::object()).value("label", "Not specified");
+        job.contractType = result.value("contract_type", "Not specified");
+        job.url = result.value("redirect_url", "Not specified");
+        job.created = result.value("created", "");
+        // Populate a Job object with data from the JSON
+
+        jobs.push_back(job);
+        // Add the job to the results vector
+    }
+    return jobs;
 }
 
 //Function for loading the app_id and app_key from the config.ini file to the variables.
+//An optional base_url= line points the searches at another host, such as the local AdzunaSimulator,
+//optional cassette= and cassette_mode=record|replay lines record the responses or replay them, and optional
+//requests_per_minute=, rate_burst=, max_concurrency= and max_retries= lines tune the rate limiter, an optional
+//hedge_ratio= line turns on hedged requests, and an optional delta_sync=0|1 line turns delta syncs off or on.
 
 void JobSearch::updateApiCredentials(std::string& app_id, std::string& app_key, const std::string& configPath) {
     std::ifstream configFile(configPath);
@@ -212,6 +874,10 @@ void JobSearch::updateApiCredentials(std::string& app_id, std::string& app_key,
 
     std::string line;
     bool foundId = false, foundKey = false;
+    double requestsPerMinute = 25.0;
+    int rateBurst = 5;
+    int maxConcurrency = 8;
+    // Adzuna's free quota unless config.ini says otherwise
 
     while (std::getline(configFile, line)) {
         if (line.find("app_id=") != std::string::npos) {
@@ -222,11 +888,42 @@ void JobSearch::updateApiCredentials(std::string& app_id, std::string& app_key,
             app_key = line.substr(line.find("=") + 1);
             foundKey = true;
         }
-
-        if (foundId && foundKey) break;
+        else if (line.find("requests_per_minute=") == 0) {
+            requestsPerMinute = std::atof(line.substr(line.find("=") + 1).c_str());
+        }
+        else if (line.find("rate_burst=") == 0) {
+            rateBurst = std::atoi(line.substr(line.find("=") + 1).c_str());
+        }
+        else if (line.find("max_concurrency=") == 0) {
+            maxConcurrency = std::atoi(line.substr(line.find("=") + 1).c_str());
+        }
+        else if (line.find("max_retries=") == 0) {
+            setMaxRetries(std::atoi(line.substr(line.find("=") + 1).c_str()));
+        }
+        else if (line.find("hedge_ratio=") == 0) {
+            setHedging(std::atof(line.substr(line.find("=") + 1).c_str()));
+        }
+        else if (line.find("delta_sync=") == 0) {
+            setDeltaSync(std::atoi(line.substr(line.find("=") + 1).c_str()) != 0);
+        }
+        else if (line.find("cassette=") == 0) {
+            cassettePath = line.substr(line.find("=") + 1);
+        }
+        else if (line.find("cassette_mode=") == 0) {
+            cassetteMode = line.substr(line.find("=") + 1);
+        }
+        else if (line.find("base_url=") == 0) {
+            baseUrl = line.substr(line.find("=") + 1);
+            while (!baseUrl.empty() && (baseUrl.back() == '/' || baseUrl.back() == '\r' || baseUrl.back() == ' ')) {
+                baseUrl.pop_back();
+            }
+            // The request paths start with '/'
+        }
     }
 
     if (!foundId || !foundKey) {
         throw std::runtime_error("API credentials not found in config file");
     }
+
+    setRateLimit(requestsPerMinute, rateBurst, maxConcurrency);
 }
@@ -3,16 +3,35 @@
 
 #include <vector>
 #include <string>
-#include <thread>
-// Includes the thread class for multi-threading support
 #include <mutex>
 // Includes the mutex class for thread synchronization
 #include <condition_variable>
 // Includes the condition_variable class for thread synchronization
+#include <memory>
+// Includes shared_ptr for sharing result snapshots without copying them
 #include <atomic>
 // Includes the atomic class for thread-safe operations
+#include <unordered_map>
+// Includes the map of the recent searches kept for delta syncs
 #include "Job.h"
 // Includes the Job header file - contains the Job struct definition
+#include "SearchHandle.h"
+// Includes the SearchHandle header file - the result, status and timings of one search
+#include "TaskScheduler.h"
+// Includes the TaskScheduler header file - the thread pool the searches run on
+#include "HttpCassette.h"
+// Includes the HttpCassette header file - records responses to a file or replays them without network access
+#include "RateLimiter.h"
+// Includes the RateLimiter header file - keeps the outbound requests within the API quota
+#include "JobIndex.h"
+// Includes the JobIndex header file - full-text index of the jobs fetched so far
+#include "JobStore.h"
+// Includes the JobStore header file - on-disk store of every job fetched, across sessions
+#ifndef CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+// Enables OpenSSL support in httplib. It changes the layout of httplib's classes, so every file that includes
+// httplib.h through this header must see it, not only JobSearch.cpp
 #include "httplib.h"
 // Includes the httplib header file for HTTP client functionality
 #include "json.hpp"
@@ -20,76 +39,159 @@
 
 class JobSearch {
 public:
-    JobSearch();
-    // Constructor for the JobSearch class
+    explicit JobSearch(const std::string& configPath = "config.ini", TaskScheduler& scheduler = TaskScheduler::shared());
+    // Constructor for the JobSearch class, with the file holding the API credentials and the scheduler the searches run on
 
     ~JobSearch();
-    // Destructor for the JobSearch class
+    // Destructor for the JobSearch class, waits for searches still running
 
-    void searchJobs(const std::string& query, const std::string& country,
-        const std::string& salaryRange, int resultsPerPage, const std::string& currencySymbol);
-    // Function to initiate a job search with given parameters
+    std::shared_ptr<SearchHandle> searchJobs(const SearchRequest& request, SearchCallback callback = SearchCallback());
+    // Function to start a job search on the task scheduler
+    // Returns a handle that carries this search's own results, error and timings; any number of searches can be in flight
 
-    std::vector<Job> getResults() const;
-    // Function to retrieve the search results
+    void setLogging(bool enabled);
+    // Function to turn the per-search log lines (URL, job count, failures) on or off
 
-    void startSearchThread();
-    // Function to start the search thread
+    std::string buildSearchPath(const SearchRequest& request) const;
+    // Function to build the API request path (with the query string) of a search
 
-    void stopSearchThread();
-    // Function to stop the search thread
+    static std::vector<Job> parseResults(const std::string& body, const std::string& currencySymbol);
+    // Function to turn an Adzuna search response body into jobs; throws on malformed JSON
 
-    bool getSearchRequested();
+    void setRateLimit(double requestsPerMinute, int burst, int maxConcurrency);
+    // Function to set the request quota (0 for none) and the ceiling of the adaptive concurrency limit
+    // Defaults to Adzuna's free quota, 25 requests per minute; config.ini can override it (see updateApiCredentials)
+
+    void setMaxRetries(int retries);
+    // Function to set how many times a throttled, failed or unanswered request is retried (default 3)
+
+    void setHedging(double maxHedgeRatio);
+    // Function to hedge slow requests: a request still unanswered after the p95 latency is sent again on another
+    // connection, the first answer is used and the other request is abandoned. At most maxHedgeRatio hedges per
+    // request keeps the quota safe (0, the default, turns hedging off; config.ini can set hedge_ratio=)
+
+    RateLimiterStats getRateLimiterStats() const;
+    // Function to get the rate limiter's counters and current concurrency limit
+
+    void setCassette(std::shared_ptr<HttpCassette> cassette);
+    // Function to record the responses to a cassette or answer the searches from one (nullptr for the network)
+    // Set it before starting searches; config.ini can also select one with cassette= and cassette_mode= lines
+
+    void setIndex(std::shared_ptr<JobIndex> index);
+    // Function to add every job fetched from now on to a full-text index (nullptr for none)
+    // Set it before starting searches
+
+    void setStore(std::shared_ptr<JobStore> store);
+    // Function to append every job fetched from now on to a persistent store (nullptr for none)
+    // Set it before starting searches
+
+    void setDeltaSync(bool enabled);
+    // Function to answer a repeated search (same query, ignoring case and spacing, country, salary range and page
+    // size; first page) with only the postings published since it last ran: small date-sorted requests read back to
+    // an hour before the last fetch, to catch postings that reached the API late, skipping the ones already read,
+    // and the new ones are put in front of the earlier results. Searches are fetched in full again after 6 hours or
+    // when more than 50 postings are new.
+    // Off by default; config.ini can set delta_sync=1. Set it before starting searches
 
     void updateApiCredentials(std::string& app_id, std::string& app_key, const std::string& configPath);
 //Function for loading the app_id and app_key from the config.ini file to the variables.
 
 
 private:
-    std::vector<Job> results;
-    // Vector to store the search results
+    TaskScheduler& scheduler;
+    // Scheduler the search tasks run on
 
-    std::thread searchThread;
-    // Thread object for performing searches asynchronously
+    std::atomic<bool> logging;
+    // Whether searches are logged to the console
 
-    mutable std::mutex searchMutex;
+    std::mutex searchMutex;
     // Mutex for thread-safe access to the shared varibales
 
-    std::atomic<bool> stopThread;
-    // Atomic flag to signal the search thread to stop
-
     std::condition_variable cv;
-    // Condition variable for thread synchronization
+    // Condition variable signalled when a search task finishes
 
-    bool searchRequested;
-    // Flag to indicate if a search has been requested
+    int searchesInFlight;
+    // Number of search tasks queued or running on the scheduler
 
-    std::string currentQuery;
-    // Current search query
+    std::string app_id;
 
-    std::string currentCountry;
-    // Current country for the search
+    std::string api_key;
 
-    std::string currentSalaryRange;
-    // Current salary range for the search
+    std::string baseUrl;
+    // Scheme, host and optional port the requests go to; https://api.adzuna.com unless config.ini sets base_url
 
-    std::string currentContractType;
-    // Current contract type for the search
+    RateLimiter rateLimiter;
+    // Quota and adaptive concurrency limit shared by every request this object sends
 
-    int currentResultsPerPage;
-    // Current number of results per page
+    int maxRetries;
+    // Retries after a throttled, failed or unanswered request
 
-    std::string currentCurrencySymbol;
-    // Current currency symbol for the search
+    double hedgeRatio;
+    // Budget of hedged requests per request sent; 0 for no hedging
 
-    std::string app_id;
+    std::shared_ptr<HttpCassette> cassette;
+    // Cassette the responses are recorded to or replayed from, if any
 
-    std::string api_key;
+    std::shared_ptr<JobIndex> index;
+    // Index the fetched jobs are added to, if any
 
-    void searchThreadFunction();
-    // Function that runs in the search thread
+    std::shared_ptr<JobStore> store;
+    // Store the fetched jobs are appended to, if any
 
-    void performSearch();
-    // Function to perform the actual search operation
-};
+    std::string cassettePath;
+    std::string cassetteMode;
+    // Cassette settings read from config.ini
+
+    bool deltaSync;
+    // Whether repeated searches fetch only the new postings
+
+    struct DeltaEntry;
+    // Results of a search and the time from which postings are new to them (defined in JobSearch.cpp)
 
+    std::mutex deltaMutex;
+    // Mutex for the delta cache
+
+    std::unordered_map<std::string, std::shared_ptr<DeltaEntry>> deltaCache;
+    // Last results of the recent searches, by normalized search
+
+    uint64_t deltaUses;
+    // Counter stamped on a delta entry each time it is used
+
+    struct RequestAttempt;
+    // One GET request to the API (defined in JobSearch.cpp)
+
+    struct RequestRace;
+    // The two requests of a hedged pair (defined in JobSearch.cpp)
+
+    void admitSearch(const std::shared_ptr<SearchHandle>& search);
+    // Function to run a search once the rate limiter lets its first request out; until then it is queued again
+    // after the wait the limiter reports, so a search waiting for its turn does not hold a worker
+
+    void performSearch(const std::shared_ptr<SearchHandle>& search, bool admitted);
+    // Function to perform the actual search operation (runs on the task scheduler); admitted is true if the
+    // rate limiter already let its first request out
+
+    static std::string getDeltaKey(const SearchRequest& request);
+    // Function to normalize a search into the key of its delta entry
+
+    std::shared_ptr<const DeltaEntry> findDelta(const std::string& key);
+    // Function to get the last results of a search, nullptr if there are none or they are too old to update
+
+    void recordDelta(const std::string& key, const std::vector<Job>& results, int64_t fetchTime);
+    // Function to keep the results of a full fetch, sent at fetchTime (seconds since 1970), for later delta syncs
+
+    std::vector<Job> mergeDelta(const std::string& key, const DeltaEntry& known, const std::vector<Job>& delta, size_t limit,
+        int64_t fetchTime);
+    // Function to merge the new postings of a delta sync sent at fetchTime into the last results, keeping the first
+    // limit of them, and keep them for the next one
+
+    std::shared_ptr<RequestAttempt> sendRequest(const std::string& path, const std::shared_ptr<SearchHandle>& search, bool admitted);
+    // Function to send one request through the rate limiter (unless admitted already), hedged if it is slow; the
+    // request that answered first, or nullptr if the search was cancelled while waiting for the rate limiter
+
+    void startRequest(const std::shared_ptr<RequestAttempt>& attempt, const std::string& path, const std::shared_ptr<SearchHandle>& search);
+    // Function to run a request on a thread of its own (the requests of a hedged pair run side by side)
+
+    void runRequest(RequestAttempt& attempt, const std::string& path, SearchHandle& search);
+    // Function to send a GET request and report its outcome to the rate limiter
+};
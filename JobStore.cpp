@@ -0,0 +1,954 @@
+#include "JobStore.h"
+// Includes the header file for the JobStore class
+
+#include "TaskScheduler.h"
+// Includes the shared task scheduler the compactions run on
+
+#include "Trace.h"
+// Includes the tracer, which records sealing and compaction in the timeline
+
+#include <algorithm>
+// Includes std::sort and std::lower_bound
+
+#include <unordered_set>
+// Includes the set of keys already seen when reading newest first
+
+#include <stdexcept>
+// Includes std::runtime_error
+
+#include <iostream>
+// Includes std::cerr for reporting a failed compaction
+
+#include <atomic>
+// Includes the atomic flag marking a replaced segment
+
+#include <cstring>
+// Includes std::memcpy for reading the packed records
+
+#include <cstdio>
+// Includes std::rename, std::remove and std::snprintf
+
+#include <ctime>
+// Includes std::time for the time a job was stored
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// Includes the Windows API for memory-mapped files and directory listing
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <cerrno>
+// Includes the POSIX equivalents
+#endif
+
+namespace {
+    const uint32_t segmentMagic = 0x4745534A;
+    // "JSEG", at the start of every segment file
+    const uint32_t indexMagic = 0x5844494A;
+    // "JIDX", at the start of every index file
+    const uint32_t formatVersion = 1;
+    // Version of the file layout; files of another version are ignored
+
+    const uint64_t segmentLimit = 4 << 20;
+    // Size at which the active segment is sealed: large enough for hundreds of searches, small enough to keep in memory
+    const size_t compactionThreshold = 8;
+    // Sealed segments allowed before they are merged
+
+    const int stringFields = 10;
+    // Strings of a record: id, url, title, company, location, description, currency, contract type, category,
+    // created time (missing from the records written before it was stored)
+
+    struct SegmentHeader {
+        uint32_t magic;
+        uint32_t version;
+    };
+    // Start of a segment file, followed by the records
+
+    struct RecordHeader {
+        uint32_t length;
+        // Size of the payload
+        uint32_t checksum;
+        // Hash of the payload, to detect a record torn by a crash
+    };
+    // Start of a record; the payload is the time it was stored, the salary and the string fields, each a length
+    // and its bytes
+
+    struct IndexHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t firstSequence;
+        uint64_t lastSequence;
+        // Sequence numbers of the segments merged into this one (equal for a segment that was never compacted)
+        uint64_t entryCount;
+        // Number of entries following the header
+        uint64_t segmentBytes;
+        // Size of the segment file when it was sealed
+    };
+    // Start of an index file
+
+    struct IndexEntry {
+        uint64_t keyHash;
+        // Hash of the job's key; the entries are sorted by it
+        uint64_t contentHash;
+        // Hash of the job's fields
+        uint64_t offset;
+        // Position of the record in the segment
+        uint32_t length;
+        // Size of the record, header included
+        uint32_t reserved;
+    };
+    // Latest record of one key in a segment
+
+    uint64_t hashBytes(const char* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+        // Function to hash bytes with 64-bit FNV-1a
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    const std::string& getKey(const Job& job) {
+        // Function to get the key a job is stored under: its Adzuna id, or its URL if it has none
+        return job.id.empty() ? job.url : job.id;
+    }
+
+    void appendString(std::string& out, const std::string& value) {
+        uint32_t length = (uint32_t)value.size();
+        out.append((const char*)&length, sizeof(length));
+        out += value;
+    }
+
+    uint64_t hashContent(const Job& job) {
+        // Function to hash the fields of a job as they are laid out in its record, without encoding it
+        uint64_t hash = hashBytes((const char*)&job.salary, sizeof(job.salary));
+        const std::string* fields[stringFields] = { &job.id, &job.url, &job.title, &job.company, &job.location,
+            &job.description, &job.salaryCurrency, &job.contractType, &job.category, &job.created };
+        for (const std::string* field : fields) {
+            uint32_t length = (uint32_t)field->size();
+            hash = hashBytes((const char*)&length, sizeof(length), hash);
+            hash = hashBytes(field->data(), field->size(), hash);
+        }
+        return hash;
+        // The content hash leaves out the time, so fetching an unchanged job again is recognized
+    }
+
+    uint32_t foldChecksum(uint64_t contentHash, uint64_t storedAt) {
+        // Function to derive a record's checksum from its content hash and time, so the fields are hashed once
+        uint64_t checksum = hashBytes((const char*)&storedAt, sizeof(storedAt), contentHash);
+        return (uint32_t)(checksum ^ (checksum >> 32));
+    }
+
+    void encodeRecord(const Job& job, uint64_t storedAt, uint64_t contentHash, std::string& out) {
+        // Function to append a job as a record
+        const size_t start = out.size();
+        RecordHeader header = { 0, foldChecksum(contentHash, storedAt) };
+        out.append((const char*)&header, sizeof(header));
+        out.append((const char*)&storedAt, sizeof(storedAt));
+        out.append((const char*)&job.salary, sizeof(job.salary));
+        const std::string* fields[stringFields] = { &job.id, &job.url, &job.title, &job.company, &job.location,
+            &job.description, &job.salaryCurrency, &job.contractType, &job.category, &job.created };
+        for (const std::string* field : fields) {
+            appendString(out, *field);
+        }
+        header.length = (uint32_t)(out.size() - start - sizeof(RecordHeader));
+        std::memcpy(&out[start], &header, sizeof(header));
+    }
+
+    class RecordReader {
+    public:
+        RecordReader(const char* data, size_t size) : position(data), end(data + size) {}
+
+        bool read(void* value, size_t size) {
+            if ((size_t)(end - position) < size) return false;
+            std::memcpy(value, position, size);
+            position += size;
+            return true;
+        }
+
+        bool readString(std::string& value) {
+            uint32_t length;
+            if (!read(&length, sizeof(length)) || (size_t)(end - position) < length) return false;
+            value.assign(position, length);
+            position += length;
+            return true;
+        }
+
+        bool atEnd() const {
+            return position == end;
+        }
+
+    private:
+        const char* position;
+        const char* end;
+    };
+    // Bounds-checked reads from a record, so a damaged file cannot read past its mapping
+
+    bool checkRecord(const char* data, size_t available, uint32_t& length) {
+        // Function to check that a whole record with a valid checksum starts at data; sets its size
+        RecordHeader header;
+        if (available < sizeof(header)) return false;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.length > available - sizeof(header) || header.length < sizeof(uint64_t)) return false;
+        uint64_t storedAt;
+        std::memcpy(&storedAt, data + sizeof(header), sizeof(storedAt));
+        const uint64_t contentHash = hashBytes(data + sizeof(header) + sizeof(storedAt), header.length - sizeof(storedAt));
+        length = (uint32_t)sizeof(header) + header.length;
+        return header.checksum == foldChecksum(contentHash, storedAt);
+    }
+
+    bool decodeKey(const char* record, size_t length, std::string& key) {
+        // Function to read the key of a record without decoding the rest
+        RecordReader reader(record + sizeof(RecordHeader), length - std::min<size_t>(length, sizeof(RecordHeader)));
+        uint64_t storedAt;
+        double salary;
+        std::string url;
+        if (!reader.read(&storedAt, sizeof(storedAt)) || !reader.read(&salary, sizeof(salary))) return false;
+        if (!reader.readString(key) || !reader.readString(url)) return false;
+        if (key.empty()) key.swap(url);
+        return true;
+    }
+
+    bool decodeRecord(const char* record, size_t length, Job& job) {
+        // Function to turn a record back into a job
+        RecordReader reader(record + sizeof(RecordHeader), length - std::min<size_t>(length, sizeof(RecordHeader)));
+        uint64_t storedAt;
+        if (!reader.read(&storedAt, sizeof(storedAt)) || !reader.read(&job.salary, sizeof(job.salary))) return false;
+        std::string* fields[stringFields] = { &job.id, &job.url, &job.title, &job.company, &job.location,
+            &job.description, &job.salaryCurrency, &job.contractType, &job.category, &job.created };
+        for (std::string* field : fields) {
+            if (field == &job.created && reader.atEnd()) {
+                job.created.clear();
+                break;
+            }
+            // An older record ends after the category; its job has no created time
+            if (!reader.readString(*field)) return false;
+        }
+        return true;
+    }
+
+    std::vector<uint64_t> listRecords(const char* data, size_t size) {
+        // Function to find the records of a segment in the order they were appended, from their lengths
+        std::vector<uint64_t> offsets;
+        uint64_t offset = sizeof(SegmentHeader);
+        RecordHeader header;
+        while (offset + sizeof(header) <= size) {
+            std::memcpy(&header, data + offset, sizeof(header));
+            if (header.length > size - offset - sizeof(header)) break;
+            offsets.push_back(offset);
+            offset += sizeof(header) + header.length;
+        }
+        return offsets;
+    }
+
+    bool writeIndex(const std::string& path, uint64_t firstSequence, uint64_t lastSequence, uint64_t segmentBytes,
+        std::vector<IndexEntry>& entries) {
+        // Function to write an index file: to a temporary name first, so an index on disk is always complete
+        std::sort(entries.begin(), entries.end(), [](const IndexEntry& a, const IndexEntry& b) { return a.keyHash < b.keyHash; });
+        IndexHeader header = { indexMagic, formatVersion, firstSequence, lastSequence, entries.size(), segmentBytes };
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write((const char*)&header, sizeof(header));
+            file.write((const char*)entries.data(), entries.size() * sizeof(IndexEntry));
+            if (!file) return false;
+        }
+        std::remove(path.c_str());
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+        // The index is what makes a segment sealed, so it is renamed into place last
+    }
+
+    class MappedFile {
+    public:
+        MappedFile() : data(nullptr), size(0) {
+#if defined(_WIN32)
+            file = INVALID_HANDLE_VALUE;
+            mapping = nullptr;
+#endif
+        }
+
+        ~MappedFile() {
+            close();
+        }
+
+        bool open(const std::string& path) {
+            // Function to map a whole file read-only
+            close();
+#if defined(_WIN32)
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize)) return false;
+            size = (uint64_t)fileSize.QuadPart;
+            if (size == 0) return true;
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) return false;
+            data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            return data != nullptr;
+#else
+            int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0) return false;
+            struct stat status;
+            bool mapped = fstat(descriptor, &status) == 0;
+            if (mapped && status.st_size > 0) {
+                void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+                mapped = view != MAP_FAILED;
+                if (mapped) {
+                    data = (const char*)view;
+                    size = (uint64_t)status.st_size;
+                }
+            }
+            ::close(descriptor);
+            // The mapping stays valid without the descriptor
+            return mapped;
+#endif
+        }
+
+        void close() {
+#if defined(_WIN32)
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+            mapping = nullptr;
+#else
+            if (data) munmap((void*)data, (size_t)size);
+#endif
+            data = nullptr;
+            size = 0;
+        }
+
+        const char* getData() const { return data; }
+        uint64_t getSize() const { return size; }
+
+    private:
+        MappedFile(const MappedFile&);
+        MappedFile& operator=(const MappedFile&);
+        // A mapping has one owner
+
+        const char* data;
+        uint64_t size;
+#if defined(_WIN32)
+        HANDLE file;
+        HANDLE mapping;
+#endif
+    };
+    // Read-only view of a whole file; the operating system pages it in on first access
+
+    bool makeDirectory(const std::string& path) {
+        // Function to create a directory; true if it exists afterwards
+#if defined(_WIN32)
+        return CreateDirectoryA(path.c_str(), nullptr) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+        struct stat status;
+        return mkdir(path.c_str(), 0755) == 0 || (stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode));
+#endif
+    }
+
+    bool removeDirectory(const std::string& path) {
+        // Function to delete an empty directory; true if it is gone
+#if defined(_WIN32)
+        return RemoveDirectoryA(path.c_str()) || GetLastError() == ERROR_FILE_NOT_FOUND;
+#else
+        return rmdir(path.c_str()) == 0 || errno == ENOENT;
+#endif
+    }
+
+    std::vector<std::string> listFiles(const std::string& path) {
+        // Function to list the file names of a directory
+        std::vector<std::string> names;
+#if defined(_WIN32)
+        WIN32_FIND_DATAA found;
+        HANDLE search = FindFirstFileA((path + "\\*").c_str(), &found);
+        if (search == INVALID_HANDLE_VALUE) return names;
+        do {
+            if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) names.push_back(found.cFileName);
+        } while (FindNextFileA(search, &found));
+        FindClose(search);
+#else
+        DIR* directory = opendir(path.c_str());
+        if (!directory) return names;
+        while (dirent* entry = readdir(directory)) {
+            if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+        }
+        closedir(directory);
+#endif
+        return names;
+    }
+
+    bool parseFileName(const std::string& name, uint64_t& sequence, uint32_t& generation, std::string& extension) {
+        // Function to read "<sequence>-<generation>.<extension>" file names
+        size_t dash = name.find('-');
+        size_t dot = name.find('.');
+        if (dash == std::string::npos || dot == std::string::npos || dash == 0 || dot < dash + 2) return false;
+        for (size_t i = 0; i < dot; i++) {
+            if (i != dash && (name[i] < '0' || name[i] > '9')) return false;
+        }
+        sequence = std::strtoull(name.substr(0, dash).c_str(), nullptr, 10);
+        generation = (uint32_t)std::strtoul(name.substr(dash + 1, dot - dash - 1).c_str(), nullptr, 10);
+        extension = name.substr(dot);
+        return true;
+    }
+}
+
+struct JobStore::Segment {
+    MappedFile records;
+    // The segment file
+    MappedFile index;
+    // The index file
+    std::string recordsPath;
+    std::string indexPath;
+    uint32_t generation;
+    // Number of compactions the segment's data went through; a later generation replaces the files it merged
+    std::atomic<bool> obsolete;
+    // Set when a compaction replaced the segment; the last reader to let go deletes its files
+
+    Segment() : generation(0), obsolete(false) {}
+
+    ~Segment() {
+        records.close();
+        index.close();
+        if (obsolete) {
+            std::remove(recordsPath.c_str());
+            std::remove(indexPath.c_str());
+        }
+        // Unmapped first: Windows does not delete a file while it is mapped
+    }
+
+    bool map() {
+        // Function to map both files and check that they belong together; the entries are checked on use
+        if (!index.open(indexPath) || !records.open(recordsPath)) return false;
+        if (index.getSize() < sizeof(IndexHeader) || records.getSize() < sizeof(SegmentHeader)) return false;
+        const IndexHeader& header = getHeader();
+        SegmentHeader segmentHeader;
+        std::memcpy(&segmentHeader, records.getData(), sizeof(segmentHeader));
+        return header.magic == indexMagic && header.version == formatVersion && segmentHeader.magic == segmentMagic &&
+            segmentHeader.version == formatVersion && header.segmentBytes <= records.getSize() &&
+            index.getSize() == sizeof(IndexHeader) + header.entryCount * sizeof(IndexEntry);
+    }
+
+    const IndexHeader& getHeader() const {
+        return *(const IndexHeader*)index.getData();
+    }
+
+    const IndexEntry* begin() const {
+        return (const IndexEntry*)(index.getData() + sizeof(IndexHeader));
+    }
+
+    const IndexEntry* end() const {
+        return begin() + getHeader().entryCount;
+    }
+
+    uint64_t getBytes() const {
+        return records.getSize() + index.getSize();
+    }
+
+    const IndexEntry* find(uint64_t keyHash) const {
+        // Function to binary-search the index for a key hash
+        const IndexEntry* found = std::lower_bound(begin(), end(), keyHash,
+            [](const IndexEntry& entry, uint64_t wanted) { return entry.keyHash < wanted; });
+        return found != end() && found->keyHash == keyHash ? found : nullptr;
+    }
+
+    bool getRecord(uint64_t offset, uint64_t length, const char*& record) const {
+        // Function to locate a record, checking it lies within the sealed part of the file
+        if (offset > getHeader().segmentBytes || length > getHeader().segmentBytes - offset) return false;
+        record = records.getData() + offset;
+        return true;
+    }
+};
+
+JobStore::JobStore(const std::string& directory, uint64_t maxBytes)
+    : directory(directory), maxBytes(maxBytes), nextSequence(1), activeRecords(0), compacting(false) {
+    // Constructor for the JobStore class
+    if (!makeDirectory(directory)) {
+        throw std::runtime_error("Unable to create job store directory: " + directory);
+    }
+    open();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    scheduleCompaction();
+    // A previous session may have ended over the budget or with many segments
+}
+
+JobStore::~JobStore() {
+    // Destructor for the JobStore class
+    std::unique_lock<std::mutex> lock(mutex);
+    compacted.wait(lock, [this] { return !compacting; });
+    seal();
+    // A sealed segment is mapped on the next start instead of being recovered
+}
+
+std::string JobStore::getPath(uint64_t sequence, uint32_t generation, const char* extension) const {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%08llu-%04u%s", (unsigned long long)sequence, generation, extension);
+    return directory + "/" + name;
+}
+
+void JobStore::open() {
+    // Function to find the segments of the directory and map the current ones
+    TRACE_SCOPE("JobStore::open", "store");
+    std::vector<std::shared_ptr<Segment>> complete;
+    std::vector<std::pair<uint64_t, uint32_t>> unsealed;
+    for (const std::string& name : listFiles(directory)) {
+        uint64_t sequence;
+        uint32_t generation;
+        std::string extension;
+        if (!parseFileName(name, sequence, generation, extension)) continue;
+        nextSequence = std::max(nextSequence, sequence + 1);
+
+        if (extension == ".idx.tmp") {
+            std::remove((directory + "/" + name).c_str());
+        }
+        // An index interrupted while being written
+        else if (extension == ".seg") {
+            std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+            segment->recordsPath = getPath(sequence, generation, ".seg");
+            segment->indexPath = getPath(sequence, generation, ".idx");
+            segment->generation = generation;
+            if (segment->map()) complete.push_back(segment);
+            else unsealed.push_back(std::make_pair(sequence, generation));
+        }
+    }
+
+    std::sort(complete.begin(), complete.end(), [](const std::shared_ptr<Segment>& a, const std::shared_ptr<Segment>& b) {
+        return a->generation > b->generation;
+    });
+    for (const std::shared_ptr<Segment>& segment : complete) {
+        bool replaced = false;
+        for (const std::shared_ptr<Segment>& kept : segments) {
+            replaced = replaced || (segment->getHeader().firstSequence <= kept->getHeader().lastSequence &&
+                kept->getHeader().firstSequence <= segment->getHeader().lastSequence);
+        }
+        if (replaced) segment->obsolete = true;
+        else segments.push_back(segment);
+    }
+    // A compaction that was interrupted after sealing its output leaves the segments it merged behind; the
+    // output, of a later generation, replaces them
+
+    std::sort(segments.begin(), segments.end(), [](const std::shared_ptr<Segment>& a, const std::shared_ptr<Segment>& b) {
+        return a->getHeader().firstSequence < b->getHeader().firstSequence;
+    });
+
+    for (const std::pair<uint64_t, uint32_t>& file : unsealed) {
+        bool covered = false;
+        for (const std::shared_ptr<Segment>& kept : segments) {
+            covered = covered || (kept->getHeader().firstSequence <= file.first && file.first <= kept->getHeader().lastSequence);
+        }
+        if (covered) {
+            std::remove(getPath(file.first, file.second, ".seg").c_str());
+            std::remove(getPath(file.first, file.second, ".idx").c_str());
+        }
+        // The unfinished output of an interrupted compaction
+        else {
+            recover(file.first, file.second);
+        }
+        // The active segment of a session that crashed
+    }
+}
+
+void JobStore::recover(uint64_t sequence, uint32_t generation) {
+    // Function to index the intact records of an unsealed segment
+    const std::string path = getPath(sequence, generation, ".seg");
+    std::string bytes;
+    {
+        std::ifstream file(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    SegmentHeader header;
+    if (bytes.size() >= sizeof(header)) std::memcpy(&header, bytes.data(), sizeof(header));
+    if (bytes.size() < sizeof(header) || header.magic != segmentMagic || header.version != formatVersion) {
+        std::remove(path.c_str());
+        return;
+    }
+
+    std::unordered_map<uint64_t, IndexEntry> latest;
+    uint64_t offset = sizeof(header);
+    uint32_t length;
+    std::string key;
+    while (checkRecord(bytes.data() + offset, bytes.size() - offset, length) && decodeKey(bytes.data() + offset, length, key)) {
+        const char* payload = bytes.data() + offset + sizeof(RecordHeader);
+        IndexEntry entry = { hashBytes(key.data(), key.size()), hashBytes(payload + sizeof(uint64_t), length - sizeof(RecordHeader) - sizeof(uint64_t)), offset, length, 0 };
+        latest[entry.keyHash] = entry;
+        offset += length;
+    }
+    // Stop at the first torn or damaged record: everything after it was being written when the session ended
+
+    if (latest.empty()) {
+        std::remove(path.c_str());
+        return;
+    }
+    if (offset < bytes.size()) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), (std::streamsize)offset);
+    }
+
+    std::vector<IndexEntry> entries;
+    for (const std::pair<const uint64_t, IndexEntry>& entry : latest) {
+        entries.push_back(entry.second);
+    }
+    std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+    segment->recordsPath = path;
+    segment->indexPath = getPath(sequence, generation, ".idx");
+    segment->generation = generation;
+    if (writeIndex(segment->indexPath, sequence, sequence, offset, entries) && segment->map()) {
+        std::vector<std::shared_ptr<Segment>>::iterator position = std::upper_bound(segments.begin(), segments.end(), sequence,
+            [](uint64_t wanted, const std::shared_ptr<Segment>& kept) { return wanted < kept->getHeader().firstSequence; });
+        segments.insert(position, segment);
+    }
+}
+
+size_t JobStore::add(const std::vector<Job>& jobs) {
+    // Function to append the new and changed jobs to the active segment
+    TRACE_SCOPE("JobStore::add", "store");
+    const uint64_t storedAt = (uint64_t)std::time(nullptr);
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t written = 0;
+    std::string record;
+    for (const Job& job : jobs) {
+        const std::string& key = getKey(job);
+        const uint64_t keyHash = hashBytes(key.data(), key.size());
+        const uint64_t contentHash = hashContent(job);
+        uint64_t storedHash;
+        if (findLatest(keyHash, key, storedHash) && storedHash == contentHash) continue;
+        // Already stored as it is: searches return the same jobs again and again
+
+        record.clear();
+        encodeRecord(job, storedAt, contentHash, record);
+
+        if (activeBytes.empty()) {
+            SegmentHeader header = { segmentMagic, formatVersion };
+            activeBytes.assign((const char*)&header, sizeof(header));
+            activeFile.open(getPath(nextSequence, 0, ".seg"), std::ios::binary | std::ios::trunc);
+            activeFile.write(activeBytes.data(), activeBytes.size());
+        }
+        ActiveEntry entry = { contentHash, activeBytes.size(), (uint32_t)record.size() };
+        activeIndex[keyHash] = entry;
+        activeBytes += record;
+        activeFile.write(record.data(), record.size());
+        activeRecords++;
+        written++;
+
+        if (activeBytes.size() >= segmentLimit) {
+            seal();
+        }
+    }
+    if (activeFile.is_open()) activeFile.flush();
+    // On disk once add returns; a crash loses at most a record being written, which recover() drops
+
+    scheduleCompaction();
+    return written;
+}
+
+bool JobStore::findLatest(uint64_t keyHash, const std::string& key, uint64_t& contentHash) const {
+    // Function to look a key up in the active segment, then in the sealed ones from the newest
+    std::string storedKey;
+    std::unordered_map<uint64_t, ActiveEntry>::const_iterator active = activeIndex.find(keyHash);
+    if (active != activeIndex.end()) {
+        if (decodeKey(activeBytes.data() + active->second.offset, active->second.length, storedKey) && storedKey == key) {
+            contentHash = active->second.contentHash;
+            return true;
+        }
+    }
+    for (size_t i = segments.size(); i-- > 0;) {
+        const IndexEntry* entry = segments[i]->find(keyHash);
+        const char* record;
+        if (entry && segments[i]->getRecord(entry->offset, entry->length, record) &&
+            decodeKey(record, entry->length, storedKey) && storedKey == key) {
+            contentHash = entry->contentHash;
+            return true;
+        }
+    }
+    return false;
+    // The keys are compared too, so a hash collision stores the job instead of losing it
+}
+
+bool JobStore::find(const std::string& id, Job& job) const {
+    // Function to read the newest copy of a job
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint64_t keyHash = hashBytes(id.data(), id.size());
+    std::string storedKey;
+    std::unordered_map<uint64_t, ActiveEntry>::const_iterator active = activeIndex.find(keyHash);
+    if (active != activeIndex.end() && decodeKey(activeBytes.data() + active->second.offset, active->second.length, storedKey) &&
+        storedKey == id) {
+        return decodeRecord(activeBytes.data() + active->second.offset, active->second.length, job);
+    }
+    for (size_t i = segments.size(); i-- > 0;) {
+        const IndexEntry* entry = segments[i]->find(keyHash);
+        const char* record;
+        if (entry && segments[i]->getRecord(entry->offset, entry->length, record) &&
+            decodeKey(record, entry->length, storedKey) && storedKey == id) {
+            return decodeRecord(record, entry->length, job);
+        }
+    }
+    return false;
+}
+
+std::vector<Job> JobStore::readRecent(size_t limit) const {
+    // Function to collect the stored jobs into one vector
+    std::vector<Job> jobs;
+    readRecent(limit, limit, [&jobs](std::vector<Job>& batch) {
+        jobs.swap(batch);
+    });
+    // One batch of every job, handed over without copying
+    return jobs;
+}
+
+void JobStore::readRecent(size_t limit, size_t batchSize, const std::function<void(std::vector<Job>&)>& onBatch) const {
+    // Function to read the records from the newest, skipping the older copies of jobs stored again
+    TRACE_SCOPE("JobStore::readRecent", "store");
+    std::vector<std::shared_ptr<Segment>> sealed;
+    std::string active;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sealed = segments;
+        active = activeBytes;
+    }
+    // Read outside the lock; the references keep the mapped segments alive if a compaction replaces them
+
+    std::vector<Job> batch;
+    size_t count = 0;
+    std::unordered_set<std::string> seen;
+    std::string key;
+    auto readSegment = [&](const char* data, size_t size) {
+        std::vector<uint64_t> offsets = listRecords(data, size);
+        for (size_t i = offsets.size(); i-- > 0 && count < limit;) {
+            const char* record = data + offsets[i];
+            uint32_t length = (i + 1 < offsets.size() ? (uint32_t)(offsets[i + 1] - offsets[i]) : (uint32_t)(size - offsets[i]));
+            Job job;
+            if (!decodeKey(record, length, key) || !seen.insert(key).second) continue;
+            if (!decodeRecord(record, length, job)) continue;
+            batch.push_back(std::move(job));
+            count++;
+            if (batch.size() >= batchSize) {
+                onBatch(batch);
+                batch.clear();
+            }
+        }
+    };
+    readSegment(active.data(), active.size());
+    for (size_t i = sealed.size(); i-- > 0 && count < limit;) {
+        readSegment(sealed[i]->records.getData(), (size_t)sealed[i]->getHeader().segmentBytes);
+    }
+    if (!batch.empty()) {
+        onBatch(batch);
+    }
+}
+
+void JobStore::seal() {
+    // Function to turn the active segment into a sealed one
+    if (activeRecords == 0) return;
+    TRACE_SCOPE("JobStore::seal", "store");
+    activeFile.close();
+
+    std::vector<IndexEntry> entries;
+    entries.reserve(activeIndex.size());
+    for (const std::pair<const uint64_t, ActiveEntry>& active : activeIndex) {
+        IndexEntry entry = { active.first, active.second.contentHash, active.second.offset, active.second.length, 0 };
+        entries.push_back(entry);
+    }
+
+    std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+    segment->recordsPath = getPath(nextSequence, 0, ".seg");
+    segment->indexPath = getPath(nextSequence, 0, ".idx");
+    if (writeIndex(segment->indexPath, nextSequence, nextSequence, activeBytes.size(), entries) && segment->map()) {
+        segments.push_back(segment);
+    }
+    else {
+        std::cerr << "Unable to seal job store segment " << segment->recordsPath << std::endl;
+    }
+    // Left unsealed, the segment is recovered on the next start
+
+    nextSequence++;
+    activeBytes.clear();
+    activeIndex.clear();
+    activeRecords = 0;
+}
+
+void JobStore::scheduleCompaction() {
+    // Function to start a background compaction when one is due
+    if (compacting || segments.empty()) return;
+    uint64_t bytes = activeBytes.size();
+    for (const std::shared_ptr<Segment>& segment : segments) {
+        bytes += segment->getBytes();
+    }
+    if (segments.size() <= compactionThreshold && bytes <= maxBytes) return;
+
+    compacting = true;
+    TaskScheduler::shared().submit([this]() { runCompaction(); }, TaskPriorityLow);
+}
+
+void JobStore::compact() {
+    // Function to compact on the calling thread, after any compaction already running
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        compacted.wait(lock, [this] { return !compacting; });
+        compacting = true;
+    }
+    runCompaction();
+}
+
+void JobStore::runCompaction() {
+    // Function to merge sealed segments into one
+    TRACE_SCOPE("JobStore::runCompaction", "store");
+    std::vector<std::shared_ptr<Segment>> inputs;
+    uint64_t activeSize;
+    uint64_t nextGeneration = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inputs = segments;
+        activeSize = activeBytes.size();
+    }
+
+    uint64_t totalBytes = activeSize;
+    for (const std::shared_ptr<Segment>& segment : inputs) {
+        totalBytes += segment->getBytes();
+    }
+    const bool overBudget = totalBytes > maxBytes;
+    if (!overBudget && inputs.size() > 1 && inputs.front()->getBytes() >= totalBytes - activeSize - inputs.front()->getBytes()) {
+        inputs.erase(inputs.begin());
+    }
+    // The oldest segment is merged only once the newer ones add up to its size, so each job is rewritten a
+    // logarithmic number of times; over budget everything is merged, since the oldest jobs are the ones dropped
+
+    std::vector<std::vector<IndexEntry>> kept(inputs.size());
+    {
+        std::unordered_set<uint64_t> newer;
+        for (size_t i = inputs.size(); i-- > 0;) {
+            for (const IndexEntry* entry = inputs[i]->begin(); entry != inputs[i]->end(); ++entry) {
+                if (newer.insert(entry->keyHash).second) kept[i].push_back(*entry);
+            }
+            std::sort(kept[i].begin(), kept[i].end(), [](const IndexEntry& a, const IndexEntry& b) { return a.offset < b.offset; });
+            nextGeneration = std::max<uint64_t>(nextGeneration, inputs[i]->generation + 1);
+        }
+    }
+    // Keep the newest copy of each job, in the order the jobs were stored; older copies of a job also stored in a
+    // segment left out of the merge stay until a full one
+
+    if (overBudget) {
+        uint64_t liveBytes = activeSize;
+        for (const std::vector<IndexEntry>& entries : kept) {
+            for (const IndexEntry& entry : entries) {
+                liveBytes += entry.length + sizeof(IndexEntry);
+            }
+        }
+        const uint64_t target = maxBytes > 4 * segmentLimit ? maxBytes - 2 * segmentLimit : maxBytes / 2;
+        for (std::vector<IndexEntry>& entries : kept) {
+            size_t dropped = 0;
+            while (dropped < entries.size() && liveBytes > target) {
+                liveBytes -= entries[dropped++].length + sizeof(IndexEntry);
+            }
+            entries.erase(entries.begin(), entries.begin() + dropped);
+        }
+    }
+    // Over budget: drop the jobs stored longest ago, leaving room for a couple of segments before the next drop
+
+    std::shared_ptr<Segment> output;
+    if (!inputs.empty()) {
+        const uint64_t firstSequence = inputs.front()->getHeader().firstSequence;
+        const uint64_t lastSequence = inputs.back()->getHeader().lastSequence;
+        output = std::make_shared<Segment>();
+        output->recordsPath = getPath(lastSequence, (uint32_t)nextGeneration, ".seg");
+        output->indexPath = getPath(lastSequence, (uint32_t)nextGeneration, ".idx");
+        output->generation = (uint32_t)nextGeneration;
+
+        std::vector<IndexEntry> entries;
+        uint64_t offset = sizeof(SegmentHeader);
+        bool written;
+        {
+            std::ofstream file(output->recordsPath, std::ios::binary | std::ios::trunc);
+            SegmentHeader header = { segmentMagic, formatVersion };
+            file.write((const char*)&header, sizeof(header));
+            for (size_t i = 0; i < inputs.size(); i++) {
+                for (const IndexEntry& entry : kept[i]) {
+                    const char* record;
+                    if (!inputs[i]->getRecord(entry.offset, entry.length, record)) continue;
+                    file.write(record, entry.length);
+                    IndexEntry moved = entry;
+                    moved.offset = offset;
+                    entries.push_back(moved);
+                    offset += entry.length;
+                }
+            }
+            // Records are copied as they are, without decoding them
+            written = (bool)file;
+        }
+        if (entries.empty() || !written || !writeIndex(output->indexPath, firstSequence, lastSequence, offset, entries) || !output->map()) {
+            if (!entries.empty()) std::cerr << "Job store compaction failed writing " << output->recordsPath << std::endl;
+            output->obsolete = true;
+            output.reset();
+            // Removes the partial files; the inputs stay unless nothing was left to keep
+            if (!entries.empty()) inputs.clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!inputs.empty()) {
+        std::vector<std::shared_ptr<Segment>>::iterator first = std::find(segments.begin(), segments.end(), inputs.front());
+        if (first != segments.end()) {
+            first = segments.erase(first, first + inputs.size());
+            if (output) segments.insert(first, output);
+        }
+        for (const std::shared_ptr<Segment>& input : inputs) {
+            input->obsolete = true;
+        }
+    }
+    // Segments sealed meanwhile were appended after the inputs, which are still in place: only a compaction
+    // changes that part of the list, and compactions never overlap
+    compacting = false;
+    compacted.notify_all();
+}
+
+void JobStore::clear() {
+    // Function to drop every segment and start over
+    std::unique_lock<std::mutex> lock(mutex);
+    compacted.wait(lock, [this] { return !compacting; });
+    for (const std::shared_ptr<Segment>& segment : segments) {
+        segment->obsolete = true;
+    }
+    segments.clear();
+    if (activeFile.is_open()) {
+        activeFile.close();
+        std::remove(getPath(nextSequence, 0, ".seg").c_str());
+    }
+    activeBytes.clear();
+    activeIndex.clear();
+    activeRecords = 0;
+}
+
+bool JobStore::destroy(const std::string& directory) {
+    // Function to delete the segment and index files, and anything else left in the directory, then the directory
+    for (const std::string& name : listFiles(directory)) {
+        std::remove((directory + "/" + name).c_str());
+    }
+    return removeDirectory(directory);
+}
+
+size_t JobStore::getRecordCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = activeRecords;
+    for (const std::shared_ptr<Segment>& segment : segments) {
+        count += (size_t)segment->getHeader().entryCount;
+    }
+    return count;
+}
+
+uint64_t JobStore::getByteCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t bytes = activeBytes.size();
+    for (const std::shared_ptr<Segment>& segment : segments) {
+        bytes += segment->getBytes();
+    }
+    return bytes;
+}
+
+size_t JobStore::getSegmentCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return segments.size();
+}
@@ -0,0 +1,138 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include "Job.h"
+// Includes the Job header file - contains the Job struct definition
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <fstream>
+// Includes the file stream the active segment is appended to
+#include <functional>
+// Includes std::function for reading the stored jobs a batch at a time
+#include <cstdint>
+#include <mutex>
+// Includes the mutex class, since searches add jobs from the workers while the UI reads
+#include <condition_variable>
+// Includes the condition_variable class used to wait for a compaction
+
+class JobStore {
+public:
+    explicit JobStore(const std::string& directory = "jobstore", uint64_t maxBytes = 128ull << 20);
+    // Constructor: opens the store in a directory (created if missing) and keeps it under maxBytes on disk
+    // Opening only maps the sealed segments and their indexes; no job is read until asked for
+    // Throws std::runtime_error if the directory cannot be created or listed
+
+    ~JobStore();
+    // Destructor: waits for a compaction in progress and seals the active segment
+
+    size_t add(const std::vector<Job>& jobs);
+    // Function to store jobs, keyed by Adzuna id (by URL for a job without one); a job already stored with the
+    // same fields is skipped, a changed one is stored again and supersedes the old copy. Returns the number of
+    // jobs written
+
+    bool find(const std::string& id, Job& job) const;
+    // Function to read the latest stored copy of a job by its Adzuna id
+
+    std::vector<Job> readRecent(size_t limit) const;
+    // Function to read up to limit stored jobs, most recently stored first, for offline browsing
+
+    void readRecent(size_t limit, size_t batchSize, const std::function<void(std::vector<Job>&)>& onBatch) const;
+    // Function to read up to limit stored jobs in the same order, handing them to onBatch batchSize at a time, so
+    // only one batch is decoded in memory at once (for indexing the whole store)
+
+    void compact();
+    // Function to merge the sealed segments now, on the calling thread (normally done in the background)
+
+    void clear();
+    // Function to delete every stored job and its files
+
+    static bool destroy(const std::string& directory);
+    // Function to delete a store's directory with every file in it, for scratch stores such as the benchmarks';
+    // no JobStore may have it open. Returns false if the directory is still there
+
+    size_t getRecordCount() const;
+    // Number of stored records; a job stored again with changes counts twice until the next compaction
+
+    uint64_t getByteCount() const;
+    // Size of the store on disk
+
+    size_t getSegmentCount() const;
+    // Number of sealed segments
+
+private:
+    struct Segment;
+    // A sealed segment file and its index, both memory-mapped (defined in JobStore.cpp)
+
+    struct ActiveEntry {
+        uint64_t contentHash;
+        // Hash of the job's fields, to skip storing an unchanged job again
+        uint64_t offset;
+        // Position of the record in the active segment
+        uint32_t length;
+        // Size of the record
+    };
+    // Latest record of a key in the active segment
+
+    const std::string directory;
+    // Directory the segment and index files live in
+
+    const uint64_t maxBytes;
+    // Disk budget; compaction drops the oldest jobs to stay under it
+
+    mutable std::mutex mutex;
+    // Mutex for the members below
+
+    std::condition_variable compacted;
+    // Condition variable signalled when a compaction finishes
+
+    std::vector<std::shared_ptr<Segment>> segments;
+    // Sealed segments, oldest first; readers hold a reference, so a compaction can replace them meanwhile
+
+    uint64_t nextSequence;
+    // Sequence number of the next segment, increasing with the age of the data
+
+    std::string activeBytes;
+    // Records of the segment being appended to, also written through to its file
+
+    std::ofstream activeFile;
+    // File of the active segment, opened with the first record
+
+    std::unordered_map<uint64_t, ActiveEntry> activeIndex;
+    // Latest record of each key hash in the active segment
+
+    size_t activeRecords;
+    // Number of records in the active segment
+
+    bool compacting;
+    // Flag to indicate a compaction is queued or running; compactions never overlap
+
+    std::string getPath(uint64_t sequence, uint32_t generation, const char* extension) const;
+    // Function to build the path of a segment or index file
+
+    void open();
+    // Function to map the sealed segments, drop files left over by an interrupted compaction and recover a
+    // segment that was never sealed
+
+    void recover(uint64_t sequence, uint32_t generation);
+    // Function to seal a segment left unsealed by a crash, dropping a torn last record
+
+    bool findLatest(uint64_t keyHash, const std::string& key, uint64_t& contentHash) const;
+    // Function to find the content hash of the latest stored copy of a key (mutex held)
+
+    void seal();
+    // Function to write the index of the active segment, map both files and start a new segment (mutex held)
+
+    void scheduleCompaction();
+    // Function to queue a compaction on the task scheduler when there are too many segments or too many bytes
+    // (mutex held)
+
+    void runCompaction();
+    // Function to merge sealed segments: superseded copies are dropped, and the oldest jobs when over budget
+};
+// Append-only store of every job fetched, kept across sessions for offline search and browsing
+// Jobs are appended to a segment file; a full segment is sealed with an index of its keys sorted by hash, and
+// sealed segments are memory-mapped, so opening the store costs a few system calls at any size. Compaction merges
+// segments in the background, keeping the newest copy of each job, and enforces the disk budget
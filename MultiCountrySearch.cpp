@@ -0,0 +1,201 @@
+#include "MultiCountrySearch.h"
+// Includes the header file for the MultiCountrySearch class
+
+#include <algorithm>
+// Includes std::merge and std::find_if
+
+#include <cmath>
+// Includes std::lround
+
+#include <cstdlib>
+// Includes std::atof
+
+#include <iterator>
+// Includes std::make_move_iterator and std::back_inserter
+
+namespace {
+    struct CurrencyRate {
+        const char* currency;
+        double perUsd;
+        // Units of the currency one US dollar buys
+    };
+
+    const CurrencyRate currencyRates[] = {
+        {"USD", 1.0}, {"GBP", 0.79}, {"EUR", 0.92}, {"AUD", 1.52}, {"BRL", 5.0}, {"CAD", 1.36}, {"CHF", 0.88},
+        {"INR", 83.0}, {"MXN", 17.0}, {"NZD", 1.64}, {"PLN", 4.0}, {"SGD", 1.34}, {"ZAR", 18.5}
+    };
+    // Approximate exchange rates of the currencies of the Adzuna countries; close enough to rank and filter salaries
+
+    double unitsPerUsd(const std::string& currency) {
+        // Function to look up a currency's rate, 0 if it is unknown
+        for (const CurrencyRate& rate : currencyRates) {
+            if (currency == rate.currency) return rate.perUsd;
+        }
+        return 0.0;
+    }
+
+    std::string convertSalaryRange(const std::string& range, const std::string& from, const std::string& to) {
+        // Function to convert a "min-max" or "min+" salary range between currencies
+        if (range == "Any") return range;
+
+        size_t dashPos = range.find('-');
+        if (dashPos != std::string::npos) {
+            long low = std::lround(MultiCountrySearch::convertSalary(std::atof(range.substr(0, dashPos).c_str()), from, to));
+            long high = std::lround(MultiCountrySearch::convertSalary(std::atof(range.substr(dashPos + 1).c_str()), from, to));
+            return std::to_string(low) + "-" + std::to_string(high);
+        }
+        if (!range.empty() && range.back() == '+') {
+            return std::to_string(std::lround(MultiCountrySearch::convertSalary(std::atof(range.c_str()), from, to))) + "+";
+        }
+        return range;
+    }
+
+    struct RankedJob {
+        size_t position;
+        // Position in its country's results
+        double salary;
+        // Salary in the common currency
+        size_t country;
+        // Index of the country, so equal keys keep a stable order
+        Job job;
+    };
+
+    bool ranksBefore(const RankedJob& a, const RankedJob& b) {
+        // Function to order the merged results: relevance first, then the higher salary, then the country
+        if (a.position != b.position) return a.position < b.position;
+        if (a.salary != b.salary) return a.salary > b.salary;
+        return a.country < b.country;
+    }
+}
+
+struct MultiCountrySearch::MergeState {
+    std::mutex mutex;
+    // Mutex for the members below
+
+    std::vector<RankedJob> ranked;
+    // Every result merged so far, in rank order
+
+    std::shared_ptr<const std::vector<Job>> snapshot;
+    // The jobs of ranked, published for the UI
+
+    std::string error;
+    // Errors of the countries that failed
+
+    std::atomic<size_t> merged;
+    // Countries merged so far
+
+    std::string currency;
+    // Common currency of the salaries
+
+    MergeState() : snapshot(std::make_shared<const std::vector<Job>>()), merged(0) {}
+};
+
+MultiCountrySearch::MultiCountrySearch(JobSearch& engine, const SearchRequest& request, const std::vector<CountryTarget>& countries,
+    const std::string& currency)
+    : state(std::make_shared<MergeState>()) {
+    // Constructor for the MultiCountrySearch class
+    state->currency = currency;
+
+    std::vector<CountryTarget> unique;
+    for (const CountryTarget& country : countries) {
+        if (std::find_if(unique.begin(), unique.end(), [&country](const CountryTarget& seen) { return seen.code == country.code; }) == unique.end()) {
+            unique.push_back(country);
+        }
+    }
+    // Great Britain and the United Kingdom share a code
+
+    for (size_t index = 0; index < unique.size(); index++) {
+        SearchRequest countryRequest = request;
+        countryRequest.country = unique[index].code;
+        countryRequest.currencySymbol = unique[index].currencySymbol;
+        countryRequest.salaryRange = convertSalaryRange(request.salaryRange, currency, unique[index].currencySymbol);
+
+        std::shared_ptr<MergeState> shared = state;
+        searches.push_back(engine.searchJobs(countryRequest, [shared, index](const SearchHandle& search, SearchEvent event) {
+            if (event != SearchEventFinished) return;
+
+            std::shared_ptr<const std::vector<Job>> jobs = search.getResults();
+            std::vector<RankedJob> incoming;
+            incoming.reserve(jobs->size());
+            for (size_t position = 0; position < jobs->size(); position++) {
+                RankedJob ranked;
+                ranked.position = position;
+                ranked.country = index;
+                ranked.job = (*jobs)[position];
+                ranked.job.salary = convertSalary(ranked.job.salary, ranked.job.salaryCurrency, shared->currency);
+                ranked.job.salaryCurrency = shared->currency;
+                ranked.salary = ranked.job.salary;
+                incoming.push_back(std::move(ranked));
+            }
+            // Normalized off the UI thread, on the worker that ran the country's search
+            // A country's results arrive in position order, so they are already sorted
+
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (search.getStatus() == SearchStatusFailed) {
+                shared->error += (shared->error.empty() ? "" : "; ") + search.getRequest().country + ": " + search.getError();
+            }
+
+            std::vector<RankedJob> ranked;
+            ranked.reserve(shared->ranked.size() + incoming.size());
+            std::merge(std::make_move_iterator(shared->ranked.begin()), std::make_move_iterator(shared->ranked.end()),
+                std::make_move_iterator(incoming.begin()), std::make_move_iterator(incoming.end()), std::back_inserter(ranked), ranksBefore);
+            shared->ranked.swap(ranked);
+            // Stream merge: each country is merged in as it arrives, so the UI can show partial results
+
+            std::shared_ptr<std::vector<Job>> snapshot = std::make_shared<std::vector<Job>>();
+            snapshot->reserve(shared->ranked.size());
+            for (const RankedJob& entry : shared->ranked) {
+                snapshot->push_back(entry.job);
+            }
+            shared->snapshot = snapshot;
+            shared->merged.fetch_add(1, std::memory_order_release);
+        }));
+    }
+    // Every request is queued at once; the total time is that of the slowest country as long as the scheduler,
+    // the rate limiter and the quota let them run side by side
+}
+
+MultiCountrySearch::~MultiCountrySearch() {
+    // Destructor for the MultiCountrySearch class
+    cancel();
+}
+
+std::shared_ptr<const std::vector<Job>> MultiCountrySearch::getResults() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->snapshot;
+}
+
+size_t MultiCountrySearch::getVersion() const {
+    return state->merged.load(std::memory_order_acquire);
+}
+
+size_t MultiCountrySearch::getCountryCount() const {
+    return searches.size();
+}
+
+bool MultiCountrySearch::isDone() const {
+    // Function to check whether every country has been merged
+    return getVersion() == searches.size();
+}
+
+void MultiCountrySearch::cancel() {
+    // Function to cancel every country's search
+    for (const std::shared_ptr<SearchHandle>& search : searches) {
+        search->cancel();
+    }
+}
+
+std::string MultiCountrySearch::getError() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->error;
+}
+
+double MultiCountrySearch::convertSalary(double amount, const std::string& from, const std::string& to) {
+    // Function to convert an amount between currencies through the US dollar
+    double fromRate = unitsPerUsd(from);
+    double toRate = unitsPerUsd(to);
+    if (fromRate == 0.0 || toRate == 0.0 || from == to) {
+        return amount;
+    }
+    return amount / fromRate * toRate;
+}
@@ -0,0 +1,63 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+// Includes the mutex class protecting the merged results
+#include <atomic>
+// Includes the atomic class for the lock-free progress checks
+#include "JobSearch.h"
+// Includes the JobSearch header file - runs the per-country searches
+
+struct CountryTarget {
+    std::string code;
+    // Adzuna country code
+    std::string currencySymbol;
+    // Currency the country's salaries are in
+};
+// One country of a multi-country search
+
+class MultiCountrySearch {
+public:
+    MultiCountrySearch(JobSearch& engine, const SearchRequest& request, const std::vector<CountryTarget>& countries,
+        const std::string& currency);
+    // Constructor: starts one search per country at once (duplicate codes are searched once)
+    // request.salaryRange is in the given currency and converted to each country's own; request.country is ignored
+
+    ~MultiCountrySearch();
+    // Destructor: cancels the searches still running
+
+    std::shared_ptr<const std::vector<Job>> getResults() const;
+    // The jobs of the countries finished so far, merged into one ranked list, salaries in the common currency
+    // Ranked by position in their country's results (the API's relevance order), then by salary
+
+    size_t getVersion() const;
+    // Number of country results merged so far; a lock-free load, cheap enough to poll every frame
+
+    size_t getCountryCount() const;
+    // Number of countries searched
+
+    bool isDone() const;
+    // Function to check whether every country's search is done
+
+    void cancel();
+    // Function to cancel every country's search
+
+    std::string getError() const;
+    // The errors of the countries that failed ("de: HTTP 500; fr: ..."), empty if none did
+
+    static double convertSalary(double amount, const std::string& from, const std::string& to);
+    // Function to convert an amount between two currencies at fixed approximate rates; unknown currencies are not converted
+
+private:
+    struct MergeState;
+    // Results merged so far, shared with the search callbacks (defined in MultiCountrySearch.cpp)
+
+    std::shared_ptr<MergeState> state;
+    // Outlives this object while a search callback still runs
+
+    std::vector<std::shared_ptr<SearchHandle>> searches;
+    // One search per country
+};
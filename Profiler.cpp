@@ -0,0 +1,281 @@
+#include "Profiler.h"
+// Includes the header file for the Profiler class
+
+#include "Trace.h"
+// Includes the tracer, whose state is shown in the overlay
+
+#include <imgui.h>
+// Includes the Dear ImGui library, used to draw the overlay
+
+#include <algorithm>
+// Includes std::nth_element for the percentiles
+
+#include <cfloat>
+// Includes FLT_MAX for the plot scale
+
+#include <cstdio>
+// Includes snprintf for the plot caption
+
+#include <cstdlib>
+// Includes malloc and free for the counting operator new
+
+#include <cstring>
+// Includes memcpy
+
+#include <mutex>
+// Includes the mutex protecting the latest search timings
+
+#include <new>
+// Includes std::bad_alloc
+
+std::atomic<bool> Profiler::enabled(false);
+std::atomic<size_t> Profiler::allocations(0);
+
+namespace {
+    const int historySize = 300;
+    // Number of frames kept in the frame-time history (5 seconds at 60 fps)
+
+    const int maxScopes = 32;
+    // Maximum number of distinct scope names per frame
+
+    struct ScopeStats {
+        const char* name;
+        double ms;
+        int calls;
+    };
+    // Accumulated time of one named scope during a frame
+
+    float frameMs[historySize];
+    // Ring buffer of frame CPU times, in milliseconds
+    float frameAllocations[historySize];
+    // Ring buffer of allocations per frame
+    int historyNext = 0;
+    int historyCount = 0;
+    // Position of the next sample and number of valid samples
+
+    std::chrono::steady_clock::time_point frameStart;
+    size_t frameStartAllocations = 0;
+    bool frameOpen = false;
+    // State of the frame currently being measured
+
+    ScopeStats currentScopes[maxScopes];
+    int currentScopeCount = 0;
+    // Scopes of the frame being measured
+    ScopeStats lastScopes[maxScopes];
+    int lastScopeCount = 0;
+    // Scopes of the last completed frame, shown by the overlay
+
+    std::mutex searchMutex;
+    double lastSearchMs[SearchStageCount];
+    int searchCount = 0;
+    // Stage timings of the latest search, written by the search thread
+
+    float percentile(const float* values, int count, double p) {
+        // Function to compute a percentile (nearest rank) without allocating
+        if (count == 0) return 0.0f;
+        float sorted[historySize];
+        std::memcpy(sorted, values, count * sizeof(float));
+        int rank = std::min(count - 1, (int)(p / 100.0 * (count - 1) + 0.5));
+        std::nth_element(sorted, sorted + rank, sorted + count);
+        return sorted[rank];
+    }
+
+    void* imguiAlloc(size_t size, void*) {
+        // Function to allocate memory for ImGui and count it like operator new
+        Profiler::countAllocation();
+        return std::malloc(size);
+    }
+
+    void imguiFree(void* p, void*) {
+        // Function to free memory allocated by imguiAlloc
+        std::free(p);
+    }
+}
+
+void* operator new(std::size_t size) {
+    Profiler::countAllocation();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+// Counting allocator; the counter is only touched while profiling is enabled
+
+void Profiler::setEnabled(bool value) {
+    // Function to turn profiling on or off
+    if (value && !isEnabled()) {
+        historyNext = 0;
+        historyCount = 0;
+        currentScopeCount = 0;
+        lastScopeCount = 0;
+        frameOpen = false;
+        std::lock_guard<std::mutex> lock(searchMutex);
+        searchCount = 0;
+        // Start with a clean history so stale samples are not mixed in
+    }
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+void Profiler::beginFrame() {
+    // Function to mark the start of a frame
+    if (!isEnabled()) return;
+    frameStart = std::chrono::steady_clock::now();
+    frameStartAllocations = allocations.load(std::memory_order_relaxed);
+    currentScopeCount = 0;
+    frameOpen = true;
+}
+
+void Profiler::endFrame() {
+    // Function to mark the end of a frame and store its measurements
+    if (!isEnabled() || !frameOpen) return;
+    frameOpen = false;
+
+    frameMs[historyNext] = (float)std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    frameAllocations[historyNext] = (float)(allocations.load(std::memory_order_relaxed) - frameStartAllocations);
+    historyNext = (historyNext + 1) % historySize;
+    historyCount = std::min(historyCount + 1, historySize);
+
+    std::memcpy(lastScopes, currentScopes, currentScopeCount * sizeof(ScopeStats));
+    lastScopeCount = currentScopeCount;
+}
+
+void Profiler::recordScope(const char* name, double ms) {
+    // Function to add the duration of a named scope to the current frame
+    for (int i = 0; i < currentScopeCount; i++) {
+        if (currentScopes[i].name == name) {
+            currentScopes[i].ms += ms;
+            currentScopes[i].calls++;
+            return;
+        }
+    }
+    // Names are string literals, so comparing pointers is enough
+    if (currentScopeCount < maxScopes) {
+        ScopeStats& scope = currentScopes[currentScopeCount++];
+        scope.name = name;
+        scope.ms = ms;
+        scope.calls = 1;
+    }
+}
+
+void Profiler::recordSearch(const double (&stageMs)[SearchStageCount]) {
+    // Function to store the stage timings of the latest search
+    std::lock_guard<std::mutex> lock(searchMutex);
+    std::memcpy(lastSearchMs, stageMs, sizeof(lastSearchMs));
+    searchCount++;
+}
+
+void Profiler::installImGuiAllocator() {
+    // Function to make ImGui allocate through the counting wrappers
+    ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree, nullptr);
+}
+
+size_t Profiler::getAllocationCount() {
+    // Function to get the number of counted allocations
+    return allocations.load(std::memory_order_relaxed);
+}
+
+const char* Profiler::getStageName(SearchStage stage) {
+    // Function to get the display name of a search stage
+    static const char* const names[SearchStageCount] = { "Queue wait", "Connect", "TLS", "TTFB", "Download", "Parse", "Publish" };
+    return names[stage];
+}
+
+void Profiler::renderOverlay(bool* open) {
+    // Function to render the profiler overlay window
+    ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 10.0f, 10.0f), ImGuiCond_FirstUseEver, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(380, 0), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler (F3)", open, ImGuiWindowFlags_NoSavedSettings)) {
+        ImGui::End();
+        return;
+    }
+
+    float ordered[historySize];
+    int start = (historyNext - historyCount + historySize) % historySize;
+    for (int i = 0; i < historyCount; i++) {
+        ordered[i] = frameMs[(start + i) % historySize];
+    }
+    // Oldest sample first, for the plot
+
+    float averageAllocations = 0.0f;
+    for (int i = 0; i < historyCount; i++) averageAllocations += frameAllocations[i];
+    if (historyCount > 0) averageAllocations /= historyCount;
+
+    char overlayText[64];
+    snprintf(overlayText, sizeof(overlayText), "p50 %.2f ms  p99 %.2f ms",
+        percentile(ordered, historyCount, 50), percentile(ordered, historyCount, 99));
+    ImGui::PlotLines("##frametimes", ordered, historyCount, 0, overlayText, 0.0f, FLT_MAX, ImVec2(-1.0f, 60.0f));
+    // Frame CPU time history
+
+    ImGui::Text("Frame: %.2f ms CPU, %.1f fps", historyCount > 0 ? ordered[historyCount - 1] : 0.0f, ImGui::GetIO().Framerate);
+    ImGui::Text("Allocations: %.0f last frame, %.1f average",
+        historyCount > 0 ? frameAllocations[(historyNext - 1 + historySize) % historySize] : 0.0f, averageAllocations);
+
+    if (Trace::isEnabled()) {
+        ImGui::Text("Tracing (F4 to save): %zu events, %zu dropped", Trace::getEventCount(), Trace::getDroppedCount());
+    }
+    else {
+        ImGui::TextDisabled("Tracing off (F4 to start)");
+    }
+
+    if (ImGui::CollapsingHeader("Scopes", ImGuiTreeNodeFlags_DefaultOpen) &&
+        ImGui::BeginTable("ProfilerScopes", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("calls", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < lastScopeCount; i++) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(lastScopes[i].name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", lastScopes[i].ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", lastScopes[i].calls);
+        }
+        ImGui::EndTable();
+    }
+    // Time spent in each instrumented scope during the last frame
+
+    double searchMs[SearchStageCount];
+    int searches;
+    {
+        std::lock_guard<std::mutex> lock(searchMutex);
+        std::memcpy(searchMs, lastSearchMs, sizeof(searchMs));
+        searches = searchCount;
+    }
+
+    if (ImGui::CollapsingHeader("Last search", ImGuiTreeNodeFlags_DefaultOpen)) {
+        if (searches == 0) {
+            ImGui::TextDisabled("No search since profiling was enabled");
+        }
+        else if (ImGui::BeginTable("ProfilerSearch", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+            ImGui::TableSetupColumn("Stage");
+            ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableHeadersRow();
+            double total = 0.0;
+            for (int i = 0; i < SearchStageCount; i++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(getStageName((SearchStage)i));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", searchMs[i]);
+                total += searchMs[i];
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted("Total");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", total);
+            ImGui::EndTable();
+        }
+    }
+    // Where the time of the latest search went
+
+    ImGui::End();
+}
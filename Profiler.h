@@ -0,0 +1,99 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <atomic>
+// Includes the atomic class for the enabled flag and the allocation counter
+#include <chrono>
+// Includes the steady clock used by the scoped timers
+#include <cstddef>
+// Includes size_t
+
+enum SearchStage {
+    SearchStageQueueWait,
+    // From searchJobs() until the search thread picks the request up
+    SearchStageConnect,
+    // DNS lookup and TCP connect
+    SearchStageTls,
+    // TLS handshake
+    SearchStageTtfb,
+    // From the end of the handshake until the response headers arrive
+    SearchStageDownload,
+    // Receiving the response body
+    SearchStageParse,
+    // Parsing the JSON and building Job objects
+    SearchStagePublish,
+    // Publishing the result snapshot
+    SearchStageCount
+};
+// Stages of one search request, in pipeline order
+
+class Profiler {
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    // Function to check whether profiling is on; this is the only cost paid when it is off
+
+    static void setEnabled(bool value);
+    // Function to turn profiling on or off
+
+    static void beginFrame();
+    // Marks the start of the CPU work of a frame
+
+    static void endFrame();
+    // Marks the end of the CPU work of a frame and stores its duration and allocation count
+
+    static void recordScope(const char* name, double ms);
+    // Adds the duration of a named scope to the current frame (UI thread only, name must be a string literal)
+
+    static void recordSearch(const double (&stageMs)[SearchStageCount]);
+    // Stores the stage timings of the latest search (any thread)
+
+    static size_t getAllocationCount();
+    // Total number of heap allocations counted while profiling was enabled
+
+    static void countAllocation() {
+        if (isEnabled()) allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Called by the global operator new
+
+    static void installImGuiAllocator();
+    // Routes ImGui's own allocations (IM_ALLOC uses malloc, not operator new) through the counter;
+    // call before ImGui::CreateContext()
+
+    static void renderOverlay(bool* open);
+    // Renders the profiler overlay window
+
+    static const char* getStageName(SearchStage stage);
+    // Display name of a search stage
+
+private:
+    static std::atomic<bool> enabled;
+    // Whether timers and counters are recording
+
+    static std::atomic<size_t> allocations;
+    // Heap allocations since profiling was enabled
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : name(Profiler::isEnabled() ? name : nullptr) {
+        if (this->name) start = std::chrono::steady_clock::now();
+    }
+    // Starts timing only when profiling is enabled
+
+    ~ScopedTimer() {
+        if (name) {
+            Profiler::recordScope(name, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+    // Records the elapsed time into the current frame
+
+private:
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+};
+// Times the enclosing scope on the UI thread
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(name)
+// Times the rest of the enclosing scope under the given name
@@ -0,0 +1,207 @@
+#include "RateLimiter.h"
+// Includes the header file for the RateLimiter class
+
+#include <algorithm>
+// Includes std::min and std::max
+
+#include <cmath>
+// Includes std::pow
+
+namespace {
+    const double retryBaseMs = 500.0;
+    // First retry waits up to half a second
+    const double retryMaxMs = 30000.0;
+    // No retry waits longer than 30 seconds
+    const double congestionFactor = 2.0;
+    // A successful request slower than twice the baseline counts as congestion
+    const size_t latencyWindow = 128;
+    // Successful requests the hedge delay is computed from
+    const size_t minimumLatencySamples = 20;
+    // No hedging before this many latencies are known
+}
+
+RateLimiter::RateLimiter()
+    : rate(25.0 / 60.0), burst(5.0), tokens(5.0), refilledAt(Clock::now()), maxConcurrency(8), concurrencyLimit(4.0),
+    slowStart(true), inFlight(0), baselineMs(0.0), latencyMs(0.0), nextLatency(0), requests(0), throttled(0), failures(0), hedges(0), hedgeWins(0),
+    random(std::random_device()()) {
+    // Constructor for the RateLimiter class
+}
+
+void RateLimiter::configure(double requestsPerSecond, int burstSize, int maxConcurrent) {
+    // Function to change the quota and the concurrency ceiling
+    std::lock_guard<std::mutex> lock(mutex);
+    rate = std::max(0.0, requestsPerSecond);
+    burst = std::max(1.0, (double)burstSize);
+    tokens = std::min(tokens, burst);
+    maxConcurrency = std::max(1, maxConcurrent);
+    concurrencyLimit = std::min(concurrencyLimit, (double)maxConcurrency);
+    changed.notify_all();
+}
+
+bool RateLimiter::acquire(const std::function<bool()>& isCancelled) {
+    // Function to wait until a request may be sent
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (isCancelled && isCancelled()) {
+            return false;
+        }
+
+        Clock::duration wait;
+        if (tryAcquireLocked(wait)) {
+            return true;
+        }
+        changed.wait_for(lock, wait);
+    }
+}
+
+bool RateLimiter::tryAcquire(std::chrono::steady_clock::duration& retryIn) {
+    // Function to take a token and a slot without waiting
+    std::lock_guard<std::mutex> lock(mutex);
+    return tryAcquireLocked(retryIn);
+}
+
+bool RateLimiter::tryAcquireLocked(Clock::duration& wait) {
+    // Function to take a token and a slot, or find out how long until one may be available
+    Clock::time_point now = Clock::now();
+    refill(now);
+
+    wait = std::chrono::milliseconds(50);
+    // Waits are sliced so a cancelled search stops waiting promptly
+
+    if (now < pausedUntil) {
+        wait = std::min(wait, pausedUntil - now);
+    }
+    else if (inFlight >= (int)concurrencyLimit) {
+        // Wait for release()
+    }
+    else if (rate > 0.0 && tokens < 1.0) {
+        wait = std::min(wait, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((1.0 - tokens) / rate)));
+    }
+    else {
+        if (rate > 0.0) tokens -= 1.0;
+        inFlight++;
+        requests++;
+        return true;
+    }
+    return false;
+}
+
+void RateLimiter::release(RequestOutcome outcome, double requestMs, double retryAfterSeconds) {
+    // Function to account for a finished request and adapt the concurrency limit
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    inFlight--;
+
+    if (retryAfterSeconds > 0.0) {
+        pausedUntil = std::max(pausedUntil, now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(retryAfterSeconds)));
+        tokens = std::min(tokens, 0.0);
+    }
+    // The server said when to come back; nobody sends before that
+
+    bool congested = false;
+    if (outcome == RequestOutcomeThrottled) {
+        throttled++;
+        congested = true;
+    }
+    else if (outcome == RequestOutcomeServerError || outcome == RequestOutcomeNetworkError) {
+        failures++;
+        congested = true;
+    }
+    else if (outcome == RequestOutcomeSuccess) {
+        latencyMs = latencyMs == 0.0 ? requestMs : latencyMs * 0.8 + requestMs * 0.2;
+        baselineMs = baselineMs == 0.0 ? requestMs : std::min(requestMs, baselineMs + (requestMs - baselineMs) * 0.01);
+        // The baseline follows new lows at once and drifts up slowly, so a changed route is learned eventually
+        congested = requestMs > baselineMs * congestionFactor && requestMs > 50.0;
+
+        if (recentLatencyMs.size() < latencyWindow) recentLatencyMs.push_back(requestMs);
+        else recentLatencyMs[nextLatency] = requestMs;
+        nextLatency = (nextLatency + 1) % latencyWindow;
+    }
+
+    if (congested) {
+        double roundTrip = std::max(latencyMs, 100.0);
+        if (now - decreasedAt > std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(roundTrip))) {
+            concurrencyLimit = std::max(1.0, concurrencyLimit * 0.5);
+            decreasedAt = now;
+            slowStart = false;
+        }
+    }
+    else if (outcome == RequestOutcomeSuccess) {
+        concurrencyLimit = std::min((double)maxConcurrency, concurrencyLimit + (slowStart ? 1.0 : 1.0 / concurrencyLimit));
+    }
+    // Multiplicative decrease on a congestion signal, additive increase of about one slot per round trip otherwise
+    // (one slot per success during the slow start)
+
+    changed.notify_all();
+}
+
+bool RateLimiter::tryAcquireHedge(double maxHedgeRatio) {
+    // Function to take a slot for a hedge if everything allows it right now
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    refill(now);
+    if (now < pausedUntil || inFlight >= maxConcurrency || (rate > 0.0 && tokens < 1.0)) {
+        return false;
+    }
+    if (hedges + 1 > maxHedgeRatio * (requests - hedges)) {
+        return false;
+    }
+    // Hedges spend quota, so they are capped at a fraction of the real requests. They may go beyond the adaptive
+    // limit, which a slow response has usually just lowered, but never beyond the ceiling
+
+    if (rate > 0.0) tokens -= 1.0;
+    inFlight++;
+    requests++;
+    hedges++;
+    return true;
+}
+
+double RateLimiter::getHedgeDelayMs() const {
+    // Function to get the p95 latency of recent successful requests
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recentLatencyMs.size() < minimumLatencySamples) {
+        return 0.0;
+    }
+    std::vector<double> sorted = recentLatencyMs;
+    size_t rank = sorted.size() * 95 / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+void RateLimiter::recordHedgeWin() {
+    std::lock_guard<std::mutex> lock(mutex);
+    hedgeWins++;
+}
+
+double RateLimiter::getRetryDelayMs(int attempt, double retryAfterSeconds) {
+    // Function to compute the wait before a retry
+    std::lock_guard<std::mutex> lock(mutex);
+    double ceiling = std::min(retryMaxMs, retryBaseMs * std::pow(2.0, attempt));
+    double delay = std::uniform_real_distribution<double>(0.0, ceiling)(random);
+    // Full jitter: clients that failed together do not retry together
+    return std::max(delay, retryAfterSeconds * 1000.0);
+}
+
+RateLimiterStats RateLimiter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    RateLimiterStats stats;
+    stats.concurrencyLimit = concurrencyLimit;
+    stats.inFlight = inFlight;
+    stats.requests = requests;
+    stats.throttled = throttled;
+    stats.failures = failures;
+    stats.latencyMs = latencyMs;
+    stats.hedges = hedges;
+    stats.hedgeWins = hedgeWins;
+    return stats;
+}
+
+void RateLimiter::refill(Clock::time_point now) {
+    // Function to add the tokens earned since the last refill
+    if (rate > 0.0 && now > pausedUntil) {
+        double seconds = std::chrono::duration<double>(now - std::max(refilledAt, pausedUntil)).count();
+        tokens = std::min(burst, tokens + seconds * rate);
+    }
+    // Nothing is earned during a Retry-After pause, so the end of a pause is not a burst
+    refilledAt = now;
+}
@@ -0,0 +1,154 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <mutex>
+// Includes the mutex class protecting the limiter state
+#include <condition_variable>
+// Includes the condition_variable class used to wait for a token or a free slot
+#include <functional>
+// Includes std::function for the cancellation check
+#include <random>
+// Includes the random number generator for the retry jitter
+#include <chrono>
+// Includes the steady clock the bucket refills with
+#include <vector>
+// Includes the vector class holding the recent latencies
+
+enum RequestOutcome {
+    RequestOutcomeSuccess,
+    // The API answered (any status other than 429 or 5xx)
+    RequestOutcomeThrottled,
+    // HTTP 429: over the quota
+    RequestOutcomeServerError,
+    // HTTP 5xx
+    RequestOutcomeNetworkError,
+    // No response (connection, TLS or read failure)
+    RequestOutcomeCancelled
+    // Aborted by the caller; says nothing about the API
+};
+// Result of one outbound request, as far as the rate limiter is concerned
+
+struct RateLimiterStats {
+    double concurrencyLimit;
+    // Current adaptive limit on concurrent requests
+    int inFlight;
+    // Requests being sent right now
+    long requests;
+    // Requests sent so far
+    long throttled;
+    // Responses with HTTP 429
+    long failures;
+    // Server errors and network failures
+    double latencyMs;
+    // Smoothed latency of successful requests
+    long hedges;
+    // Duplicate requests sent for slow ones
+    long hedgeWins;
+    // Hedges that answered before the original request
+};
+// Counters shown in the batch summary
+
+class RateLimiter {
+public:
+    RateLimiter();
+    // Constructor: Adzuna's free quota (25 requests per minute, bursts of 5), at most 8 concurrent requests
+
+    void configure(double requestsPerSecond, int burst, int maxConcurrency);
+    // Sets the token bucket (requestsPerSecond <= 0 disables it) and the ceiling of the adaptive concurrency limit
+
+    bool acquire(const std::function<bool()>& isCancelled);
+    // Blocks until a request may be sent: a token is available, a concurrency slot is free and no Retry-After
+    // pause is active. Returns false if isCancelled() became true while waiting
+
+    bool tryAcquire(std::chrono::steady_clock::duration& retryIn);
+    // Takes what acquire() waits for if it is available right now; otherwise returns false and sets retryIn to
+    // when to try again, so the caller can wait without holding a thread
+
+    void release(RequestOutcome outcome, double latencyMs, double retryAfterSeconds);
+    // Reports how the request went; throttling, server errors and rising latency shrink the concurrency limit,
+    // healthy responses grow it back (AIMD, with a slow start up to the first congestion signal, so a burst of
+    // searches such as an all-countries search soon runs side by side). A Retry-After pauses every request until it expires
+
+    bool tryAcquireHedge(double maxHedgeRatio);
+    // Takes a slot for a duplicate of a slow request without waiting; false if the quota, the concurrency ceiling
+    // or the hedge budget (hedges at most maxHedgeRatio of the other requests) does not allow one right now
+
+    double getHedgeDelayMs() const;
+    // Time after which a request counts as slow: the p95 latency of recent successful requests, 0 until known
+
+    void recordHedgeWin();
+    // Counts a hedge that answered first
+
+    double getRetryDelayMs(int attempt, double retryAfterSeconds);
+    // Delay before retry number attempt (0-based): exponential backoff with full jitter, at least the Retry-After
+
+    RateLimiterStats getStats() const;
+    // Snapshot of the counters
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    mutable std::mutex mutex;
+    // Mutex for the members below
+
+    std::condition_variable changed;
+    // Signalled when a slot is released or the settings change
+
+    double rate;
+    // Tokens added per second; 0 for no bucket
+
+    double burst;
+    // Capacity of the bucket
+
+    double tokens;
+    // Tokens available
+
+    Clock::time_point refilledAt;
+    // Time the bucket was last refilled
+
+    Clock::time_point pausedUntil;
+    // End of the latest Retry-After pause
+
+    int maxConcurrency;
+    // Ceiling of the concurrency limit
+
+    double concurrencyLimit;
+    // Adaptive concurrency limit (additive increase, multiplicative decrease)
+
+    Clock::time_point decreasedAt;
+    // Time of the last decrease; one decrease per round trip, so a burst of errors is one congestion signal
+
+    bool slowStart;
+    // True until the first congestion signal; the limit grows by one slot per success (doubling every round trip)
+
+    int inFlight;
+    // Requests acquired and not released
+
+    double baselineMs;
+    // Lowest recent latency, the uncongested round trip
+
+    double latencyMs;
+    // Smoothed latency of successful requests
+
+    std::vector<double> recentLatencyMs;
+    // Latencies of the last successful requests, a ring buffer for the hedge delay
+
+    size_t nextLatency;
+    // Ring buffer position of the next latency
+
+    long requests;
+    long throttled;
+    long failures;
+    long hedges;
+    long hedgeWins;
+    // Counters for getStats()
+
+    std::mt19937 random;
+    // Source of the retry jitter
+
+    void refill(Clock::time_point now);
+    // Adds the tokens earned since the last refill
+
+    bool tryAcquireLocked(Clock::duration& wait);
+    // Function to take a token and a slot if possible, or compute how long to wait (mutex held)
+};
@@ -0,0 +1,174 @@
+#include "ResultsTable.h"
+// Includes the header file for the ResultsTable class
+
+#include <imgui.h>
+// Includes the Dear ImGui library, which is used for creating the graphical user interface
+
+#include <algorithm>
+// Includes std::find, used to toggle facet values
+
+ResultsTable::ResultsTable() : collapseDuplicates(true) {
+    // Constructor for the ResultsTable class
+    filterBuffer[0] = '\0';
+}
+
+void ResultsTable::setJobs(std::shared_ptr<const std::vector<Job>> newJobs) {
+    // Function to switch the table to a new result snapshot
+    jobs = newJobs;
+    viewModelBuilder.setJobs(std::move(newJobs));
+}
+
+void ResultsTable::setFavorites(std::shared_ptr<const std::unordered_set<std::string>> favoriteUrls) {
+    // Function to update the favorite flags of the rows
+    viewModelBuilder.setFavorites(std::move(favoriteUrls));
+}
+
+bool ResultsTable::isUpToDate() const {
+    std::shared_ptr<const ResultsViewModel> viewModel = viewModelBuilder.getViewModel();
+    return viewModel && viewModel->jobs == jobs;
+}
+
+void ResultsTable::render(int& selectedJob, const std::function<void(const Job&)>& toggleFavorite) {
+    // Function to render the filter box and the results table
+
+    if (ImGui::InputTextWithHint("Filter", "Filter results", filterBuffer, IM_ARRAYSIZE(filterBuffer))) {
+        viewModelBuilder.setFilter(filterBuffer);
+        // Re-filter on every keystroke; the work happens on the view-model worker
+    }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Collapse similar postings", &collapseDuplicates)) {
+        viewModelBuilder.setCollapseDuplicates(collapseDuplicates);
+    }
+    // The same job reposted by several agencies is shown once, with a count of the others
+
+    std::shared_ptr<const ResultsViewModel> viewModel = viewModelBuilder.getViewModel();
+    // Take the latest published view model
+
+    if (!viewModel || viewModel->jobs != jobs) {
+        ImGui::Text("Preparing results...");
+        return;
+        // The worker has not caught up with the latest snapshot yet
+    }
+
+    renderFacets(*viewModel);
+
+    if (viewModel->rows.size() != viewModel->jobs->size()) {
+        ImGui::Text("Showing %d of %d jobs", (int)viewModel->rows.size(), (int)viewModel->jobs->size());
+    }
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_SortTristate | ImGuiTableFlags_Resizable |
+        ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter |
+        ImGuiTableFlags_BordersV | ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY;
+    if (!ImGui::BeginTable("JobTable", ViewModelBuilder::ColumnCount, flags)) return;
+
+    ImGui::TableSetupScrollFreeze(2, 1);
+    // Keep the header row and the favorite/title columns visible while scrolling
+    ImGui::TableSetupColumn("##Favorite", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoHide, 0.0f, ViewModelBuilder::ColumnFavorite);
+    ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoHide, 260.0f, ViewModelBuilder::ColumnTitle);
+    ImGui::TableSetupColumn("Company", ImGuiTableColumnFlags_WidthFixed, 160.0f, ViewModelBuilder::ColumnCompany);
+    ImGui::TableSetupColumn("Location", ImGuiTableColumnFlags_WidthFixed, 160.0f, ViewModelBuilder::ColumnLocation);
+    ImGui::TableSetupColumn("Salary", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending, 110.0f, ViewModelBuilder::ColumnSalary);
+    ImGui::TableSetupColumn("Contract Type", ImGuiTableColumnFlags_WidthFixed, 110.0f, ViewModelBuilder::ColumnContractType);
+    ImGui::TableSetupColumn("Category", ImGuiTableColumnFlags_WidthFixed, 140.0f, ViewModelBuilder::ColumnCategory);
+    ImGui::TableHeadersRow();
+
+    if (ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs()) {
+        if (sortSpecs->SpecsDirty) {
+            if (sortSpecs->SpecsCount > 0) {
+                viewModelBuilder.setSort((int)sortSpecs->Specs[0].ColumnUserID,
+                    sortSpecs->Specs[0].SortDirection == ImGuiSortDirection_Ascending);
+            }
+            else {
+                viewModelBuilder.setSort(-1, true);
+                // No sort column: back to API order
+            }
+            sortSpecs->SpecsDirty = false;
+        }
+    }
+    // Forward header clicks to the worker; the rows keep their old order until it publishes
+
+    const std::vector<JobRow>& rows = viewModel->rows;
+    ImGuiListClipper clipper;
+    clipper.Begin((int)rows.size());
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            const JobRow& row = rows[i];
+            const Job& job = *row.job;
+            ImGui::TableNextRow();
+            ImGui::PushID(row.jobIndex);
+
+            ImGui::TableSetColumnIndex(ViewModelBuilder::ColumnTitle);
+            if (ImGui::Selectable(job.title.c_str(), selectedJob == row.jobIndex,
+                ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap)) {
+                selectedJob = row.jobIndex;
+            }
+            // The title cell selects the whole row
+            if (row.similarCount > 0) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(%s)", row.similarText.c_str());
+            }
+
+            ImGui::TableSetColumnIndex(ViewModelBuilder::ColumnFavorite);
+            bool favorite = row.favorite;
+            if (ImGui::Checkbox("##fav", &favorite)) {
+                toggleFavorite(job);
+            }
+            // Submitted after the row selectable so the checkbox stays clickable
+
+            if (ImGui::TableSetColumnIndex(ViewModelBuilder::ColumnCompany)) ImGui::TextUnformatted(job.company.c_str());
+            if (ImGui::TableSetColumnIndex(ViewModelBuilder::ColumnLocation)) ImGui::TextUnformatted(job.location.c_str());
+            if (ImGui::TableSetColumnIndex(ViewModelBuilder::ColumnSalary)) ImGui::TextUnformatted(row.salaryText.c_str());
+            if (ImGui::TableSetColumnIndex(ViewModelBuilder::ColumnContractType)) ImGui::TextUnformatted(job.contractType.c_str());
+            if (ImGui::TableSetColumnIndex(ViewModelBuilder::ColumnCategory)) ImGui::TextUnformatted(job.category.c_str());
+
+            ImGui::PopID();
+        }
+    }
+    // Only the visible rows are submitted, so large result sets stay interactive
+
+    ImGui::EndTable();
+}
+
+void ResultsTable::renderFacets(const ResultsViewModel& viewModel) {
+    // Function to render one column of values per facet field; the counts were computed by the view-model worker
+    bool anySelected = false;
+    for (int field = 0; field < FacetCount; field++) {
+        anySelected = anySelected || !facetSelection.values[field].empty();
+    }
+
+    if (!ImGui::CollapsingHeader("Narrow results")) return;
+    if (anySelected) {
+        if (ImGui::SmallButton("Clear selection")) {
+            facetSelection = FacetSelection();
+            viewModelBuilder.setFacets(facetSelection);
+        }
+    }
+
+    if (!ImGui::BeginTable("Facets", FacetCount, ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchSame)) return;
+    for (int field = 0; field < FacetCount; field++) {
+        ImGui::TableSetupColumn(FacetEngine::getFieldName((FacetField)field));
+    }
+    ImGui::TableHeadersRow();
+
+    ImGui::TableNextRow();
+    for (int field = 0; field < FacetCount; field++) {
+        ImGui::TableSetColumnIndex(field);
+        ImGui::PushID(field);
+        for (const FacetValue& value : viewModel.facets[field]) {
+            if (ImGui::Selectable(value.text.c_str(), value.selected)) {
+                std::vector<std::string>& selected = facetSelection.values[field];
+                std::vector<std::string>::iterator found = std::find(selected.begin(), selected.end(), value.label);
+                if (found != selected.end()) {
+                    selected.erase(found);
+                }
+                else {
+                    selected.push_back(value.label);
+                }
+                viewModelBuilder.setFacets(facetSelection);
+                // Values of one field widen the results, values of different fields narrow them
+            }
+        }
+        ImGui::PopID();
+    }
+    ImGui::EndTable();
+}
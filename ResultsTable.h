@@ -0,0 +1,49 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include "ViewModelBuilder.h"
+// Includes the ViewModelBuilder header file - prepares the table rows on a worker thread
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <unordered_set>
+
+class ResultsTable {
+public:
+    ResultsTable();
+    // Constructor for the ResultsTable class
+
+    void setJobs(std::shared_ptr<const std::vector<Job>> jobs);
+    // Hands a new result snapshot to the table; rows are prepared on the view-model worker
+
+    void setFavorites(std::shared_ptr<const std::unordered_set<std::string>> favoriteUrls);
+    // Hands the current favorites set (job URLs) to the table
+
+    bool isUpToDate() const;
+    // Function to check whether the published view model belongs to the latest snapshot
+
+    void render(int& selectedJob, const std::function<void(const Job&)>& toggleFavorite);
+    // Renders the filter box and the sortable table by walking the prepared rows
+    // selectedJob is an index into the jobs snapshot passed to setJobs()
+
+private:
+    ViewModelBuilder viewModelBuilder;
+    // Builds the filtered, sorted and formatted rows off the UI thread
+
+    std::shared_ptr<const std::vector<Job>> jobs;
+    // Snapshot currently shown by the table
+
+    char filterBuffer[256];
+    // Text of the local filter box
+
+    bool collapseDuplicates;
+    // State of the "Collapse similar postings" checkbox
+
+    FacetSelection facetSelection;
+    // Facet values clicked in the facet panel
+
+    void renderFacets(const ResultsViewModel& viewModel);
+    // Renders the facet panel: the most frequent values of each field with their counts, clickable to narrow
+};
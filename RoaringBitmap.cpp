@@ -0,0 +1,334 @@
+#include "RoaringBitmap.h"
+// Includes the header file for the RoaringBitmap class
+
+#include <algorithm>
+// Includes std::lower_bound, std::binary_search and the sorted-range set operations
+
+#include <iterator>
+// Includes std::back_inserter
+
+#include <emmintrin.h>
+// Includes the SSE2 intrinsics for the bitmap-to-bitmap operations
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+// Includes _BitScanForward and __popcnt
+#endif
+
+namespace {
+    const size_t bitmapWords = 65536 / 64;
+    // Words of a bitmap container
+
+    enum WordOperation {
+        WordAnd,
+        WordOr,
+        WordAndNot
+    };
+    // Operation applied word by word to two bitmap containers
+
+    uint32_t countBits(uint64_t word) {
+        // Function to count the set bits of a word
+#if defined(_MSC_VER)
+        return __popcnt((unsigned int)word) + __popcnt((unsigned int)(word >> 32));
+        // Two 32-bit counts, since the 64-bit one does not exist in 32-bit builds
+#else
+        return (uint32_t)__builtin_popcountll(word);
+#endif
+    }
+
+    uint32_t combineWords(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b, std::vector<uint64_t>& out, WordOperation operation) {
+        // Function to combine two bitmaps two words per SSE2 instruction and count the bits of the result
+        out.resize(bitmapWords);
+        for (size_t word = 0; word < bitmapWords; word += 2) {
+            __m128i left = _mm_loadu_si128((const __m128i*)&a[word]);
+            __m128i right = _mm_loadu_si128((const __m128i*)&b[word]);
+            __m128i result;
+            if (operation == WordAnd) result = _mm_and_si128(left, right);
+            else if (operation == WordOr) result = _mm_or_si128(left, right);
+            else result = _mm_andnot_si128(right, left);
+            // _mm_andnot_si128 negates its first operand
+            _mm_storeu_si128((__m128i*)&out[word], result);
+        }
+        // The operation is the same for every word, so the branch is perfectly predicted
+
+        uint32_t cardinality = 0;
+        for (size_t word = 0; word < bitmapWords; word++) {
+            cardinality += countBits(out[word]);
+        }
+        return cardinality;
+    }
+
+    bool testBit(const std::vector<uint64_t>& bits, uint16_t low) {
+        return (bits[low >> 6] >> (low & 63)) & 1;
+    }
+}
+
+RoaringBitmap::RoaringBitmap() {
+    // Constructor for the RoaringBitmap class
+}
+
+int RoaringBitmap::lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanForward(&index, (unsigned long)word)) return (int)index;
+    _BitScanForward(&index, (unsigned long)(word >> 32));
+    return (int)index + 32;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+RoaringBitmap RoaringBitmap::fromSorted(const std::vector<uint32_t>& values) {
+    RoaringBitmap bitmap;
+    for (uint32_t value : values) {
+        bitmap.append(value);
+    }
+    return bitmap;
+}
+
+RoaringBitmap RoaringBitmap::range(uint32_t count) {
+    // Function to build [0, count) from full bitmap containers and a partial last one
+    RoaringBitmap bitmap;
+    for (uint32_t start = 0; start < count; start += 65536) {
+        Container container;
+        container.key = (uint16_t)(start >> 16);
+        container.cardinality = std::min<uint32_t>(65536, count - start);
+        if (container.cardinality <= arrayLimit) {
+            for (uint32_t low = 0; low < container.cardinality; low++) {
+                container.array.push_back((uint16_t)low);
+            }
+        }
+        else {
+            container.bits.assign(bitmapWords, 0);
+            for (uint32_t word = 0; word < container.cardinality / 64; word++) {
+                container.bits[word] = ~(uint64_t)0;
+            }
+            if (container.cardinality % 64 != 0) {
+                container.bits[container.cardinality / 64] = ((uint64_t)1 << (container.cardinality % 64)) - 1;
+            }
+        }
+        bitmap.containers.push_back(std::move(container));
+    }
+    return bitmap;
+}
+
+void RoaringBitmap::append(uint32_t value) {
+    // Function to add a value at the end of the last container, starting a new container at a new key
+    const uint16_t key = (uint16_t)(value >> 16);
+    const uint16_t low = (uint16_t)value;
+    if (containers.empty() || containers.back().key != key) {
+        Container container;
+        container.key = key;
+        container.cardinality = 0;
+        containers.push_back(std::move(container));
+    }
+
+    Container& container = containers.back();
+    if (container.isBitmap()) {
+        if (testBit(container.bits, low)) return;
+        container.bits[low >> 6] |= (uint64_t)1 << (low & 63);
+    }
+    else {
+        if (!container.array.empty() && container.array.back() >= low) return;
+        // Not greater than the last value: already present, since values arrive in order
+        container.array.push_back(low);
+    }
+    container.cardinality++;
+    if (!container.isBitmap() && container.cardinality > arrayLimit) {
+        toBitmap(container);
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    const uint16_t key = (uint16_t)(value >> 16);
+    const uint16_t low = (uint16_t)value;
+    std::vector<Container>::const_iterator found = std::lower_bound(containers.begin(), containers.end(), key,
+        [](const Container& container, uint16_t wanted) { return container.key < wanted; });
+    if (found == containers.end() || found->key != key) return false;
+    return found->isBitmap() ? testBit(found->bits, low) : std::binary_search(found->array.begin(), found->array.end(), low);
+}
+
+size_t RoaringBitmap::getCardinality() const {
+    size_t cardinality = 0;
+    for (const Container& container : containers) {
+        cardinality += container.cardinality;
+    }
+    return cardinality;
+}
+
+size_t RoaringBitmap::getSizeInBytes() const {
+    size_t bytes = sizeof(RoaringBitmap);
+    for (const Container& container : containers) {
+        bytes += sizeof(Container) + container.array.capacity() * sizeof(uint16_t) + container.bits.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+std::vector<uint32_t> RoaringBitmap::toVector() const {
+    std::vector<uint32_t> values;
+    values.reserve(getCardinality());
+    forEach([&values](uint32_t value) { values.push_back(value); });
+    return values;
+}
+
+void RoaringBitmap::toBitmap(Container& container) {
+    container.bits.assign(bitmapWords, 0);
+    for (uint16_t low : container.array) {
+        container.bits[low >> 6] |= (uint64_t)1 << (low & 63);
+    }
+    std::vector<uint16_t>().swap(container.array);
+}
+
+void RoaringBitmap::shrink(Container& container) {
+    if (!container.isBitmap() || container.cardinality > arrayLimit) return;
+    container.array.reserve(container.cardinality);
+    for (size_t word = 0; word < bitmapWords; word++) {
+        uint64_t bits = container.bits[word];
+        while (bits != 0) {
+            container.array.push_back((uint16_t)(word * 64 + lowestBit(bits)));
+            bits &= bits - 1;
+        }
+    }
+    std::vector<uint64_t>().swap(container.bits);
+}
+
+RoaringBitmap::Container RoaringBitmap::intersectContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        result.cardinality = combineWords(a.bits, b.bits, result.bits, WordAnd);
+        shrink(result);
+        return result;
+    }
+    if (a.isBitmap() != b.isBitmap()) {
+        const Container& sparse = a.isBitmap() ? b : a;
+        const Container& dense = a.isBitmap() ? a : b;
+        for (uint16_t low : sparse.array) {
+            if (testBit(dense.bits, low)) result.array.push_back(low);
+        }
+        // Probe the bitmap with each array value
+    }
+    else {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(result.array));
+    }
+    result.cardinality = (uint32_t)result.array.size();
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::uniteContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        result.cardinality = combineWords(a.bits, b.bits, result.bits, WordOr);
+        return result;
+    }
+    if (!a.isBitmap() && !b.isBitmap() && a.cardinality + b.cardinality <= arrayLimit) {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(result.array));
+        result.cardinality = (uint32_t)result.array.size();
+        return result;
+    }
+
+    const Container& sparse = a.isBitmap() ? b : a;
+    const Container& other = a.isBitmap() ? a : b;
+    result.bits = other.isBitmap() ? other.bits : std::vector<uint64_t>(bitmapWords, 0);
+    result.cardinality = other.isBitmap() ? other.cardinality : 0;
+    if (!other.isBitmap()) {
+        for (uint16_t low : other.array) {
+            result.bits[low >> 6] |= (uint64_t)1 << (low & 63);
+        }
+        result.cardinality = other.cardinality;
+    }
+    for (uint16_t low : sparse.array) {
+        if (!testBit(result.bits, low)) {
+            result.bits[low >> 6] |= (uint64_t)1 << (low & 63);
+            result.cardinality++;
+        }
+    }
+    // An array into a bitmap, or two arrays too big together for an array
+    shrink(result);
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::subtractContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        result.cardinality = combineWords(a.bits, b.bits, result.bits, WordAndNot);
+        shrink(result);
+        return result;
+    }
+    if (a.isBitmap()) {
+        result.bits = a.bits;
+        result.cardinality = a.cardinality;
+        for (uint16_t low : b.array) {
+            if (testBit(result.bits, low)) {
+                result.bits[low >> 6] &= ~((uint64_t)1 << (low & 63));
+                result.cardinality--;
+            }
+        }
+        shrink(result);
+        return result;
+    }
+    if (b.isBitmap()) {
+        for (uint16_t low : a.array) {
+            if (!testBit(b.bits, low)) result.array.push_back(low);
+        }
+    }
+    else {
+        std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(result.array));
+    }
+    result.cardinality = (uint32_t)result.array.size();
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& a, const RoaringBitmap& b) {
+    // Function to intersect the containers with matching keys
+    RoaringBitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.containers.size() && j < b.containers.size()) {
+        if (a.containers[i].key < b.containers[j].key) i++;
+        else if (a.containers[i].key > b.containers[j].key) j++;
+        else {
+            Container container = intersectContainers(a.containers[i++], b.containers[j++]);
+            if (container.cardinality > 0) result.containers.push_back(std::move(container));
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::unite(const RoaringBitmap& a, const RoaringBitmap& b) {
+    // Function to merge the container lists, uniting the containers with matching keys
+    RoaringBitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.containers.size() || j < b.containers.size()) {
+        if (j == b.containers.size() || (i < a.containers.size() && a.containers[i].key < b.containers[j].key)) {
+            result.containers.push_back(a.containers[i++]);
+        }
+        else if (i == a.containers.size() || a.containers[i].key > b.containers[j].key) {
+            result.containers.push_back(b.containers[j++]);
+        }
+        else {
+            result.containers.push_back(uniteContainers(a.containers[i++], b.containers[j++]));
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::subtract(const RoaringBitmap& a, const RoaringBitmap& b) {
+    // Function to remove from a's containers the values of b's containers with matching keys
+    RoaringBitmap result;
+    size_t j = 0;
+    for (size_t i = 0; i < a.containers.size(); i++) {
+        while (j < b.containers.size() && b.containers[j].key < a.containers[i].key) j++;
+        if (j < b.containers.size() && b.containers[j].key == a.containers[i].key) {
+            Container container = subtractContainers(a.containers[i], b.containers[j]);
+            if (container.cardinality > 0) result.containers.push_back(std::move(container));
+        }
+        else {
+            result.containers.push_back(a.containers[i]);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,100 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class RoaringBitmap {
+public:
+    RoaringBitmap();
+    // Constructor for an empty set
+
+    static RoaringBitmap fromSorted(const std::vector<uint32_t>& values);
+    // Function to build a set from values in ascending order
+
+    static RoaringBitmap range(uint32_t count);
+    // Function to build the set [0, count)
+
+    void append(uint32_t value);
+    // Function to add a value greater than every value in the set (how postings are built, in job order)
+
+    bool contains(uint32_t value) const;
+    // Function to check whether a value is in the set
+
+    size_t getCardinality() const;
+    // Number of values in the set
+
+    size_t getSizeInBytes() const;
+    // Memory used by the containers
+
+    std::vector<uint32_t> toVector() const;
+    // Function to list the values in ascending order
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const;
+    // Function to call visit(value) for every value in ascending order
+
+    static RoaringBitmap intersect(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap unite(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap subtract(const RoaringBitmap& a, const RoaringBitmap& b);
+    // AND, OR and AND NOT; dense containers are combined 128 bits per instruction
+
+private:
+    struct Container {
+        uint16_t key;
+        // High 16 bits of the values in the container
+        uint32_t cardinality;
+        // Number of values in the container
+        std::vector<uint16_t> array;
+        // Low 16 bits of the values, ascending, while there are at most arrayLimit of them
+        std::vector<uint64_t> bits;
+        // 65536-bit bitmap of the low 16 bits once there are more (array is then empty)
+
+        bool isBitmap() const { return !bits.empty(); }
+    };
+    // The values sharing their high 16 bits, stored sparse or dense, whichever is smaller
+
+    static const uint32_t arrayLimit = 4096;
+    // Above 4096 values (8 KB as an array) the 8 KB bitmap is as small and much faster
+
+    std::vector<Container> containers;
+    // Non-empty containers in key order
+
+    static int lowestBit(uint64_t word);
+    // Function to find the index of the lowest set bit of a non-zero word
+
+    static void toBitmap(Container& container);
+    // Function to convert an array container to a bitmap
+
+    static void shrink(Container& container);
+    // Function to convert a bitmap container that fell to arrayLimit values back to an array
+
+    static Container intersectContainers(const Container& a, const Container& b);
+    static Container uniteContainers(const Container& a, const Container& b);
+    static Container subtractContainers(const Container& a, const Container& b);
+    // Container-level operations for each combination of array and bitmap
+};
+// Compressed set of 32-bit integers in the layout of Roaring bitmaps: each 65536-value chunk is a sorted array
+// when sparse and a bitmap when dense (run-length containers are left out; job sets rarely have long runs)
+
+template <typename Visitor>
+void RoaringBitmap::forEach(Visitor visit) const {
+    for (const Container& container : containers) {
+        const uint32_t high = (uint32_t)container.key << 16;
+        if (container.isBitmap()) {
+            for (size_t word = 0; word < container.bits.size(); word++) {
+                uint64_t bits = container.bits[word];
+                while (bits != 0) {
+                    visit(high | (uint32_t)(word * 64 + lowestBit(bits)));
+                    bits &= bits - 1;
+                }
+            }
+        }
+        else {
+            for (uint16_t low : container.array) {
+                visit(high | low);
+            }
+        }
+    }
+}
@@ -0,0 +1,632 @@
+#include "SavedSearches.h"
+// Includes the header file for the SavedSearches class
+
+#include "SeenSet.h"
+// Includes the set of postings each saved search has seen
+
+#include "TimerWheel.h"
+// Includes the timer wheel the refreshes are scheduled on
+
+#include "Trace.h"
+// Includes the tracer, so the timer thread gets its own named timeline
+
+#include <algorithm>
+// Includes std::find_if and std::min
+
+#include <chrono>
+// Includes the steady clock the timer ticks on
+
+#include <cstdio>
+// Includes std::remove for destroy()
+
+#include <cstdlib>
+// Includes std::strtoull for the keys in the seen file
+
+#include <fstream>
+// Includes the file stream classes for saving and loading
+
+#include <iostream>
+// Includes std::cerr for a saved searches file that cannot be read
+
+#include <unordered_map>
+// Includes the map from stable keys to the saved searches, for loading
+
+#include <unordered_set>
+// Includes the set of postings of the refresh in flight
+
+#include <json.hpp>
+// Includes the JSON library for the saved searches file
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const size_t maxNewJobs = 500;
+    // Unread new postings kept per saved search; older ones are dropped first
+
+    const uint64_t maxTimerWaitSeconds = 60;
+    // Longest the timer sleeps, so a changed system clock or a lost wake-up costs at most a minute
+
+    const size_t maxSeenIds = 2 * SavedSearches::maxPages * SavedSearches::pageSize;
+    // Seen postings kept per saved search, newest first. A refresh stops at the newest posting it has seen, so
+    // only the latest ones are ever checked; twice what one refresh can read leaves room for postings taken down
+
+    std::string getSeenPath(const std::string& filename) {
+        // Function to get the file the seen postings are appended to: one "key<TAB>id" line per posting
+        return filename + ".seen";
+    }
+
+    std::string getJobsPath(const std::string& filename) {
+        // Function to get the file the unread new postings are written to, by saved search key
+        return filename + ".jobs";
+    }
+
+    const std::string& getKey(const Job& job) {
+        // Function to get what identifies a posting: its Adzuna id, or its URL if it has none
+        return job.id.empty() ? job.url : job.id;
+    }
+
+    nlohmann::json jobToJson(const Job& job) {
+        // Function to turn a job into the JSON object of a saved favorite, plus its created time
+        return {
+            {"id", job.id},
+            {"title", job.title},
+            {"company", job.company},
+            {"location", job.location},
+            {"description", job.description},
+            {"salary", job.salary},
+            {"salaryCurrency", job.salaryCurrency},
+            {"contractType", job.contractType},
+            {"category", job.category},
+            {"url", job.url},
+            {"created", job.created}
+        };
+    }
+
+    Job jobFromJson(const nlohmann::json& jobJson) {
+        // Function to read a job written by jobToJson
+        Job job;
+        job.id = jobJson.value("id", "");
+        job.title = jobJson.value("title", "");
+        job.company = jobJson.value("company", "");
+        job.location = jobJson.value("location", "");
+        job.description = jobJson.value("description", "");
+        job.salary = jobJson.value("salary", 0.0);
+        job.salaryCurrency = jobJson.value("salaryCurrency", "");
+        job.contractType = jobJson.value("contractType", "");
+        job.category = jobJson.value("category", "");
+        job.url = jobJson.value("url", "");
+        job.created = jobJson.value("created", "");
+        return job;
+    }
+}
+
+struct SavedSearches::Entry {
+    SavedSearchInfo info;
+    // What the UI sees of the search
+
+    uint64_t key;
+    // Identifier that is stable across sessions; links the search to its lines in the seen and new postings files
+
+    SeenSet seen;
+    // Postings shown by earlier refreshes, the latest maxSeenIds of them
+
+    std::vector<std::string> unsavedSeen;
+    // Seen postings not yet appended to the seen file
+
+    std::vector<Job> newJobs;
+    // New postings not yet taken, newest first
+
+    std::vector<Job> pending;
+    // New postings of the refresh in flight, added to seen once it finishes
+
+    std::unordered_set<std::string> pendingKeys;
+    // Keys of pending; a posting published during the refresh shifts the next page, repeating one already read
+
+    std::shared_ptr<SearchHandle> active;
+    // Request of the refresh in flight, if any
+
+    bool baseline;
+    // Whether the refresh in flight is the first: it takes one page and marks everything on it as seen
+};
+
+struct SavedSearches::State {
+    JobSearch& engine;
+    // Search engine the refreshes run on
+
+    const std::string filename;
+    // File the saved searches are written to
+
+    mutable std::mutex mutex;
+    // Mutex for the members below
+
+    std::condition_variable wake;
+    // Condition variable that wakes the timer when a refresh is scheduled or the object is destroyed
+
+    std::vector<std::unique_ptr<Entry>> entries;
+    // Saved searches, in the order they were added
+
+    TimerWheel wheel;
+    // Next refresh of each saved search, one tick per second
+
+    const Clock::time_point start;
+    // Time of tick 0
+
+    uint64_t nextId;
+    // Identifier of the next saved search
+
+    uint64_t nextKey;
+    // Stable key of the next saved search; above every key in the files, so stale seen lines never match it
+
+    bool stopping;
+    // Set by the destructor; refreshes still answering are dropped
+
+    bool savePending;
+    // Flag to indicate a change that has not been written
+
+    bool flushScheduled;
+    // Flag to indicate a save task is queued or running; saves never overlap
+
+    bool jobsPending;
+    // Flag to indicate the new postings changed since they were written
+
+    size_t seenLines;
+    // Lines in the seen file, including those of postings that were dropped or of searches that were removed
+
+    std::condition_variable flushed;
+    // Condition variable signalled when the save task finishes
+
+    std::atomic<size_t> version;
+    // Bumped on every change
+
+    State(JobSearch& engine, const std::string& filename)
+        : engine(engine), filename(filename), start(Clock::now()), nextId(1), nextKey(1), stopping(false), savePending(false),
+        flushScheduled(false), jobsPending(false), seenLines(0), version(0) {}
+
+    void schedule(uint64_t id, uint64_t delaySeconds) {
+        // Function to schedule a refresh from the current time; the wheel only advances when the timer wakes, so
+        // it may be behind
+        const uint64_t elapsed = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - start).count();
+        wheel.schedule(id, delaySeconds + (elapsed > wheel.getNow() ? elapsed - wheel.getNow() : 0));
+    }
+
+    Entry* find(uint64_t id) {
+        // Function to find a saved search by id, nullptr if it was removed
+        std::vector<std::unique_ptr<Entry>>::iterator found = std::find_if(entries.begin(), entries.end(),
+            [id](const std::unique_ptr<Entry>& entry) { return entry->info.id == id; });
+        return found == entries.end() ? nullptr : found->get();
+    }
+};
+
+SavedSearches::SavedSearches(JobSearch& engine, const std::string& filename) : state(std::make_shared<State>(engine, filename)) {
+    // Constructor for the SavedSearches class
+    bool migrate = false;
+    std::ifstream file(filename);
+    if (file.is_open() && file.peek() != std::ifstream::traits_type::eof()) {
+        try {
+            nlohmann::json j;
+            file >> j;
+            for (const nlohmann::json& searchJson : j) {
+                std::unique_ptr<Entry> entry(new Entry());
+                entry->info.id = state->nextId++;
+                entry->key = searchJson.value("key", (uint64_t)0);
+                entry->info.name = searchJson.value("name", "");
+                entry->info.request.query = searchJson.value("query", "");
+                entry->info.request.country = searchJson.value("country", "");
+                entry->info.request.salaryRange = searchJson.value("salaryRange", "Any");
+                entry->info.request.currencySymbol = searchJson.value("currencySymbol", "");
+                entry->info.intervalMinutes = std::max(1, searchJson.value("intervalMinutes", 60));
+                entry->info.lastRefresh = (std::time_t)searchJson.value("lastRefresh", (int64_t)0);
+                entry->info.refreshing = false;
+                entry->baseline = false;
+                for (const nlohmann::json& seenId : searchJson.value("seen", nlohmann::json::array())) {
+                    const std::string id = seenId.get<std::string>();
+                    if (entry->seen.insert(id)) entry->unsavedSeen.push_back(id);
+                }
+                for (const nlohmann::json& jobJson : searchJson.value("newJobs", nlohmann::json::array())) {
+                    entry->newJobs.push_back(jobFromJson(jobJson));
+                }
+                // A file written before the seen and new postings had files of their own
+                migrate = migrate || entry->key == 0 || !entry->unsavedSeen.empty() || !entry->newJobs.empty();
+                state->nextKey = std::max(state->nextKey, entry->key + 1);
+                state->entries.push_back(std::move(entry));
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Unable to read saved searches from " << filename << ": " << e.what() << std::endl;
+            state->entries.clear();
+        }
+    }
+
+    std::unordered_map<uint64_t, Entry*> byKey;
+    for (const std::unique_ptr<Entry>& entry : state->entries) {
+        if (entry->key != 0) byKey[entry->key] = entry.get();
+    }
+
+    std::ifstream seenFile(getSeenPath(filename));
+    std::string line;
+    while (std::getline(seenFile, line)) {
+        state->seenLines++;
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        const uint64_t key = std::strtoull(line.c_str(), nullptr, 10);
+        state->nextKey = std::max(state->nextKey, key + 1);
+        std::unordered_map<uint64_t, Entry*>::iterator found = byKey.find(key);
+        if (found != byKey.end()) {
+            found->second->seen.insert(line.substr(tab + 1));
+        }
+    }
+    // Lines of removed searches are skipped; the next compaction drops them
+
+    std::ifstream jobsFile(getJobsPath(filename));
+    if (jobsFile.is_open() && jobsFile.peek() != std::ifstream::traits_type::eof()) {
+        try {
+            nlohmann::json j;
+            jobsFile >> j;
+            for (nlohmann::json::const_iterator it = j.begin(); it != j.end(); ++it) {
+                std::unordered_map<uint64_t, Entry*>::iterator found = byKey.find(std::strtoull(it.key().c_str(), nullptr, 10));
+                if (found == byKey.end()) continue;
+                for (const nlohmann::json& jobJson : it.value()) {
+                    found->second->newJobs.push_back(jobFromJson(jobJson));
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Unable to read new postings from " << getJobsPath(filename) << ": " << e.what() << std::endl;
+        }
+    }
+
+    const std::time_t now = std::time(nullptr);
+    for (const std::unique_ptr<Entry>& entry : state->entries) {
+        if (entry->key == 0) entry->key = state->nextKey++;
+        entry->seen.trim(maxSeenIds);
+        entry->info.newCount = entry->newJobs.size();
+        entry->info.seenCount = entry->seen.size();
+
+        const std::time_t due = entry->info.lastRefresh + (std::time_t)entry->info.intervalMinutes * 60;
+        state->schedule(entry->info.id, due > now ? (uint64_t)(due - now) : 0);
+        // Refreshed when its interval has passed, counting the time the application was closed
+    }
+
+    if (migrate) {
+        state->jobsPending = true;
+        scheduleSave(state);
+    }
+    // Move the postings of an older file into their own files
+
+    timer = std::thread(&SavedSearches::runTimer, this);
+}
+
+SavedSearches::~SavedSearches() {
+    // Destructor for the SavedSearches class
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->stopping = true;
+        for (const std::unique_ptr<Entry>& entry : state->entries) {
+            if (entry->active) entry->active->cancel();
+            entry->active.reset();
+        }
+        // The handle holds the callback, which holds the state
+    }
+    state->wake.notify_all();
+    timer.join();
+
+    scheduleSave(state);
+    flush();
+    // Don't lose the seen postings on exit
+}
+
+uint64_t SavedSearches::add(const std::string& name, const SearchRequest& request, int intervalMinutes) {
+    // Function to add a saved search and refresh it on the next tick
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        std::unique_ptr<Entry> entry(new Entry());
+        id = entry->info.id = state->nextId++;
+        entry->key = state->nextKey++;
+        entry->info.name = name;
+        entry->info.request = request;
+        entry->info.intervalMinutes = std::max(1, intervalMinutes);
+        entry->info.lastRefresh = 0;
+        entry->info.newCount = 0;
+        entry->info.seenCount = 0;
+        entry->info.refreshing = false;
+        entry->baseline = false;
+        state->entries.push_back(std::move(entry));
+        state->schedule(id, 0);
+        state->version++;
+    }
+    state->wake.notify_all();
+    scheduleSave(state);
+    return id;
+}
+
+void SavedSearches::remove(uint64_t id) {
+    // Function to delete a saved search and its refresh timer
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        std::vector<std::unique_ptr<Entry>>::iterator found = std::find_if(state->entries.begin(), state->entries.end(),
+            [id](const std::unique_ptr<Entry>& entry) { return entry->info.id == id; });
+        if (found == state->entries.end()) return;
+        if ((*found)->active) (*found)->active->cancel();
+        state->jobsPending = state->jobsPending || !(*found)->newJobs.empty();
+        state->wheel.cancel(id);
+        state->entries.erase(found);
+        state->version++;
+    }
+    scheduleSave(state);
+}
+
+void SavedSearches::refreshNow(uint64_t id) {
+    // Function to move a saved search's timer to the next tick
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        Entry* entry = state->find(id);
+        if (!entry || entry->info.refreshing) return;
+        state->schedule(id, 0);
+    }
+    state->wake.notify_all();
+}
+
+std::vector<SavedSearchInfo> SavedSearches::list() const {
+    // Function to copy the saved searches for the UI
+    std::lock_guard<std::mutex> lock(state->mutex);
+    std::vector<SavedSearchInfo> infos;
+    infos.reserve(state->entries.size());
+    for (const std::unique_ptr<Entry>& entry : state->entries) {
+        infos.push_back(entry->info);
+    }
+    return infos;
+}
+
+std::shared_ptr<const std::vector<Job>> SavedSearches::takeNewJobs(uint64_t id) {
+    // Function to hand out the unread new postings of a saved search
+    std::shared_ptr<std::vector<Job>> jobs = std::make_shared<std::vector<Job>>();
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        Entry* entry = state->find(id);
+        if (!entry) return jobs;
+        state->jobsPending = state->jobsPending || !entry->newJobs.empty();
+        jobs->swap(entry->newJobs);
+        entry->info.newCount = 0;
+        state->version++;
+    }
+    scheduleSave(state);
+    return jobs;
+}
+
+size_t SavedSearches::getVersion() const {
+    return state->version.load(std::memory_order_acquire);
+}
+
+void SavedSearches::flush() {
+    // Function to wait for queued saves
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->flushed.wait(lock, [this] { return !state->flushScheduled; });
+}
+
+void SavedSearches::runTimer() {
+    // Function to advance the wheel once a second while a refresh is due soon, and start the due refreshes
+    Trace::setThreadName("Saved searches timer");
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->stopping) {
+        const uint64_t elapsed = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - state->start).count();
+        std::vector<uint64_t> due;
+        state->wheel.advance(elapsed - state->wheel.getNow(), due);
+        if (!due.empty()) {
+            lock.unlock();
+            for (uint64_t id : due) {
+                startRefresh(state, id);
+            }
+            lock.lock();
+            continue;
+        }
+        // Refreshes are started without the lock; their callbacks take it
+
+        const uint64_t wait = std::min(state->wheel.getTicksUntilNext(), maxTimerWaitSeconds);
+        state->wake.wait_until(lock, state->start + std::chrono::seconds(state->wheel.getNow() + wait));
+        // Sleeps until the next timer is due; add() and refreshNow() wake it early
+    }
+}
+
+void SavedSearches::startRefresh(const std::shared_ptr<State>& state, uint64_t id) {
+    // Function to start a refresh from the newest postings
+    SearchRequest request;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        Entry* entry = state->find(id);
+        if (!entry || entry->info.refreshing || state->stopping) return;
+        entry->info.refreshing = true;
+        entry->pending.clear();
+        entry->pendingKeys.clear();
+        entry->baseline = entry->seen.size() == 0;
+        state->version++;
+
+        request = entry->info.request;
+        request.page = 1;
+        request.resultsPerPage = pageSize;
+        request.sortByDate = true;
+    }
+    fetchPage(state, id, request);
+}
+
+void SavedSearches::fetchPage(const std::shared_ptr<State>& state, uint64_t id, const SearchRequest& request) {
+    // Function to request one page of a refresh and read it when it arrives
+    TRACE_SCOPE("SavedSearches::fetchPage", "saved");
+    std::shared_ptr<SearchHandle> handle = state->engine.searchJobs(request, [state, id](const SearchHandle& search, SearchEvent event) {
+        if (event != SearchEventFinished) return;
+
+        SearchRequest next = search.getRequest();
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            Entry* entry = state->find(id);
+            if (state->stopping || !entry || !entry->info.refreshing) return;
+            // Removed or shutting down while the request was out
+
+            if (search.getStatus() != SearchStatusSucceeded) {
+                finishRefresh(*state, *entry, search.getStatus() == SearchStatusCancelled ? "Cancelled" : search.getError());
+            }
+            else {
+                std::shared_ptr<const std::vector<Job>> jobs = search.getResults();
+                bool reachedSeen = false;
+                for (const Job& job : *jobs) {
+                    const std::string& key = getKey(job);
+                    if (entry->seen.contains(key)) {
+                        reachedSeen = true;
+                        break;
+                    }
+                    // Newest first: everything after the first posting seen before was seen too
+                    if (entry->pendingKeys.insert(key).second) {
+                        entry->pending.push_back(job);
+                    }
+                }
+
+                if (reachedSeen || entry->baseline || (int)jobs->size() < next.resultsPerPage || next.page >= maxPages) {
+                    finishRefresh(*state, *entry, std::string());
+                }
+                else {
+                    next.page++;
+                }
+                // Another page only if every posting on this one was new
+            }
+            entry->active.reset();
+        }
+
+        if (search.getRequest().page != next.page) {
+            fetchPage(state, id, next);
+        }
+        else {
+            state->wake.notify_all();
+            scheduleSave(state);
+        }
+        // The timer may be asleep past the refresh's new due tick
+    });
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    Entry* entry = state->find(id);
+    if (state->stopping) {
+        handle->cancel();
+    }
+    else if (entry && entry->info.refreshing && !handle->isDone()) {
+        entry->active = handle;
+    }
+    // Kept so removing the search or closing the application cancels the request
+}
+
+void SavedSearches::finishRefresh(State& state, Entry& entry, const std::string& error) {
+    // Function to end a refresh: mark its postings as seen, keep them as new and schedule the next refresh
+    for (const Job& job : entry.pending) {
+        if (entry.seen.insert(getKey(job))) entry.unsavedSeen.push_back(getKey(job));
+    }
+    entry.seen.trim(maxSeenIds);
+    state.jobsPending = state.jobsPending || !entry.pending.empty();
+    entry.newJobs.insert(entry.newJobs.begin(), entry.pending.begin(), entry.pending.end());
+    if (entry.newJobs.size() > maxNewJobs) {
+        entry.newJobs.resize(maxNewJobs);
+    }
+    entry.info.newCount = entry.newJobs.size();
+    entry.info.seenCount = entry.seen.size();
+    entry.pending.clear();
+    entry.pendingKeys.clear();
+    // A failed refresh keeps the postings of the pages it read
+
+    entry.info.error = error;
+    if (error.empty()) {
+        entry.info.lastRefresh = std::time(nullptr);
+    }
+    entry.info.refreshing = false;
+    entry.active.reset();
+    state.schedule(entry.info.id, (uint64_t)entry.info.intervalMinutes * 60);
+    state.version++;
+}
+
+void SavedSearches::scheduleSave(const std::shared_ptr<State>& state) {
+    // Function to queue a save of the saved searches
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->savePending = true;
+        if (state->flushScheduled) return;
+        // The running save writes the latest state when it finishes the current one
+        state->flushScheduled = true;
+    }
+    TaskScheduler::shared().submit([state]() {
+        while (true) {
+            nlohmann::json j = nlohmann::json::array();
+            nlohmann::json jobs = nlohmann::json::object();
+            bool writeJobs = false;
+            std::string seenLines;
+            bool compactSeen = false;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->savePending) {
+                    state->flushScheduled = false;
+                    state->flushed.notify_all();
+                    return;
+                }
+                state->savePending = false;
+
+                size_t liveSeen = 0;
+                size_t unsavedSeen = 0;
+                for (const std::unique_ptr<Entry>& entry : state->entries) {
+                    liveSeen += entry->seen.size();
+                    unsavedSeen += entry->unsavedSeen.size();
+                }
+                compactSeen = state->seenLines + unsavedSeen > 2 * liveSeen + maxSeenIds;
+                // Lines of dropped postings and removed searches pile up in the seen file; once they outnumber
+                // the live ones, it is written again from the sets
+
+                for (const std::unique_ptr<Entry>& entry : state->entries) {
+                    j.push_back({
+                        {"key", entry->key},
+                        {"name", entry->info.name},
+                        {"query", entry->info.request.query},
+                        {"country", entry->info.request.country},
+                        {"salaryRange", entry->info.request.salaryRange},
+                        {"currencySymbol", entry->info.request.currencySymbol},
+                        {"intervalMinutes", entry->info.intervalMinutes},
+                        {"lastRefresh", (int64_t)entry->info.lastRefresh}
+                    });
+
+                    const std::string prefix = std::to_string(entry->key) + "\t";
+                    for (const std::string& id : compactSeen ? entry->seen.getIds() : entry->unsavedSeen) {
+                        seenLines += prefix + id + "\n";
+                    }
+                    entry->unsavedSeen.clear();
+
+                    if (state->jobsPending && !entry->newJobs.empty()) {
+                        nlohmann::json newJobs = nlohmann::json::array();
+                        for (const Job& job : entry->newJobs) {
+                            newJobs.push_back(jobToJson(job));
+                        }
+                        jobs[std::to_string(entry->key)] = newJobs;
+                    }
+                }
+                state->seenLines = compactSeen ? liveSeen : state->seenLines + unsavedSeen;
+                writeJobs = state->jobsPending;
+                state->jobsPending = false;
+            }
+            // Take the latest state; only the newest of several quick changes is written. The seen postings are
+            // appended and the new postings written only when they changed, so a refresh that found nothing
+            // rewrites just the small list of searches
+
+            TRACE_SCOPE("SavedSearches::save", "saved");
+            if (compactSeen || !seenLines.empty()) {
+                std::ofstream seenFile(getSeenPath(state->filename), compactSeen ? std::ios::trunc : std::ios::app);
+                seenFile << seenLines;
+            }
+            if (writeJobs) {
+                std::ofstream jobsFile(getJobsPath(state->filename));
+                jobsFile << jobs.dump();
+            }
+            std::ofstream file(state->filename);
+            file << j.dump(4);
+        }
+    }, TaskPriorityLow);
+}
+
+bool SavedSearches::destroy(const std::string& filename) {
+    // Function to delete the saved searches files
+    bool removed = std::remove(filename.c_str()) == 0;
+    removed = std::remove(getSeenPath(filename).c_str()) == 0 || removed;
+    removed = std::remove(getJobsPath(filename).c_str()) == 0 || removed;
+    return removed;
+}
@@ -0,0 +1,105 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <ctime>
+#include <thread>
+// Includes the thread class for the timer that starts the refreshes
+#include "JobSearch.h"
+// Includes the JobSearch header file - runs the refresh requests
+
+struct SavedSearchInfo {
+    uint64_t id;
+    // Identifier of the saved search, stable for the session
+    std::string name;
+    // Label shown in the list
+    SearchRequest request;
+    // Query, country, salary range and currency of the search
+    int intervalMinutes;
+    // Time between refreshes
+    std::time_t lastRefresh;
+    // Time of the last successful refresh, 0 if it never ran
+    size_t newCount;
+    // Postings found by refreshes since the new jobs were last taken
+    size_t seenCount;
+    // Postings seen so far
+    bool refreshing;
+    // Whether a refresh is in flight
+    std::string error;
+    // Error of the last refresh, empty if it succeeded
+};
+// Snapshot of one saved search, for the UI
+
+class SavedSearches {
+public:
+    explicit SavedSearches(JobSearch& engine, const std::string& filename = "saved_searches.json");
+    // Constructor: loads the saved searches and starts the timer; each is refreshed when its interval has passed
+    // since its last refresh, so a search overdue while the application was closed is refreshed right away
+
+    ~SavedSearches();
+    // Destructor: stops the timer, cancels the refreshes in flight and writes the saved searches
+
+    uint64_t add(const std::string& name, const SearchRequest& request, int intervalMinutes);
+    // Function to save a search (request.country must be a single country); it is refreshed right away
+
+    void remove(uint64_t id);
+    // Function to delete a saved search
+
+    void refreshNow(uint64_t id);
+    // Function to refresh a saved search now instead of at its next interval
+
+    std::vector<SavedSearchInfo> list() const;
+    // Function to get every saved search, in the order they were added
+
+    std::shared_ptr<const std::vector<Job>> takeNewJobs(uint64_t id);
+    // Function to get the new postings found since the last call, newest first, and reset the search's count
+
+    size_t getVersion() const;
+    // Counter bumped whenever a saved search changes; a lock-free load, cheap enough to poll every frame
+
+    void flush();
+    // Function to wait until the last queued save is on disk
+
+    static bool destroy(const std::string& filename);
+    // Function to delete a saved searches file and the files kept next to it (seen postings and new postings)
+
+    static const int pageSize = 50;
+    // Postings per refresh request, the API's maximum
+
+    static const int maxPages = 10;
+    // Requests per refresh at most, if every posting on every page is new
+
+private:
+    struct Entry;
+    // One saved search with its seen postings (defined in SavedSearches.cpp)
+
+    struct State;
+    // Saved searches and timer wheel, shared with the refresh callbacks (defined in SavedSearches.cpp)
+
+    std::shared_ptr<State> state;
+    // Outlives this object while a refresh callback still runs
+
+    std::thread timer;
+    // Thread that advances the timer wheel and starts the due refreshes
+
+    void runTimer();
+    // Function that runs in the timer thread
+
+    static void startRefresh(const std::shared_ptr<State>& state, uint64_t id);
+    // Function to send the first request of a refresh
+
+    static void fetchPage(const std::shared_ptr<State>& state, uint64_t id, const SearchRequest& request);
+    // Function to send one date-sorted request of a refresh; its callback reads the page and fetches the next one
+    // only if every posting on it was new
+
+    static void finishRefresh(State& state, Entry& entry, const std::string& error);
+    // Function to record the postings a refresh found, schedule the next one and queue a save (state locked)
+
+    static void scheduleSave(const std::shared_ptr<State>& state);
+    // Function to write the saved searches as a low-priority task; saves queued while one is written are coalesced
+};
+// Saved searches refreshed in the background. A refresh asks for the newest postings first and stops at the first
+// posting it has already seen, so it costs one request plus one per 50 new postings, however many the search has
+// matched before
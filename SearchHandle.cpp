@@ -0,0 +1,87 @@
+#include "SearchHandle.h"
+// Includes the header file for the SearchHandle class
+
+SearchHandle::SearchHandle(const SearchRequest& request, SearchCallback callback)
+    : request(request), callback(std::move(callback)), status(SearchStatusQueued), cancelRequested(false),
+    bytesReceived(0), results(std::make_shared<const std::vector<Job>>()), httpStatus(0), attempts(0), queuedAt(std::chrono::steady_clock::now()) {
+    // Constructor for the SearchHandle class
+    for (double& ms : stageMs) ms = 0.0;
+}
+
+const SearchRequest& SearchHandle::getRequest() const {
+    return request;
+}
+
+SearchStatus SearchHandle::getStatus() const {
+    return (SearchStatus)status.load(std::memory_order_acquire);
+}
+
+bool SearchHandle::isDone() const {
+    // Function to check whether the search reached a final status
+    SearchStatus current = getStatus();
+    return current == SearchStatusSucceeded || current == SearchStatusFailed || current == SearchStatusCancelled;
+}
+
+void SearchHandle::wait() const {
+    // Function to block until the search is done
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [this] { return isDone(); });
+}
+
+bool SearchHandle::waitFor(int milliseconds) const {
+    // Function to block until the search is done or the timeout expires
+    std::unique_lock<std::mutex> lock(doneMutex);
+    return done.wait_for(lock, std::chrono::milliseconds(milliseconds), [this] { return isDone(); });
+}
+
+void SearchHandle::cancel() {
+    cancelRequested.store(true, std::memory_order_relaxed);
+}
+
+bool SearchHandle::isCancelRequested() const {
+    return cancelRequested.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const std::vector<Job>> SearchHandle::getResults() const {
+    // Function to get the jobs found; the outcome fields are only written before the final status is published
+    if (!isDone()) return std::make_shared<const std::vector<Job>>();
+    return results;
+}
+
+std::string SearchHandle::getError() const {
+    return isDone() ? error : std::string();
+}
+
+int SearchHandle::getHttpStatus() const {
+    return isDone() ? httpStatus : 0;
+}
+
+size_t SearchHandle::getBytesReceived() const {
+    return bytesReceived.load(std::memory_order_relaxed);
+}
+
+double SearchHandle::getStageMs(SearchStage stage) const {
+    return isDone() ? stageMs[stage] : 0.0;
+}
+
+int SearchHandle::getAttemptCount() const {
+    return isDone() ? attempts : 0;
+}
+
+void SearchHandle::notify(SearchEvent event) {
+    // Function to report a progress event
+    if (callback) {
+        callback(*this, event);
+    }
+}
+
+void SearchHandle::finish(SearchStatus finalStatus) {
+    // Function to publish the outcome of the search
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        status.store(finalStatus, std::memory_order_release);
+        // Release order: readers that see the final status also see the outcome fields
+    }
+    done.notify_all();
+    notify(SearchEventFinished);
+}
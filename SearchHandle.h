@@ -0,0 +1,161 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include "Job.h"
+// Includes the Job header file - contains the Job struct definition
+#include "Profiler.h"
+// Includes the SearchStage enum used for the per-search timings
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <mutex>
+// Includes the mutex class used by wait()
+#include <condition_variable>
+// Includes the condition_variable class used by wait()
+#include <atomic>
+// Includes the atomic class for the lock-free status checks
+#include <chrono>
+// Includes the steady clock used for the queue time
+
+struct SearchRequest {
+    SearchRequest() : salaryRange("Any"), resultsPerPage(20), page(1), sortByDate(false), maxDaysOld(0) {}
+    // Defaults: any salary, 20 results, first page, by relevance, postings of any age
+
+    std::string query;
+    // Job title to search for
+    std::string country;
+    // Adzuna country code
+    std::string salaryRange;
+    // "Any", "min-max" or "100000+"
+    int resultsPerPage;
+    // Number of results to fetch
+    int page;
+    // Page of the results to fetch, starting at 1
+    std::string currencySymbol;
+    // Currency shown next to the salaries
+    bool sortByDate;
+    // Newest postings first instead of the API's relevance order
+    int maxDaysOld;
+    // Only postings from the last maxDaysOld days; 0 for no limit
+};
+// Parameters of one search
+
+enum SearchStatus {
+    SearchStatusQueued,
+    // Waiting for a worker
+    SearchStatusRunning,
+    // Request in progress
+    SearchStatusSucceeded,
+    // Results are available
+    SearchStatusFailed,
+    // The request or the parsing failed; see getError()
+    SearchStatusCancelled
+    // Cancelled before it finished
+};
+// Life cycle of a search
+
+enum SearchEvent {
+    SearchEventStarted,
+    // A worker picked the search up
+    SearchEventHeadersReceived,
+    // The response headers arrived
+    SearchEventDataReceived,
+    // Another chunk of the response body arrived; see getBytesReceived()
+    SearchEventFinished
+    // The search succeeded, failed or was cancelled; see getStatus()
+};
+// Progress events reported to the search callback
+
+class SearchHandle;
+
+typedef std::function<void(const SearchHandle& search, SearchEvent event)> SearchCallback;
+// Progress callback of a search; called on the worker running the search, so it must not touch the UI
+// SearchEventFinished is reported right after the final status is published, so wait() may return before it
+
+class SearchHandle {
+public:
+    SearchHandle(const SearchRequest& request, SearchCallback callback);
+    // Constructor for a queued search
+
+    const SearchRequest& getRequest() const;
+    // The parameters of this search
+
+    SearchStatus getStatus() const;
+    // Current status; a lock-free load, cheap enough to poll every frame
+
+    bool isDone() const;
+    // Function to check whether the search succeeded, failed or was cancelled
+
+    void wait() const;
+    // Blocks until the search is done
+
+    bool waitFor(int milliseconds) const;
+    // Blocks until the search is done or the timeout expires; returns isDone()
+
+    void cancel();
+    // Asks the search to stop; a download in progress is aborted at the next chunk
+
+    bool isCancelRequested() const;
+    // Function to check whether cancel() was called
+
+    std::shared_ptr<const std::vector<Job>> getResults() const;
+    // The jobs found (empty until the search succeeded); immutable and safe to keep after the handle is gone
+
+    std::string getError() const;
+    // Description of the failure, empty unless the search failed
+
+    int getHttpStatus() const;
+    // HTTP status of the response, 0 if no response arrived
+
+    size_t getBytesReceived() const;
+    // Size of the response body received so far
+
+    double getStageMs(SearchStage stage) const;
+    // Time spent in a stage of this search, valid once the search is done
+
+    int getAttemptCount() const;
+    // Number of requests sent for this search, including retries; valid once the search is done
+
+private:
+    friend class JobSearch;
+    // The search engine drives the handle through its life cycle
+
+    const SearchRequest request;
+    // Parameters of the search
+
+    const SearchCallback callback;
+    // Optional progress callback
+
+    std::atomic<int> status;
+    // SearchStatus of the search
+
+    std::atomic<bool> cancelRequested;
+    // Set by cancel()
+
+    std::atomic<size_t> bytesReceived;
+    // Size of the response body received so far
+
+    std::shared_ptr<const std::vector<Job>> results;
+    std::string error;
+    int httpStatus;
+    double stageMs[SearchStageCount];
+    int attempts;
+    // Outcome of the search; written before the final status is stored, read only after isDone()
+
+    std::chrono::steady_clock::time_point queuedAt;
+    // Time the search was requested, for the queue wait stage
+
+    mutable std::mutex doneMutex;
+    // Mutex for wait()
+
+    mutable std::condition_variable done;
+    // Condition variable signalled when the search is done
+
+    void notify(SearchEvent event);
+    // Calls the progress callback, if any
+
+    void finish(SearchStatus finalStatus);
+    // Publishes the outcome, wakes waiters and reports SearchEventFinished
+};
@@ -0,0 +1,109 @@
+#include "SeenSet.h"
+// Includes the header file for the SeenSet class
+
+#include <algorithm>
+// Includes std::max
+
+namespace {
+    const int hashCount = 7;
+    // Bits set per id; with 16 bits per id the false positive rate is below 0.1%
+
+    uint64_t hashId(const std::string& id) {
+        // Function to hash an id with 64-bit FNV-1a, then mix the bits so both halves are usable
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : id) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+}
+
+SeenSet::SeenSet(size_t expectedCount) : capacity(0) {
+    // Constructor for the SeenSet class
+    resize(std::max<size_t>(expectedCount, 64));
+}
+
+bool SeenSet::insert(const std::string& id) {
+    // Function to add an id to the exact set and the filter
+    std::pair<std::unordered_set<std::string>::iterator, bool> inserted = ids.insert(id);
+    if (!inserted.second) return false;
+    order.push_back(&*inserted.first);
+    if (ids.size() > capacity) {
+        resize(capacity * 2);
+    }
+    else {
+        addToFilter(hashId(id));
+    }
+    return true;
+}
+
+bool SeenSet::contains(const std::string& id) const {
+    // Function to check the filter first and the exact ids only on a hit
+    return mayContain(hashId(id)) && ids.count(id) != 0;
+}
+
+size_t SeenSet::size() const {
+    return ids.size();
+}
+
+size_t SeenSet::trim(size_t maxCount) {
+    // Function to forget the oldest ids
+    size_t dropped = 0;
+    while (order.size() > maxCount) {
+        ids.erase(ids.find(*order.front()));
+        order.pop_front();
+        dropped++;
+    }
+    if (dropped > 0) {
+        resize(capacity);
+    }
+    // A Bloom filter cannot remove an id, so it is rebuilt from the ids that are left
+    return dropped;
+}
+
+std::vector<std::string> SeenSet::getIds() const {
+    // Function to copy the ids, oldest first
+    std::vector<std::string> result;
+    result.reserve(order.size());
+    for (const std::string* id : order) {
+        result.push_back(*id);
+    }
+    return result;
+}
+
+size_t SeenSet::getFilterBytes() const {
+    return bits.size() * sizeof(uint64_t);
+}
+
+void SeenSet::resize(size_t newCapacity) {
+    // Function to rebuild the filter for more ids
+    capacity = newCapacity;
+    bits.assign((capacity * 16 + 63) / 64, 0);
+    for (const std::string& id : ids) {
+        addToFilter(hashId(id));
+    }
+}
+
+void SeenSet::addToFilter(uint64_t hash) {
+    // Function to set the bits of an id (double hashing: bit i is h1 + i * h2)
+    const uint64_t bitCount = bits.size() * 64;
+    const uint64_t step = (hash >> 32) | 1;
+    for (int i = 0; i < hashCount; i++) {
+        const uint64_t bit = (hash + i * step) % bitCount;
+        bits[bit / 64] |= 1ull << (bit % 64);
+    }
+}
+
+bool SeenSet::mayContain(uint64_t hash) const {
+    // Function to test the bits of an id; any clear bit means it was never added
+    const uint64_t bitCount = bits.size() * 64;
+    const uint64_t step = (hash >> 32) | 1;
+    for (int i = 0; i < hashCount; i++) {
+        const uint64_t bit = (hash + i * step) % bitCount;
+        if (!(bits[bit / 64] & (1ull << (bit % 64)))) return false;
+    }
+    return true;
+}
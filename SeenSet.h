@@ -0,0 +1,56 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <cstdint>
+
+class SeenSet {
+public:
+    explicit SeenSet(size_t expectedCount = 1024);
+    // Constructor for an empty set sized for expectedCount ids; it grows past that on its own
+
+    bool insert(const std::string& id);
+    // Function to add an id; false if it was already in the set
+
+    bool contains(const std::string& id) const;
+    // Function to check for an id; exact, the filter only spares the lookup for ids never seen
+
+    size_t size() const;
+    // Number of ids in the set
+
+    size_t trim(size_t maxCount);
+    // Function to drop the oldest ids until at most maxCount are left; returns how many were dropped
+
+    std::vector<std::string> getIds() const;
+    // The ids in the order they were added, oldest first, for saving the set
+
+    size_t getFilterBytes() const;
+    // Size of the Bloom filter
+
+private:
+    std::vector<uint64_t> bits;
+    // Bloom filter over the ids, 16 bits per id at the sized capacity
+
+    size_t capacity;
+    // Number of ids the filter is sized for; past it the filter is rebuilt twice as large
+
+    std::unordered_set<std::string> ids;
+    // Every id exactly, so a false positive of the filter never hides a new job
+
+    std::deque<const std::string*> order;
+    // The ids in ids, oldest first (elements of an unordered_set keep their address when it rehashes)
+
+    void resize(size_t newCapacity);
+    // Function to size the filter for newCapacity ids and add the ids to it again
+
+    void addToFilter(uint64_t hash);
+    // Function to set the bits of a hashed id
+
+    bool mayContain(uint64_t hash) const;
+    // Function to test the bits of a hashed id
+};
+// Set of the job ids a saved search has already shown. Most ids a refresh checks are new, and the filter answers
+// those from a few cache lines without hashing into the exact set; a hit is confirmed against the exact ids
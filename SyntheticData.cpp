@@ -0,0 +1,214 @@
+#include "SyntheticData.h"
+// Includes the header file for the synthetic data generators
+
+#include <random>
+// Includes the random number generators and distributions
+
+#include <algorithm>
+// Includes std::min and std::max
+
+#include <json.hpp>
+// Includes the JSON library for the synthetic API responses
+
+#include <string>
+#include <cctype>
+#include <cstdio>
+
+namespace {
+    const int64_t syntheticNewest = 1717200000;
+    // Posting time of the first synthetic job, 2024-06-01T00:00:00Z
+
+    const char* const titleWords[] = {
+        "Senior", "Junior", "Lead", "Principal", "Software", "Data", "Backend", "Frontend", "Full Stack",
+        "Engineer", "Developer", "Analyst", "Manager", "Nurse", "Teacher", "Accountant", "Sales", "Marketing",
+        "Executive", "Assistant", "Consultant", "Technician", "Support", "Customer", "Service", "Warehouse",
+        "Operative", "C++", "Java", "Python", "Cloud", "DevOps", "Security", "Product", "Project", "Graduate"
+    };
+    const char* const companyWords[] = {
+        "Global", "Recruitment", "Solutions", "Group", "Partners", "Tech", "Systems", "Healthcare", "Logistics",
+        "Consulting", "Services", "Digital", "Ltd", "Inc", "Agency", "Talent", "People", "Resourcing"
+    };
+    const char* const cities[] = {
+        // Non-ASCII names are written as UTF-8 escapes so the source encoding does not matter
+        "London", "Manchester", "Birmingham", "Leeds", "Bristol", "Glasgow", "Edinburgh", "Cardiff", "Berlin",
+        "M\xC3\xBCnchen", "Paris", "Sydney", "Toronto", "New York", "\xD0\x9C\xD0\xBE\xD1\x81\xD0\xBA\xD0\xB2\xD0\xB0", "Warszawa", "S\xC3\xA3o Paulo", "Z\xC3\xBCrich"
+    };
+    const char* const regions[] = {
+        "Greater London", "North West England", "West Midlands", "Yorkshire", "South West England", "Scotland",
+        "Wales", "Bayern", "\xC3\x8Ele-de-France", "New South Wales", "Ontario", "New York State"
+    };
+    const char* const descriptionWords[] = {
+        "We", "are", "looking", "for", "an", "experienced", "candidate", "to", "join", "our", "growing", "team",
+        "the", "role", "will", "involve", "working", "with", "clients", "and", "stakeholders", "across", "business",
+        "you", "must", "have", "excellent", "communication", "skills", "strong", "knowledge", "of", "modern",
+        "tools", "competitive", "salary", "benefits", "pension", "flexible", "hybrid", "remote", "office", "apply",
+        "today", "opportunity", "responsible", "delivering", "high", "quality", "projects", "on", "time"
+    };
+    const char* const categories[] = {
+        "IT Jobs", "Healthcare & Nursing Jobs", "Sales Jobs", "Accounting & Finance Jobs", "Engineering Jobs",
+        "Teaching Jobs", "Logistics & Warehouse Jobs", "Customer Services Jobs", "Admin Jobs", "Retail Jobs",
+        "Hospitality & Catering Jobs", "Legal Jobs", "Scientific & QA Jobs", "Unknown"
+    };
+    const char* const contractTypes[] = { "permanent", "contract", "Not specified" };
+    const char* const currencies[] = { "GBP", "EUR", "USD", "AUD", "CAD" };
+
+    template <size_t N>
+    const char* pick(const char* const (&words)[N], std::mt19937& rng) {
+        return words[std::uniform_int_distribution<size_t>(0, N - 1)(rng)];
+    }
+    // Picks a random word from a fixed word list
+
+    template <size_t N>
+    std::string words(const char* const (&list)[N], size_t targetLength, std::mt19937& rng) {
+        std::string text;
+        while (text.size() < targetLength) {
+            if (!text.empty()) text += ' ';
+            text += pick(list, rng);
+        }
+        return text;
+    }
+    // Joins random words until the text reaches the target length
+
+    size_t lengthFrom(std::lognormal_distribution<double>& distribution, size_t minimum, size_t maximum, std::mt19937& rng) {
+        return std::min(maximum, std::max(minimum, (size_t)distribution(rng)));
+    }
+    // Draws a field length from a log-normal distribution, clamped to a sensible range
+}
+
+std::string formatTimestamp(int64_t seconds) {
+    // Function to format a time as the API does, without the C library's time zone handling
+    const int64_t days = (seconds >= 0 ? seconds : seconds - 86399) / 86400;
+    const int64_t secondOfDay = seconds - days * 86400;
+
+    const int64_t shifted = days + 719468;
+    const int64_t era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    const int64_t dayOfEra = shifted - era * 146097;
+    const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    const int day = (int)(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    const int month = (int)(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    const int year = (int)(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+    // Civil date of a day count (Howard Hinnant's days-to-civil algorithm)
+
+    char text[32];
+    std::snprintf(text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02dZ", year, month, day,
+        (int)(secondOfDay / 3600), (int)(secondOfDay / 60 % 60), (int)(secondOfDay % 60));
+    return text;
+}
+
+std::vector<Job> generateJobs(size_t count, uint32_t seed) {
+    // Function to generate synthetic jobs
+    std::mt19937 rng(seed);
+    std::lognormal_distribution<double> titleLength(3.4, 0.35);
+    // Titles are mostly 20-50 characters
+    std::lognormal_distribution<double> companyLength(2.8, 0.4);
+    // Company names are mostly 10-25 characters
+    std::lognormal_distribution<double> descriptionLength(5.9, 0.3);
+    // Adzuna returns description snippets of up to ~500 characters
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> salaryBand(18, 150);
+
+    std::vector<Job> jobs;
+    jobs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Job job;
+        job.id = std::to_string(4000000000ULL + i);
+        // The id makeAdzunaResult gives the job at this position, as in the simulator's corpus
+        job.title = words(titleWords, lengthFrom(titleLength, 8, 120, rng), rng);
+        job.company = words(companyWords, lengthFrom(companyLength, 3, 60, rng), rng);
+        job.location = std::string(pick(cities, rng)) + ", " + pick(regions, rng);
+        job.description = words(descriptionWords, lengthFrom(descriptionLength, 80, 520, rng), rng) + "...";
+        job.salary = unit(rng) < 0.3 ? 0.0 : salaryBand(rng) * 1000.0;
+        // Roughly a third of real listings have no salary
+        job.salaryCurrency = pick(currencies, rng);
+        job.contractType = pick(contractTypes, rng);
+        job.category = pick(categories, rng);
+        job.url = "https://www.adzuna.co.uk/jobs/land/ad/" + std::to_string(4000000000ULL + i) +
+            "?se=synthetic&utm_medium=api&utm_source=benchmark&v=" + std::to_string(rng());
+        // URLs are unique, like the real ones, since favorites are identified by URL
+        job.created = formatTimestamp(syntheticNewest - (int64_t)i * 600);
+        // Ten minutes apart, the first job the newest
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+void addReposts(std::vector<Job>& jobs, double fraction, uint32_t seed) {
+    // Function to append reworded copies of some of the jobs
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const size_t originals = jobs.size();
+    for (size_t i = 0; i < originals; i++) {
+        if (unit(rng) >= fraction) continue;
+        Job repost = jobs[i];
+        repost.company = words(companyWords, 12, rng);
+        std::string& description = repost.description;
+        size_t wordStart = description.find(' ', std::uniform_int_distribution<size_t>(0, description.size() / 2)(rng));
+        if (wordStart != std::string::npos) {
+            size_t wordEnd = description.find(' ', wordStart + 1);
+            description.replace(wordStart + 1, (wordEnd == std::string::npos ? description.size() : wordEnd) - wordStart - 1, pick(descriptionWords, rng));
+        }
+        // One word of the first half replaced
+        repost.id = std::to_string(5000000000ULL + i);
+        repost.url = "https://www.adzuna.co.uk/jobs/land/ad/" + std::to_string(5000000000ULL + i) +
+            "?se=synthetic&utm_medium=api&utm_source=benchmark&v=" + std::to_string(rng());
+        jobs.push_back(std::move(repost));
+    }
+}
+
+std::vector<Job> sampleFavorites(const std::vector<Job>& jobs, double fraction, uint32_t seed) {
+    // Function to pick a random subset of jobs as favorites
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Job> favorites;
+    for (const Job& job : jobs) {
+        if (unit(rng) < fraction) {
+            favorites.push_back(job);
+        }
+    }
+    return favorites;
+}
+
+std::string makeAdzunaResult(const Job& job, size_t id) {
+    // Function to serialize a job the way the Adzuna API returns it
+    std::string tag;
+    for (char c : job.category) {
+        if (std::isalnum((unsigned char)c)) tag += (char)std::tolower((unsigned char)c);
+        else if (!tag.empty() && tag.back() != '-') tag += '-';
+    }
+    // Category tags are the lowercase label with dashes ("IT Jobs" -> "it-jobs")
+
+    nlohmann::json result = {
+        {"__CLASS__", "Adzuna::API::Response::Job"},
+        {"id", job.id.empty() ? std::to_string(4000000000ULL + id) : job.id},
+        {"title", job.title},
+        {"description", job.description},
+        {"company", {{"__CLASS__", "Adzuna::API::Response::Company"}, {"display_name", job.company}}},
+        {"location", {{"__CLASS__", "Adzuna::API::Response::Location"}, {"display_name", job.location}}},
+        {"category", {{"__CLASS__", "Adzuna::API::Response::Category"}, {"label", job.category}, {"tag", tag}}},
+        {"redirect_url", job.url},
+        {"created", job.created.empty() ? "2024-01-01T00:00:00Z" : job.created}
+    };
+    if (job.salary > 0.0) {
+        result["salary_min"] = job.salary;
+        result["salary_max"] = job.salary;
+    }
+    if (job.contractType != "Not specified") {
+        result["contract_type"] = job.contractType;
+    }
+    // Optional fields are left out, as in real responses
+    return result.dump();
+}
+
+std::string makeSearchResponse(const std::vector<Job>& jobs) {
+    // Function to build a search response body around the serialized jobs
+    std::string body = "{\"__CLASS__\":\"Adzuna::API::Response::JobSearchResults\",\"count\":" + std::to_string(jobs.size()) +
+        ",\"mean\":0,\"results\":[";
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (i > 0) body += ',';
+        body += makeAdzunaResult(jobs[i], i);
+    }
+    body += "]}";
+    return body;
+}
@@ -0,0 +1,31 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include "Job.h"
+// Includes the Job header file - contains the Job struct definition
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+std::vector<Job> generateJobs(size_t count, uint32_t seed);
+// Generates synthetic job listings with field lengths similar to real Adzuna results
+// The same seed always produces the same jobs, so benchmark runs are comparable
+// They were posted ten minutes apart, the first one the newest
+
+void addReposts(std::vector<Job>& jobs, double fraction, uint32_t seed);
+// Appends near-duplicates of a random fraction of the jobs: the same posting from another agency, with a new URL
+// and company and a few words of the description changed, as Adzuna often returns
+
+std::vector<Job> sampleFavorites(const std::vector<Job>& jobs, double fraction, uint32_t seed);
+// Picks a random subset of the jobs to use as synthetic favorites
+
+std::string formatTimestamp(int64_t seconds);
+// Formats seconds since 1970 as an ISO 8601 UTC time, like the created field of the API ("2024-06-01T00:00:00Z")
+
+std::string makeAdzunaResult(const Job& job, size_t id);
+// Serializes a job as one object of the "results" array of an Adzuna search response, with the job's own id
+// (a number made from id if it has none)
+
+std::string makeSearchResponse(const std::vector<Job>& jobs);
+// Builds a complete Adzuna search response body for the jobs, as parsed by JobSearch
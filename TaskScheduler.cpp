@@ -0,0 +1,291 @@
+#include "TaskScheduler.h"
+// Includes the header file for the TaskScheduler class
+
+#include "Trace.h"
+// Includes the tracer, so each worker gets its own named timeline
+
+#include <algorithm>
+// Includes std::max and std::min
+
+#include <iostream>
+// Includes the standard streams for reporting failed tasks
+
+#include <stdexcept>
+// Includes the standard exception classes
+
+namespace {
+    thread_local const TaskScheduler* currentScheduler = nullptr;
+    thread_local int currentWorker = -1;
+    // Pool and index of the calling worker thread
+
+    const char* const workerNames[] = {
+        "Worker 1", "Worker 2", "Worker 3", "Worker 4", "Worker 5", "Worker 6", "Worker 7", "Worker 8",
+        "Worker 9", "Worker 10", "Worker 11", "Worker 12", "Worker 13", "Worker 14", "Worker 15", "Worker 16"
+    };
+    // Names of the workers in traces; literals, because the tracer keeps the pointer after the pool is gone
+}
+
+TaskScheduler::TaskScheduler(unsigned workerCount) : pendingTasks(0), stopWorkers(false), nextQueue(0), stopTimer(false) {
+    // Constructor for the TaskScheduler class
+    if (workerCount == 0) {
+        workerCount = std::max(2u, std::thread::hardware_concurrency());
+        // Search requests block a worker on the network, so keep at least one more for everything else
+    }
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    // Queues exist before any worker starts
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers.push_back(std::thread(&TaskScheduler::workerFunction, this, i));
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    // Destructor: stop the workers and wait for them to finish
+    {
+        std::lock_guard<std::mutex> lock(timerMutex);
+        stopTimer = true;
+    }
+    timerWake.notify_all();
+    if (timer.joinable()) {
+        timer.join();
+    }
+    // The timer hands its remaining tasks to the workers first, so they are run like the other queued tasks
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopWorkers = true;
+    }
+    cv.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+TaskScheduler& TaskScheduler::shared() {
+    // Function to get the application-wide scheduler, created on first use
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+void TaskScheduler::submit(std::function<void()> task, TaskPriority priority) {
+    // Function to queue a task
+    int self = currentWorkerIndex();
+    unsigned target = self >= 0 ? (unsigned)self : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    // Workers keep their own tasks local (hot caches); other threads spread tasks round-robin
+
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks[priority].push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingTasks++;
+    }
+    cv.notify_one();
+    // Counted under the sleep mutex so a worker that is about to park cannot miss the task
+}
+
+void TaskScheduler::submitAfter(std::chrono::steady_clock::duration delay, std::function<void()> task, TaskPriority priority) {
+    // Function to queue a task once a delay has passed
+    {
+        std::lock_guard<std::mutex> lock(timerMutex);
+        if (!stopTimer) {
+            DelayedTask delayed;
+            delayed.task = std::move(task);
+            delayed.priority = priority;
+            delayedTasks.insert(std::make_pair(std::chrono::steady_clock::now() + delay, std::move(delayed)));
+            if (!timer.joinable()) {
+                timer = std::thread(&TaskScheduler::timerFunction, this);
+            }
+            timerWake.notify_one();
+            return;
+        }
+    }
+    submit(std::move(task), priority);
+    // The scheduler is shutting down: the task is queued right away rather than dropped
+}
+
+void TaskScheduler::timerFunction() {
+    // Function to submit the delayed tasks when they are due
+    Trace::setThreadName("Scheduler timer");
+    std::unique_lock<std::mutex> lock(timerMutex);
+    while (true) {
+        while (!delayedTasks.empty() && (stopTimer || delayedTasks.begin()->first <= std::chrono::steady_clock::now())) {
+            DelayedTask due = std::move(delayedTasks.begin()->second);
+            delayedTasks.erase(delayedTasks.begin());
+            lock.unlock();
+            submit(std::move(due.task), due.priority);
+            lock.lock();
+        }
+        // Submitted without the lock, so a task can delay itself again right away
+
+        if (stopTimer) break;
+
+        if (delayedTasks.empty()) {
+            timerWake.wait(lock);
+        }
+        else {
+            timerWake.wait_until(lock, delayedTasks.begin()->first);
+        }
+        // Sleep until the earliest task is due; submitAfter() and the destructor wake it early
+    }
+}
+
+bool TaskScheduler::runPendingTask(TaskPriority priority) {
+    // Function to run one queued task of the given priority on the calling thread
+    std::function<void()> task;
+    if (!takeTask(currentWorkerIndex(), priority, priority, task)) {
+        return false;
+    }
+    runTask(task);
+    return true;
+}
+
+unsigned TaskScheduler::getWorkerCount() const {
+    return (unsigned)workers.size();
+}
+
+int TaskScheduler::currentWorkerIndex() const {
+    // Function to find out whether the calling thread is one of this pool's workers
+    return currentScheduler == this ? currentWorker : -1;
+}
+
+bool TaskScheduler::takeTask(int self, int firstPriority, int lastPriority, std::function<void()>& task) {
+    // Function to take the most urgent queued task in a priority range
+    const int count = (int)queues.size();
+    for (int priority = firstPriority; priority <= lastPriority; priority++) {
+        if (self >= 0) {
+            WorkerQueue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            std::deque<std::function<void()>>& tasks = own.tasks[priority];
+            if (!tasks.empty()) {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                pendingTasks--;
+                return true;
+            }
+        }
+        // Own deque first, newest task first
+
+        for (int offset = 1; offset <= count; offset++) {
+            int victim = ((self >= 0 ? self : 0) + offset) % count;
+            if (victim == self) continue;
+            WorkerQueue& other = *queues[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            std::deque<std::function<void()>>& tasks = other.tasks[priority];
+            if (!tasks.empty()) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                pendingTasks--;
+                return true;
+            }
+        }
+        // Then steal the oldest task of the same priority from another worker
+    }
+    return false;
+}
+
+void TaskScheduler::runTask(std::function<void()>& task) {
+    // Function to run a task, reporting instead of propagating its exceptions
+    try {
+        task();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Task failed: " << e.what() << std::endl;
+    }
+    catch (...) {
+        std::cerr << "Task failed with an unknown exception" << std::endl;
+    }
+    // A failing task must not take the worker (or a waiting thread) down with it
+}
+
+void TaskScheduler::workerFunction(unsigned index) {
+    // The main function that runs in each worker thread
+    currentScheduler = this;
+    currentWorker = (int)index;
+    const size_t nameCount = sizeof(workerNames) / sizeof(workerNames[0]);
+    Trace::setThreadName(index < nameCount ? workerNames[index] : "Worker");
+
+    while (true) {
+        std::function<void()> task;
+        if (takeTask((int)index, 0, TaskPriorityCount - 1, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        cv.wait(lock, [this] { return pendingTasks > 0 || stopWorkers; });
+        // Park until a task is queued or a stop is requested
+
+        if (stopWorkers) break;
+    }
+}
+
+TaskGroup::TaskGroup(TaskPriority priority, TaskScheduler& scheduler) : priority(priority), scheduler(scheduler), outstanding(0) {}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    // Function to submit a task as part of the group
+    outstanding++;
+    scheduler.submit([this, task]() {
+        try {
+            task();
+        }
+        catch (...) {
+            finishTask();
+            throw;
+        }
+        finishTask();
+    }, priority);
+}
+
+void TaskGroup::wait() {
+    // Function to wait for every task of the group
+    while (outstanding > 0) {
+        if (scheduler.runPendingTask(priority)) continue;
+        // Help with queued work instead of blocking a worker
+
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait_for(lock, std::chrono::milliseconds(1), [this] { return outstanding == 0; });
+        // Nothing to run: the remaining tasks are in progress on other threads
+    }
+
+    std::lock_guard<std::mutex> lock(doneMutex);
+    // The last task may still hold the mutex; don't let the group be destroyed under it
+}
+
+void TaskGroup::finishTask() {
+    // Function to mark one task of the group as finished
+    std::lock_guard<std::mutex> lock(doneMutex);
+    if (--outstanding == 0) {
+        done.notify_all();
+    }
+}
+
+void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body) {
+    // Function to run a loop body in parallel chunks
+    grainSize = std::max<size_t>(1, grainSize);
+    if (count <= grainSize) {
+        body(0, count);
+        return;
+    }
+    // Small loops are not worth the scheduling
+
+    TaskGroup group;
+    for (size_t begin = grainSize; begin < count; begin += grainSize) {
+        size_t end = std::min(count, begin + grainSize);
+        group.run([&body, begin, end]() { body(begin, end); });
+    }
+    body(0, grainSize);
+    // The calling thread takes the first chunk itself
+    group.wait();
+}
@@ -0,0 +1,159 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+// Includes the thread class for the worker threads
+#include <mutex>
+// Includes the mutex class for the per-worker queues
+#include <condition_variable>
+// Includes the condition_variable class used to park idle workers
+#include <atomic>
+// Includes the atomic class for the task counters
+#include <chrono>
+// Includes the steady clock delayed tasks are due on
+#include <map>
+// Includes the multimap ordering the delayed tasks by due time
+
+enum TaskPriority {
+    TaskPriorityHigh,
+    // User-facing work that should start right away (search requests)
+    TaskPriorityNormal,
+    // Work the UI is waiting for (view models, parsing, index building)
+    TaskPriorityLow,
+    // Background work nobody is waiting for (disk flushes)
+    TaskPriorityCount
+};
+// Priorities of scheduled tasks; a worker always takes the most urgent task it can find
+
+class TaskScheduler {
+public:
+    explicit TaskScheduler(unsigned workerCount = 0);
+    // Constructor: starts the workers (0 means one per hardware thread, at least 2)
+
+    ~TaskScheduler();
+    // Destructor: stops the workers once they have run the tasks still queued
+
+    static TaskScheduler& shared();
+    // Function to get the application-wide scheduler
+
+    void submit(std::function<void()> task, TaskPriority priority = TaskPriorityNormal);
+    // Queues a task; a task submitted from a worker goes to that worker's own deque
+
+    void submitAfter(std::chrono::steady_clock::duration delay, std::function<void()> task, TaskPriority priority = TaskPriorityNormal);
+    // Queues a task once the delay has passed, without holding a worker meanwhile (a timer thread, started on
+    // first use, submits it when it is due)
+
+    bool runPendingTask(TaskPriority priority);
+    // Runs one queued task of the given priority on the calling thread, if there is one (used while waiting for a TaskGroup)
+
+    unsigned getWorkerCount() const;
+    // Number of worker threads
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        // Mutex for the deques of this worker
+        std::deque<std::function<void()>> tasks[TaskPriorityCount];
+        // One deque per priority; the owner works at the back, thieves steal from the front
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    // One queue per worker
+
+    std::vector<std::thread> workers;
+    // Worker threads
+
+    std::mutex sleepMutex;
+    // Mutex for parking idle workers
+
+    std::condition_variable cv;
+    // Condition variable to wake a parked worker when a task is queued
+
+    std::atomic<int> pendingTasks;
+    // Number of queued tasks not yet taken by a worker
+
+    std::atomic<bool> stopWorkers;
+    // Atomic flag to signal the workers to stop
+
+    std::atomic<unsigned> nextQueue;
+    // Round-robin position for tasks submitted from outside the pool
+
+    struct DelayedTask {
+        std::function<void()> task;
+        // The task to submit
+        TaskPriority priority;
+        // Priority it is submitted with
+    };
+
+    std::multimap<std::chrono::steady_clock::time_point, DelayedTask> delayedTasks;
+    // Tasks waiting for their due time, earliest first
+
+    std::mutex timerMutex;
+    // Mutex for the delayed tasks and the timer state
+
+    std::condition_variable timerWake;
+    // Condition variable to wake the timer when an earlier task is added or the scheduler stops
+
+    std::thread timer;
+    // Thread that submits the delayed tasks when they are due; not started until a task is delayed
+
+    bool stopTimer;
+    // Set by the destructor; the timer submits whatever is still delayed and exits
+
+    int currentWorkerIndex() const;
+    // Index of the calling thread in this pool, or -1 if it is not one of its workers
+
+    bool takeTask(int self, int firstPriority, int lastPriority, std::function<void()>& task);
+    // Takes the most urgent task in the priority range: own deque first (newest), then steals (oldest) from the other workers
+
+    static void runTask(std::function<void()>& task);
+    // Runs a task, logging any exception it throws
+
+    void workerFunction(unsigned index);
+    // Function that runs in each worker thread
+
+    void timerFunction();
+    // Function that runs in the timer thread
+};
+
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPriority priority = TaskPriorityNormal, TaskScheduler& scheduler = TaskScheduler::shared());
+    // Constructor for a group of tasks that can be waited for together
+
+    ~TaskGroup();
+    // Destructor: waits for the tasks of the group
+
+    void run(std::function<void()> task);
+    // Submits a task as part of the group
+
+    void wait();
+    // Waits until every task of the group finished, running queued tasks of the group's priority meanwhile,
+    // so a worker can wait without deadlocking and without picking up an unrelated long task (like a search)
+
+private:
+    const TaskPriority priority;
+    // Priority of the group's tasks
+
+    TaskScheduler& scheduler;
+    // Scheduler the tasks run on
+
+    std::atomic<int> outstanding;
+    // Number of unfinished tasks
+
+    std::mutex doneMutex;
+    // Mutex for the completion signal
+
+    std::condition_variable done;
+    // Condition variable signalled when the last task finishes
+
+    void finishTask();
+    // Marks one task as finished
+};
+
+void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+// Runs body(begin, end) over [0, count) in chunks of about grainSize on the shared scheduler and waits for all chunks
@@ -0,0 +1,188 @@
+#include "TextArena.h"
+// Includes the header file for the TextArena class
+
+#include <algorithm>
+// Includes std::upper_bound
+
+#include <cstring>
+// Includes std::memchr and std::memcmp
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+// Includes __cpuid, __cpuidex and _BitScanForward for the CPU feature check
+#endif
+
+#include <immintrin.h>
+// Includes the SSE2 and AVX2 intrinsics
+
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+// GCC and Clang only emit AVX2 instructions in functions marked for it; MSVC emits them for the intrinsics
+
+namespace {
+    int lowestBit(unsigned int mask) {
+        // Function to find the index of the lowest set bit of a non-zero mask
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    bool cpuHasAvx2() {
+        // Function to check for AVX2 and for the operating system saving the AVX registers
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        const bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+        if (!osSavesAvx) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+
+    const char* findScalar(const char* begin, const char* end, const char* needle, size_t length) {
+        // Function to find the needle by looking for its first byte and comparing the rest
+        const char* last = end - length;
+        for (const char* position = begin; position <= last; position++) {
+            position = (const char*)std::memchr(position, needle[0], last - position + 1);
+            if (!position) return end;
+            if (std::memcmp(position + 1, needle + 1, length - 1) == 0) return position;
+        }
+        return end;
+    }
+
+    const char* findSse2(const char* begin, const char* end, const char* needle, size_t length) {
+        // Function to test 16 positions per step: a position is a candidate when its byte equals the needle's
+        // first byte and the byte length - 1 further on equals the needle's last byte
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[length - 1]);
+        const char* position = begin;
+        for (; position + length - 1 + 16 <= end; position += 16) {
+            const __m128i blockFirst = _mm_loadu_si128((const __m128i*)position);
+            const __m128i blockLast = _mm_loadu_si128((const __m128i*)(position + length - 1));
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+            while (mask != 0) {
+                int offset = lowestBit(mask);
+                if (std::memcmp(position + offset + 1, needle + 1, length - 2) == 0) return position + offset;
+                mask &= mask - 1;
+            }
+        }
+        return findScalar(position, end, needle, length);
+        // The last few positions, where a full block would read past the end
+    }
+
+    TARGET_AVX2 const char* findAvx2(const char* begin, const char* end, const char* needle, size_t length) {
+        // Function to test 32 positions per step, like findSse2
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[length - 1]);
+        const char* position = begin;
+        for (; position + length - 1 + 32 <= end; position += 32) {
+            const __m256i blockFirst = _mm256_loadu_si256((const __m256i*)position);
+            const __m256i blockLast = _mm256_loadu_si256((const __m256i*)(position + length - 1));
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last)));
+            while (mask != 0) {
+                int offset = lowestBit(mask);
+                if (std::memcmp(position + offset + 1, needle + 1, length - 2) == 0) return position + offset;
+                mask &= mask - 1;
+            }
+        }
+        return findSse2(position, end, needle, length);
+    }
+
+    const bool hasAvx2 = cpuHasAvx2();
+    // Checked once at startup
+}
+
+bool isSubstringKernelSupported(SubstringKernel kernel) {
+    return kernel != SubstringKernelAvx2 || hasAvx2;
+}
+
+const char* findSubstring(const char* begin, const char* end, const std::string& needle, SubstringKernel kernel) {
+    // Function to dispatch to a kernel after handling the needles too short for one
+    const size_t length = needle.size();
+    if (length == 0) return begin;
+    if ((size_t)(end - begin) < length) return end;
+    if (length == 1) {
+        const char* found = (const char*)std::memchr(begin, needle[0], end - begin);
+        return found ? found : end;
+    }
+    // A one-byte needle is a plain memchr, which the C library already vectorizes
+
+    if (kernel == SubstringKernelBest) {
+        kernel = hasAvx2 ? SubstringKernelAvx2 : SubstringKernelSse2;
+    }
+    switch (kernel) {
+    case SubstringKernelAvx2:
+        if (hasAvx2) return findAvx2(begin, end, needle.data(), length);
+        return findSse2(begin, end, needle.data(), length);
+    case SubstringKernelSse2:
+        return findSse2(begin, end, needle.data(), length);
+    default:
+        return findScalar(begin, end, needle.data(), length);
+    }
+}
+
+TextArena::TextArena() {
+    // Constructor for the TextArena class
+}
+
+void TextArena::clear() {
+    text.clear();
+    recordStarts.clear();
+}
+
+void TextArena::reserve(size_t records, size_t bytes) {
+    text.reserve(bytes);
+    recordStarts.reserve(records);
+}
+
+void TextArena::addRecord() {
+    recordStarts.push_back((uint32_t)text.size());
+}
+
+void TextArena::addField(const std::string& field) {
+    text.append(field);
+    text.push_back('\0');
+}
+
+size_t TextArena::getRecordCount() const {
+    return recordStarts.size();
+}
+
+size_t TextArena::getByteCount() const {
+    return text.size();
+}
+
+std::vector<uint32_t> TextArena::findRecords(const std::string& needle, SubstringKernel kernel) const {
+    // Function to scan the arena once, recording the record of each match
+    std::vector<uint32_t> records;
+    if (needle.empty()) return records;
+
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* position = begin;
+    while (position < end) {
+        const char* found = findSubstring(position, end, needle, kernel);
+        if (found == end) break;
+
+        uint32_t record = (uint32_t)(std::upper_bound(recordStarts.begin(), recordStarts.end(), (uint32_t)(found - begin)) -
+            recordStarts.begin() - 1);
+        records.push_back(record);
+        position = record + 1 < recordStarts.size() ? begin + recordStarts[record + 1] : end;
+        // One match is enough: continue from the start of the next record
+    }
+    return records;
+}
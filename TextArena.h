@@ -0,0 +1,62 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+enum SubstringKernel {
+    SubstringKernelScalar,
+    // Byte by byte, on any CPU
+    SubstringKernelSse2,
+    // 16 positions per step (every x86 and x64 CPU the application runs on)
+    SubstringKernelAvx2,
+    // 32 positions per step, when the CPU supports it
+    SubstringKernelBest
+    // The fastest one this CPU supports
+};
+// Implementations of findSubstring, selectable for benchmarking
+
+const char* findSubstring(const char* begin, const char* end, const std::string& needle, SubstringKernel kernel = SubstringKernelBest);
+// Function to find the first occurrence of needle in [begin, end); returns end if there is none
+// The vector kernels compare the needle's first and last bytes at every position at once and only check the
+// positions where both match, so ordinary text is scanned at memory speed
+
+bool isSubstringKernelSupported(SubstringKernel kernel);
+// Function to check whether the CPU can run a kernel
+
+class TextArena {
+public:
+    TextArena();
+    // Constructor for an empty arena
+
+    void clear();
+    // Function to remove every record
+
+    void reserve(size_t records, size_t bytes);
+    // Function to reserve space ahead of a build
+
+    void addRecord();
+    // Function to start a new record; the fields added next belong to it
+
+    void addField(const std::string& field);
+    // Function to append a field to the current record (a collation key, so searches are case-insensitive)
+
+    size_t getRecordCount() const;
+    // Number of records
+
+    size_t getByteCount() const;
+    // Size of the text, separators included
+
+    std::vector<uint32_t> findRecords(const std::string& needle, SubstringKernel kernel = SubstringKernelBest) const;
+    // Function to find the records with a field containing needle; record numbers in ascending order
+    // One pass over the whole arena: after a match the scan jumps to the next record
+
+private:
+    std::string text;
+    // Every field of every record back to back, each followed by a '\0' so no match spans two fields
+
+    std::vector<uint32_t> recordStarts;
+    // Offset in text where each record starts
+};
+// Contiguous copy of the searchable text of a result snapshot
@@ -0,0 +1,87 @@
+#include "TextLayoutCache.h"
+// Includes the header file for the TextLayoutCache class
+
+#include <imgui_internal.h>
+// Includes ImTextCharFromUtf8 for stepping over UTF-8 characters
+
+#include <cstring>
+// Includes memchr for finding paragraph breaks
+
+TextLayoutCache::TextLayoutCache() : cachedOwner(nullptr), cachedSize(0), cachedWrapWidth(-1.0f), cachedFont(nullptr), cachedFontSize(0.0f) {}
+// Constructor: starts with an empty layout that is computed on first render
+
+size_t TextLayoutCache::getLineCount() const {
+    return lines.size();
+}
+
+void TextLayoutCache::invalidate() {
+    cachedOwner = nullptr;
+}
+
+void TextLayoutCache::rebuild(const std::string& text, ImFont* font, float fontSize, float wrapWidth) {
+    // Function to split the text into wrapped lines, matching ImGui::TextWrapped() behaviour
+    cachedSize = text.size();
+    cachedWrapWidth = wrapWidth;
+    cachedFont = font;
+    cachedFontSize = fontSize;
+    lines.clear();
+
+    const float scale = fontSize / font->FontSize;
+    const char* begin = text.c_str();
+    const char* end = begin + text.size();
+    const char* s = begin;
+
+    while (s < end) {
+        const char* paragraphEnd = static_cast<const char*>(std::memchr(s, '\n', end - s));
+        if (paragraphEnd == nullptr) paragraphEnd = end;
+        // Wrapping is done one paragraph at a time, hard line breaks always end a line
+
+        const char* lineEnd = paragraphEnd;
+        if (wrapWidth > 0.0f) {
+            lineEnd = font->CalcWordWrapPositionA(scale, s, paragraphEnd, wrapWidth);
+        }
+        if (lineEnd == s && s < paragraphEnd) {
+            unsigned int c;
+            lineEnd = s + ImTextCharFromUtf8(&c, s, paragraphEnd);
+            // Always place at least one character per line, even if the column is narrower than it
+        }
+
+        lines.push_back({ (size_t)(s - begin), (size_t)(lineEnd - begin) });
+
+        s = lineEnd;
+        while (s < paragraphEnd && (*s == ' ' || *s == '\t')) s++;
+        if (s < end && *s == '\n') s++;
+        // Skip the blanks at the wrap point and the newline that ended the paragraph
+    }
+}
+
+void TextLayoutCache::render(const std::string& text, const void* owner) {
+    // Function to render the cached layout, clipped to the visible part of the window
+    ImFont* font = ImGui::GetFont();
+    float fontSize = ImGui::GetFontSize();
+    float wrapWidth = ImGui::GetContentRegionAvail().x;
+
+    if (owner != cachedOwner || text.size() != cachedSize || wrapWidth != cachedWrapWidth || font != cachedFont || fontSize != cachedFontSize) {
+        rebuild(text, font, fontSize, wrapWidth);
+        cachedOwner = owner;
+        // Only a resize, a font change or another selected job triggers a new layout
+    }
+
+    const ImGuiStyle& style = ImGui::GetStyle();
+    ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(style.ItemSpacing.x, 0.0f));
+    // Lines of a wrapped paragraph are packed without item spacing, like a single TextWrapped() call
+
+    const char* data = text.c_str();
+    ImGuiListClipper clipper;
+    clipper.Begin((int)lines.size(), ImGui::GetTextLineHeight());
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            ImGui::TextUnformatted(data + lines[i].begin, data + lines[i].end);
+        }
+    }
+    // Only the lines inside the scrolled view are submitted to the draw list
+
+    ImGui::PopStyleVar();
+    ImGui::Spacing();
+    // Restore the regular spacing before the next widget
+}
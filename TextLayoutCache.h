@@ -0,0 +1,54 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <imgui.h>
+// Includes the Dear ImGui library for the ImFont type
+
+#include <string>
+#include <vector>
+
+class TextLayoutCache {
+public:
+    TextLayoutCache();
+    // Constructor for the TextLayoutCache class
+
+    void render(const std::string& text, const void* owner);
+    // Renders the text word-wrapped to the available width; owner identifies the text (the job it belongs to)
+    // The line breaks are only recomputed when the owner, wrap width or font changes, compared in O(1) without
+    // reading the text, and only visible lines are submitted
+
+    void invalidate();
+    // Function to drop the layout; call it when the owner's text may have changed at the same address (the list
+    // the job lives in was replaced or edited)
+
+    size_t getLineCount() const;
+    // Number of wrapped lines in the current layout
+
+private:
+    struct Line {
+        size_t begin;
+        size_t end;
+        // Byte offsets of the line's glyph run inside the text
+    };
+
+    std::vector<Line> lines;
+    // Wrapped lines of the cached text
+
+    const void* cachedOwner;
+    // Owner of the text the layout was computed for, nullptr if there is no layout
+
+    size_t cachedSize;
+    // Length of that text, so a stale layout can never point past the end of the text rendered
+
+    float cachedWrapWidth;
+    // Wrap width the layout was computed for
+
+    ImFont* cachedFont;
+    // Font the layout was computed for
+
+    float cachedFontSize;
+    // Font size the layout was computed for
+
+    void rebuild(const std::string& text, ImFont* font, float fontSize, float wrapWidth);
+    // Recomputes the line breaks
+};
@@ -0,0 +1,93 @@
+#include "TimerWheel.h"
+// Includes the header file for the TimerWheel class
+
+#include <algorithm>
+// Includes std::sort and std::min
+
+TimerWheel::TimerWheel(size_t slotCount) : slots(std::max<size_t>(slotCount, 1)), now(0) {}
+// Constructor implementation
+
+void TimerWheel::schedule(uint64_t id, uint64_t delayTicks) {
+    // Function to put a timer in the slot of its due tick
+    cancel(id);
+    Timer timer = { id, now + std::max<uint64_t>(delayTicks, 1) };
+    Slot& slot = slots[timer.due % slots.size()];
+    timers[id] = slot.insert(slot.end(), timer);
+    // A delay longer than a turn of the wheel lands in the same slot as a nearer one; advance() checks the due tick
+}
+
+bool TimerWheel::cancel(uint64_t id) {
+    // Function to take a timer out of its slot
+    std::unordered_map<uint64_t, Slot::iterator>::iterator found = timers.find(id);
+    if (found == timers.end()) return false;
+    slots[found->second->due % slots.size()].erase(found->second);
+    timers.erase(found);
+    return true;
+}
+
+bool TimerWheel::isScheduled(uint64_t id) const {
+    return timers.count(id) != 0;
+}
+
+void TimerWheel::advance(uint64_t ticks, std::vector<uint64_t>& expired) {
+    // Function to fire the timers due up to now + ticks
+    const uint64_t target = now + ticks;
+    if (ticks >= slots.size()) {
+        std::vector<Timer> fired;
+        for (Slot& slot : slots) {
+            for (Slot::iterator it = slot.begin(); it != slot.end();) {
+                if (it->due <= target) {
+                    fired.push_back(*it);
+                    timers.erase(it->id);
+                    it = slot.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+        std::sort(fired.begin(), fired.end(), [](const Timer& a, const Timer& b) { return a.due < b.due; });
+        for (const Timer& timer : fired) {
+            expired.push_back(timer.id);
+        }
+        // A full turn or more (the computer slept): every slot is due, visit each once
+    }
+    else {
+        for (uint64_t tick = now + 1; tick <= target; tick++) {
+            Slot& slot = slots[tick % slots.size()];
+            for (Slot::iterator it = slot.begin(); it != slot.end();) {
+                if (it->due <= tick) {
+                    expired.push_back(it->id);
+                    timers.erase(it->id);
+                    it = slot.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+        // Timers due on a later turn stay in their slot
+    }
+    now = target;
+}
+
+uint64_t TimerWheel::getTicksUntilNext() const {
+    // Function to find the nearest due tick
+    uint64_t next = UINT64_MAX;
+    for (size_t i = 1; i <= slots.size(); i++) {
+        for (const Timer& timer : slots[(now + i) % slots.size()]) {
+            next = std::min(next, timer.due - now);
+        }
+        if (next <= i) return next;
+        // Slots are visited in tick order, so a timer due within this turn cannot be beaten by a later slot
+    }
+    return next;
+}
+
+size_t TimerWheel::size() const {
+    return timers.size();
+}
+
+uint64_t TimerWheel::getNow() const {
+    return now;
+}
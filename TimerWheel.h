@@ -0,0 +1,57 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+class TimerWheel {
+public:
+    explicit TimerWheel(size_t slotCount = 512);
+    // Constructor for an empty wheel with the given number of slots (one tick each)
+
+    void schedule(uint64_t id, uint64_t delayTicks);
+    // Function to fire a timer after delayTicks ticks (0 fires on the next advance); rescheduling an id moves it
+
+    bool cancel(uint64_t id);
+    // Function to remove a timer; false if it was not scheduled
+
+    bool isScheduled(uint64_t id) const;
+    // Function to check whether a timer is pending
+
+    void advance(uint64_t ticks, std::vector<uint64_t>& expired);
+    // Function to move the wheel forward; appends the ids of the timers that fired, in firing order
+
+    uint64_t getTicksUntilNext() const;
+    // Number of ticks until the next timer fires, UINT64_MAX if none is scheduled (for sleeping until then)
+
+    size_t size() const;
+    // Number of pending timers
+
+    uint64_t getNow() const;
+    // Ticks advanced since the wheel was created
+
+private:
+    struct Timer {
+        uint64_t id;
+        // Caller's identifier of the timer
+        uint64_t due;
+        // Tick the timer fires at
+    };
+
+    typedef std::list<Timer> Slot;
+    // Timers whose due tick falls on one slot, for any number of turns ahead
+
+    std::vector<Slot> slots;
+    // Slot of tick t is slots[t % slots.size()]
+
+    std::unordered_map<uint64_t, Slot::iterator> timers;
+    // Position of every pending timer, for O(1) cancel and reschedule
+
+    uint64_t now;
+    // Current tick
+};
+// Hashed timing wheel: scheduling and cancelling are O(1), and advancing one tick visits one slot, so thousands of
+// timers with intervals from seconds to days cost nothing between their expiries
@@ -0,0 +1,215 @@
+#include "Trace.h"
+// Includes the header file for the Trace class
+
+#include <chrono>
+// Includes the steady clock used for the timestamps
+
+#include <cstdio>
+// Includes snprintf for formatting the timestamps
+
+#include <fstream>
+// Includes the file stream used to write the trace
+
+#include <mutex>
+// Includes the mutex protecting the list of thread buffers
+
+#include <vector>
+
+std::atomic<bool> Trace::enabled(false);
+
+namespace {
+    struct TraceEvent {
+        const char* name;
+        const char* category;
+        int64_t beginNs;
+        int64_t endNs;
+    };
+    // One completed span
+
+    const uint32_t bufferCapacity = 1 << 16;
+    // Spans kept per thread and trace (2 MB per thread); later spans are dropped, so memory and cost stay bounded
+
+    struct ThreadBuffer {
+        int threadId;
+        const char* threadName;
+        std::atomic<uint32_t> generation;
+        // Trace the events belong to; only the owning thread resets the buffer for a new trace
+        std::atomic<uint32_t> count;
+        // Number of published events; stored with release order after an event is written
+        std::atomic<size_t> dropped;
+        TraceEvent events[bufferCapacity];
+    };
+    // Events of one thread; written only by that thread, read by writeChromeJson()
+
+    std::mutex registryMutex;
+    std::vector<ThreadBuffer*> registry;
+    // Buffers of all threads that recorded a span; kept until exit so spans of finished threads survive
+
+    std::atomic<uint32_t> currentGeneration(0);
+    // Incremented by start(), which lazily invalidates every buffer
+
+    int64_t clockNs() {
+        // Function to read the steady clock in nanoseconds
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::atomic<int64_t> epochNs(clockNs());
+    // Time zero of the current trace
+
+    thread_local ThreadBuffer* localBuffer = nullptr;
+    thread_local const char* localThreadName = nullptr;
+    // The calling thread's buffer and name
+
+    ThreadBuffer* getLocalBuffer() {
+        // Function to get the calling thread's buffer, registering it on first use
+        if (!localBuffer) {
+            ThreadBuffer* buffer = new ThreadBuffer();
+            buffer->threadName = localThreadName;
+            buffer->generation.store(currentGeneration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->threadId = (int)registry.size() + 1;
+            registry.push_back(buffer);
+            localBuffer = buffer;
+        }
+        return localBuffer;
+    }
+
+    void writeEscaped(std::ostream& out, const char* text) {
+        // Function to write a string as a JSON string literal
+        out << '"';
+        for (const char* c = text ? text : ""; *c; c++) {
+            if (*c == '"' || *c == '\\') out << '\\';
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+void Trace::start() {
+    // Function to start a new trace
+    enabled.store(false, std::memory_order_relaxed);
+    epochNs.store(clockNs(), std::memory_order_relaxed);
+    currentGeneration.fetch_add(1, std::memory_order_release);
+    enabled.store(true, std::memory_order_release);
+}
+
+void Trace::stop() {
+    // Function to stop recording
+    enabled.store(false, std::memory_order_release);
+}
+
+void Trace::setThreadName(const char* name) {
+    // Function to name the calling thread in the trace
+    localThreadName = name;
+    if (localBuffer) localBuffer->threadName = name;
+}
+
+int64_t Trace::now() {
+    // Function to get the time since the trace was started
+    return clockNs() - epochNs.load(std::memory_order_relaxed);
+}
+
+void Trace::record(const char* name, const char* category, int64_t beginNs, int64_t endNs) {
+    // Function to append a span to the calling thread's buffer
+    if (endNs < beginNs) return;
+    // The span started before the trace was restarted
+
+    ThreadBuffer* buffer = getLocalBuffer();
+
+    uint32_t generation = currentGeneration.load(std::memory_order_acquire);
+    if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->generation.store(generation, std::memory_order_release);
+    }
+    // First span of this thread in a new trace: forget the previous one
+
+    uint32_t index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= bufferCapacity) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceEvent& event = buffer->events[index];
+    event.name = name;
+    event.category = category;
+    event.beginNs = beginNs;
+    event.endNs = endNs;
+    buffer->count.store(index + 1, std::memory_order_release);
+    // Publish the event only after it is fully written
+}
+
+bool Trace::writeChromeJson(const std::string& path) {
+    // Function to write the recorded spans as Chrome trace-event JSON
+    // Can be called while tracing; spans recorded meanwhile may or may not be included
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers = registry;
+    }
+    uint32_t generation = currentGeneration.load(std::memory_order_acquire);
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Job Search Application\"}}";
+
+    char number[64];
+    for (ThreadBuffer* buffer : buffers) {
+        if (buffer->threadName) {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+            writeEscaped(file, buffer->threadName);
+            file << "}}";
+        }
+
+        if (buffer->generation.load(std::memory_order_acquire) != generation) continue;
+        // The thread has not recorded anything in the current trace
+
+        uint32_t count = buffer->count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++) {
+            const TraceEvent& event = buffer->events[i];
+            file << ",\n{\"name\":";
+            writeEscaped(file, event.name);
+            file << ",\"cat\":";
+            writeEscaped(file, event.category);
+            snprintf(number, sizeof(number), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+                event.beginNs / 1000.0, (event.endNs - event.beginNs) / 1000.0);
+            file << number << ",\"pid\":1,\"tid\":" << buffer->threadId << "}";
+        }
+        // Complete ("X") events, timestamps in microseconds
+    }
+
+    file << "\n]}\n";
+    return file.good();
+}
+
+size_t Trace::getEventCount() {
+    // Function to count the spans of the current trace
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint32_t generation = currentGeneration.load(std::memory_order_acquire);
+    size_t total = 0;
+    for (ThreadBuffer* buffer : registry) {
+        if (buffer->generation.load(std::memory_order_acquire) == generation) {
+            total += buffer->count.load(std::memory_order_acquire);
+        }
+    }
+    return total;
+}
+
+size_t Trace::getDroppedCount() {
+    // Function to count the spans dropped in the current trace
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint32_t generation = currentGeneration.load(std::memory_order_acquire);
+    size_t total = 0;
+    for (ThreadBuffer* buffer : registry) {
+        if (buffer->generation.load(std::memory_order_acquire) == generation) {
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
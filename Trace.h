@@ -0,0 +1,69 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <atomic>
+// Includes the atomic class for the enabled flag
+#include <cstdint>
+// Includes int64_t for the timestamps
+#include <cstddef>
+// Includes size_t
+#include <string>
+
+class Trace {
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    // Function to check whether spans are being recorded; this is the only cost paid when tracing is off
+
+    static void start();
+    // Function to start a new trace, discarding the events of the previous one
+
+    static void stop();
+    // Function to stop recording; the recorded events stay available for writeChromeJson()
+
+    static void setThreadName(const char* name);
+    // Names the calling thread in the trace (name must be a string literal)
+
+    static int64_t now();
+    // Current time in nanoseconds since the trace was started
+
+    static void record(const char* name, const char* category, int64_t beginNs, int64_t endNs);
+    // Appends a completed span to the calling thread's buffer; lock-free (name and category must be string literals)
+
+    static bool writeChromeJson(const std::string& path);
+    // Writes the recorded spans in the Chrome trace-event format (chrome://tracing, ui.perfetto.dev)
+
+    static size_t getEventCount();
+    // Number of spans recorded in the current trace
+
+    static size_t getDroppedCount();
+    // Number of spans dropped because a thread's buffer was full
+
+private:
+    static std::atomic<bool> enabled;
+    // Whether spans are being recorded
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* category = "app")
+        : name(Trace::isEnabled() ? name : nullptr), category(category), beginNs(0) {
+        if (this->name) beginNs = Trace::now();
+    }
+    // Starts the span only when tracing is enabled
+
+    ~TraceScope() {
+        if (name) Trace::record(name, category, beginNs, Trace::now());
+    }
+    // Records the span into the calling thread's buffer
+
+private:
+    const char* name;
+    const char* category;
+    int64_t beginNs;
+};
+// Records the enclosing scope as a span of the trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+// Records the rest of the enclosing scope as a span with the given name and category
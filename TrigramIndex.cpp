@@ -0,0 +1,167 @@
+#include "TrigramIndex.h"
+// Includes the header file for the TrigramIndex class
+
+#include <algorithm>
+// Includes std::sort, std::unique, std::fill and std::min
+
+namespace {
+    uint32_t trigramAt(const std::string& text, size_t position) {
+        // Function to pack the three bytes at a position into an integer
+        return ((uint32_t)(unsigned char)text[position] << 16) | ((uint32_t)(unsigned char)text[position + 1] << 8) |
+            (uint32_t)(unsigned char)text[position + 2];
+    }
+
+    struct PatternMasks {
+        uint64_t positions[256];
+        // Bit i is set in positions[c] when byte i of the pattern is c
+        uint64_t lastBit;
+        // Bit of the pattern's last byte
+        int length;
+        // Pattern length, at most 64
+    };
+    // Precomputed bit vectors of a pattern for Myers' algorithm
+
+    void buildMasks(const std::string& pattern, PatternMasks& masks) {
+        // Function to precompute the bit vectors of a pattern of up to 64 bytes
+        std::fill(masks.positions, masks.positions + 256, 0);
+        for (size_t i = 0; i < pattern.size(); i++) {
+            masks.positions[(unsigned char)pattern[i]] |= (uint64_t)1 << i;
+        }
+        masks.lastBit = (uint64_t)1 << (pattern.size() - 1);
+        masks.length = (int)pattern.size();
+    }
+
+    bool containsWithin(const std::string& text, const PatternMasks& masks, int maxEdits) {
+        // Function to run Myers' bit-parallel edit distance: one column of the dynamic programming table per text
+        // byte, kept as vertical +1/-1 deltas in two words, so a byte costs a few instructions
+        uint64_t plus = ~(uint64_t)0;
+        uint64_t minus = 0;
+        int score = masks.length;
+        // Edit distance of the whole pattern against the best substring ending at the current byte
+        for (char c : text) {
+            uint64_t equal = masks.positions[(unsigned char)c];
+            uint64_t vertical = equal | minus;
+            uint64_t horizontal = (((equal & plus) + plus) ^ plus) | equal;
+            uint64_t horizontalPlus = minus | ~(horizontal | plus);
+            uint64_t horizontalMinus = plus & horizontal;
+            if (horizontalPlus & masks.lastBit) score++;
+            else if (horizontalMinus & masks.lastBit) score--;
+            horizontalPlus <<= 1;
+            horizontalMinus <<= 1;
+            // No carry into the first row: a match may start at any byte
+            plus = horizontalMinus | ~(vertical | horizontalPlus);
+            minus = horizontalPlus & vertical;
+            if (score <= maxEdits) return true;
+        }
+        return false;
+    }
+}
+
+TrigramIndex::TrigramIndex() {
+    // Constructor for the TrigramIndex class
+}
+
+void TrigramIndex::clear() {
+    texts.clear();
+    postings.clear();
+}
+
+uint32_t TrigramIndex::add(const std::string& text) {
+    // Function to add a text and append its id to the postings of its trigrams
+    uint32_t id = (uint32_t)texts.size();
+    texts.push_back(text);
+    for (size_t i = 0; i + 3 <= text.size(); i++) {
+        std::vector<uint32_t>& list = postings[trigramAt(text, i)];
+        if (list.empty() || list.back() != id) {
+            list.push_back(id);
+        }
+        // Ids only grow, so a repeated trigram of the same text is always at the back
+    }
+    return id;
+}
+
+size_t TrigramIndex::size() const {
+    return texts.size();
+}
+
+int TrigramIndex::getMaxEdits(size_t patternLength) {
+    // Function to choose the tolerance: the most edits that still leave the pattern one trigram in the worst case
+    if (patternLength < 6) return 0;
+    return patternLength < 9 ? 1 : 2;
+}
+
+std::vector<uint32_t> TrigramIndex::find(const std::string& pattern, int maxEdits) const {
+    // Function to find the texts approximately containing the pattern: trigram filter, then verification
+    std::vector<uint32_t> matches;
+    if (pattern.size() < 3) return matches;
+
+    std::vector<uint32_t> trigrams;
+    for (size_t i = 0; i + 3 <= pattern.size() && i < 255; i++) {
+        // Only the first 255 trigrams of a very long pattern are used; the bound below still holds for them
+        trigrams.push_back(trigramAt(pattern, i));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    int required = (int)trigrams.size() - 3 * maxEdits;
+    // Each edit destroys at most three trigram occurrences, so at most three of the distinct trigrams
+    if (required < 1) return matches;
+    // Too short for its tolerance: the filter would let every text through
+
+    std::vector<uint8_t> counts(texts.size(), 0);
+    for (uint32_t trigram : trigrams) {
+        std::unordered_map<uint32_t, std::vector<uint32_t>>::const_iterator found = postings.find(trigram);
+        if (found == postings.end()) continue;
+        for (uint32_t id : found->second) {
+            counts[id]++;
+        }
+    }
+    // One sequential pass over each posting list; at most 255 trigrams are counted (see above), so the byte
+    // counters cannot wrap
+
+    const bool bitParallel = pattern.size() <= 64;
+    PatternMasks masks;
+    if (bitParallel) {
+        buildMasks(pattern, masks);
+    }
+    for (uint32_t id = 0; id < (uint32_t)counts.size(); id++) {
+        if (counts[id] < required) continue;
+        if (bitParallel ? containsWithin(texts[id], masks, maxEdits) : containsApproximately(texts[id], pattern, maxEdits)) {
+            matches.push_back(id);
+        }
+    }
+    return matches;
+}
+
+bool TrigramIndex::containsApproximately(const std::string& text, const std::string& pattern, int maxEdits) {
+    // Function to compute the edit distance of the pattern to the best-matching substring of the text
+    if (pattern.size() <= 64 && !pattern.empty()) {
+        PatternMasks masks;
+        buildMasks(pattern, masks);
+        return (int)pattern.size() <= maxEdits || containsWithin(text, masks, maxEdits);
+    }
+    // Longer patterns fall back to the table, one column at a time
+    // Column j holds the cost of matching the pattern so far against a substring ending at text[j]; a match may
+    // start anywhere, so the first row is all zeros
+    const size_t length = pattern.size();
+    if (length == 0) return true;
+
+    std::vector<int> column(length + 1);
+    for (size_t i = 0; i <= length; i++) {
+        column[i] = (int)i;
+    }
+    if ((int)length <= maxEdits) return true;
+
+    for (char c : text) {
+        int diagonal = 0;
+        // Cost above-left; the first row is free
+        for (size_t i = 1; i <= length; i++) {
+            int above = column[i];
+            int cost = std::min(std::min(column[i] + 1, column[i - 1] + 1), diagonal + (pattern[i - 1] == c ? 0 : 1));
+            diagonal = above;
+            column[i] = cost;
+        }
+        if (column[length] <= maxEdits) return true;
+    }
+    return false;
+}
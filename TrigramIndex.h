@@ -0,0 +1,43 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+class TrigramIndex {
+public:
+    TrigramIndex();
+    // Constructor for an empty index
+
+    void clear();
+    // Function to remove every text
+
+    uint32_t add(const std::string& text);
+    // Function to index a text (a collation key, so matching is case-insensitive); returns its id, counting from 0
+
+    size_t size() const;
+    // Number of texts indexed
+
+    std::vector<uint32_t> find(const std::string& pattern, int maxEdits) const;
+    // Function to find the texts containing a substring within maxEdits insertions, deletions or substitutions
+    // of the pattern; ids in ascending order. Candidates come from the trigram postings (a text with such a
+    // substring shares at least trigrams(pattern) - 3 * maxEdits of the pattern's trigrams) and are verified
+    // with an edit distance, so only a small part of the texts is compared. Edits count bytes, so a changed
+    // accented or Cyrillic letter costs two
+
+    static int getMaxEdits(size_t patternLength);
+    // Typo tolerance for a pattern: none below 6 bytes, one edit below 9, two from 9 on
+
+    static bool containsApproximately(const std::string& text, const std::string& pattern, int maxEdits);
+    // Function to check whether a text has a substring within maxEdits edits of the pattern (Myers' bit-parallel
+    // algorithm up to 64 bytes, the full table beyond)
+
+private:
+    std::vector<std::string> texts;
+    // Indexed texts, by id
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+    // Ids of the texts containing each trigram (three bytes packed into an integer), ascending
+};
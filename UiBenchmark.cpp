@@ -0,0 +1,210 @@
+// Headless benchmark for UserInterface::render()
+// Runs the ImGui frame loop without a platform or renderer backend, feeding synthetic result sets
+// and synthetic favorites, and reports CPU time, heap allocations and draw-list size per frame.
+//
+// Usage: UiBenchmark [--sizes 10,100,1000] [--frames 300] [--json] [--trace trace.json]
+// With --trace the run is traced and the timeline is written at the end; comparing the timings with and
+// without it measures the tracing overhead.
+
+#include "UserInterface.h"
+// Includes the UserInterface class under test
+
+#include "FavoritesManager.h"
+// Includes the FavoritesManager class, used to write the synthetic favorites file
+
+#include "FontAtlasCache.h"
+// Includes the font atlas cache, so the benchmark uses the same font as the application
+
+#include "SyntheticData.h"
+// Includes the synthetic job generators
+
+#include "Profiler.h"
+// Includes the profiler, whose counting operator new reports allocations per frame
+
+#include "Trace.h"
+// Includes the tracer, enabled with --trace
+
+#include <imgui.h>
+// Includes the Dear ImGui library
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace {
+    struct FrameStats {
+        double cpuMs;
+        size_t allocations;
+        int vertices;
+        int indices;
+    };
+    // Measurements of one frame
+
+    FrameStats runFrame(UserInterface& ui) {
+        // Function to run one headless ImGui frame and measure it
+        ImGuiIO& io = ImGui::GetIO();
+        io.DeltaTime = 1.0f / 60.0f;
+
+        size_t allocationsBefore = Profiler::getAllocationCount();
+        auto start = std::chrono::steady_clock::now();
+
+        {
+            TRACE_SCOPE("Frame", "ui");
+            ImGui::NewFrame();
+            ui.render();
+            ImGui::Render();
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        size_t allocationsAfter = Profiler::getAllocationCount();
+
+        const ImDrawData* drawData = ImGui::GetDrawData();
+        FrameStats stats;
+        stats.cpuMs = std::chrono::duration<double, std::milli>(end - start).count();
+        stats.allocations = allocationsAfter - allocationsBefore;
+        stats.vertices = drawData->TotalVtxCount;
+        stats.indices = drawData->TotalIdxCount;
+        return stats;
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        // Function to compute a percentile (nearest rank) of a sample
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t rank = (size_t)(p / 100.0 * (values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    }
+
+    std::vector<size_t> parseSizes(const char* text) {
+        // Function to parse a comma separated list of result set sizes
+        std::vector<size_t> sizes;
+        const char* s = text;
+        while (*s) {
+            char* end = nullptr;
+            sizes.push_back((size_t)std::strtoull(s, &end, 10));
+            s = (*end == ',') ? end + 1 : end;
+            if (end == s && *s) break;
+        }
+        return sizes;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+    int frames = 300;
+    bool json = false;
+    const char* tracePath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) sizes = parseSizes(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--json") == 0) json = true;
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else {
+            std::fprintf(stderr, "Usage: %s [--sizes 10,100,1000] [--frames 300] [--json] [--trace trace.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    // Parse the command line
+
+    Profiler::setEnabled(true);
+    // Count allocations for the whole run; they include the view-model worker, like the application
+
+    Trace::setThreadName("UI");
+    if (tracePath) {
+        Trace::start();
+    }
+
+    Profiler::installImGuiAllocator();
+    ImGui::CreateContext();
+    // ImGui allocates with malloc, so it needs its own counting hooks to show up in allocations per frame
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1200, 600);
+    // Same window size as the application
+    io.IniFilename = nullptr;
+    // Don't read or overwrite the application's imgui.ini
+
+    static const ImWchar ranges[] = {
+        0x0020, 0x00FF, 0x2000, 0x206F, 0x3000, 0x30FF, 0x31F0, 0x31FF, 0xFF00, 0xFFEF, 0x4e00, 0x9FAF,
+        0x20A0, 0x20CF, 0x0100, 0x024F, 0x0370, 0x03FF, 0x0400, 0x04FF, 0x0500, 0x052F, 0,
+    };
+    if (io.Fonts->AddFontFromFileTTF("calibri.ttf", 20.0f, NULL, ranges) == nullptr) {
+        std::fprintf(stderr, "Failed to load font!\n");
+        return 1;
+    }
+    FontAtlasCache fontAtlasCache("fontatlas.cache");
+    fontAtlasCache.build(io.Fonts);
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    io.Fonts->SetTexID((ImTextureID)1);
+    // Same font as the application; the texture is never uploaded since there is no renderer
+
+    if (!json) {
+        std::printf("%10s %10s %10s %10s %12s %10s %10s\n", "jobs", "mean ms", "p50 ms", "p99 ms", "allocs/frame", "vertices", "indices");
+    }
+
+    for (size_t size : sizes) {
+        std::vector<Job> jobs = generateJobs(size, 42);
+        FavoritesManager("bench_favorites.json").saveFavorites(sampleFavorites(jobs, 0.01, 7));
+        // 1% of the jobs are favorites, written to a separate file so the user's favorites are untouched
+
+        UserInterface ui("bench_favorites.json", "bench_store", "bench_saved_searches.json");
+        ui.showResults(std::make_shared<const std::vector<Job>>(std::move(jobs)));
+
+        auto warmupStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < 10 || !ui.isResultsViewReady(); i++) {
+            runFrame(ui);
+            if (!ui.isResultsViewReady()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (std::chrono::steady_clock::now() - warmupStart > std::chrono::seconds(120)) break;
+        }
+        // Warm up until the background view model for this result set has been published
+
+        std::vector<double> cpuMs;
+        size_t totalAllocations = 0;
+        FrameStats last = {};
+        for (int i = 0; i < frames; i++) {
+            last = runFrame(ui);
+            cpuMs.push_back(last.cpuMs);
+            totalAllocations += last.allocations;
+        }
+
+        double mean = 0.0;
+        for (double ms : cpuMs) mean += ms;
+        mean /= cpuMs.size();
+        double allocationsPerFrame = (double)totalAllocations / frames;
+
+        if (json) {
+            std::printf("{\"benchmark\":\"ui_render\",\"jobs\":%zu,\"frames\":%d,\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p99_ms\":%.4f,"
+                "\"allocs_per_frame\":%.2f,\"vertices\":%d,\"indices\":%d}\n",
+                size, frames, mean, percentile(cpuMs, 50), percentile(cpuMs, 99), allocationsPerFrame, last.vertices, last.indices);
+        }
+        else {
+            std::printf("%10zu %10.4f %10.4f %10.4f %12.2f %10d %10d\n",
+                size, mean, percentile(cpuMs, 50), percentile(cpuMs, 99), allocationsPerFrame, last.vertices, last.indices);
+        }
+        std::fflush(stdout);
+    }
+
+    if (tracePath) {
+        Trace::stop();
+        if (!Trace::writeChromeJson(tracePath)) {
+            std::fprintf(stderr, "Failed to write %s\n", tracePath);
+            return 1;
+        }
+        std::fprintf(stderr, "Wrote %zu trace events to %s (%zu dropped)\n", Trace::getEventCount(), tracePath, Trace::getDroppedCount());
+    }
+
+    ImGui::DestroyContext();
+    std::remove("bench_favorites.json");
+    SavedSearches::destroy("bench_saved_searches.json");
+    JobStore::destroy("bench_store");
+    return 0;
+}
@@ -1,6 +1,12 @@
 #include "UserInterface.h"
 // Includes the header file for the UserInterface class, providing access to its declarations
 
+#include "Profiler.h"
+// Includes the profiler, which times the UI scopes and draws the overlay
+
+#include "Trace.h"
+// Includes the tracer, which records UI frames and the search pipeline as a timeline
+
 #include <imgui.h>
 // Includes the Dear ImGui library, which is used for creating the graphical user interface
 
@@ -19,37 +25,59 @@
 #include <sstream>
 // Includes the string stream class for string manipulation
 
-UserInterface::UserInterface() : showFavorites(false), selectedJob(-1), isSearching(false) {
+UserInterface::UserInterface(const std::string& favoritesPath, const std::string& storePath, const std::string& savedSearchesPath)
+    : countries(getCountries()), fetchedJobs(std::make_shared<JobIndex>()),
+    jobStore(std::make_shared<JobStore>(storePath)), savedSearches(jobSearch, savedSearchesPath), shownSavedSearchVersion(SIZE_MAX), shownMultiSearchVersion(0), currentSearchResults(std::make_shared<const std::vector<Job>>()), favoritesManager(favoritesPath), showFavorites(false), selectedJob(-1), isSearching(false), showProfiler(false) {
     // Constructor for the UserInterface class
     // Initializes showFavorites to false (start in search mode)
     // Initializes selectedJob to -1 (no job selected)
-    // Initializes isSearching to false (not currently searching)
-    countries = { {"Please select a country"},
-        {"Great Britain", "gb", "GBP"},
-        {"Australia", "au", "AUD"},
-        {"Belgium", "be", "EUR"},
-        {"Brazil", "br", "BRL"},
-        {"Canada", "ca", "CAD"},
-        {"Switzerland", "ch", "CHF"},
-        {"Germany", "de", "EUR"},
-        {"Spain", "es", "EUR"},
-        {"France", "fr", "EUR"},
-        {"United Kingdom", "gb", "GBP"},
-        {"India", "in", "INR"},
-        {"Italy", "it", "EUR"},
-        {"Mexico", "mx", "MXN"},
-        {"Netherlands", "nl", "EUR"},
-        {"New Zealand", "nz", "NZD"},
-        {"Poland", "pl", "PLN"},
-        {"Singapore", "sg", "SGD"},
-        {"United States", "us", "USD"},
-        {"South Africa", "za", "ZAR"}
-    };
-    // Initializes the countries vector with country information
-    // Each entry contains the country name, country code, and currency symbol
+    // Initializes isSearching to false (no search in flight)
+
+    jobSearch.setIndex(fetchedJobs);
+    // Every fetched job is indexed as its search completes
+
+    jobSearch.setStore(jobStore);
+    // ...and stored for later sessions
 
     favorites = favoritesManager.loadFavorites();
     // Calls the loadFavorites function to load any previously saved favorite jobs
+
+    publishFavorites();
+    // Share the loaded favorites with the results table
+}
+
+void UserInterface::showResults(std::shared_ptr<const std::vector<Job>> jobs) {
+    // Function to replace the result set shown in search mode
+    std::string selectedUrl;
+    if (!showFavorites && selectedJob >= 0 && selectedJob < (int)currentSearchResults->size()) {
+        selectedUrl = (*currentSearchResults)[selectedJob].url;
+    }
+    // selectedJob indexes the old snapshot; remember the job itself
+
+    currentSearchResults = jobs;
+    resultsTable.setJobs(jobs);
+    descriptionLayout.invalidate();
+    // The replaced snapshot may be freed and its address reused by the new one
+    // New results: the table computes sort keys and row order off the UI thread
+
+    if (!showFavorites) {
+        selectedJob = -1;
+        if (!selectedUrl.empty()) {
+            for (size_t i = 0; i < jobs->size(); i++) {
+                if ((*jobs)[i].url == selectedUrl) {
+                    selectedJob = (int)i;
+                    break;
+                }
+            }
+        }
+    }
+    // Keep the same job selected when a merged snapshot reorders the results (another country arrived),
+    // and clear the selection if it is gone
+}
+
+bool UserInterface::isResultsViewReady() const {
+    // The table is ready once no search is in flight and it shows the latest result snapshot
+    return !activeSearch && !activeMultiSearch && !storedJobsRead && resultsTable.isUpToDate();
 }
 
 void UserInterface::toggleFavorite(const Job& job) {
@@ -59,6 +87,9 @@ void UserInterface::toggleFavorite(const Job& job) {
     // Searches for the job in the favorites list using a lambda function
     // The lambda compares the URL of each favorite job with the URL of the given job
 
+    descriptionLayout.invalidate();
+    // Favorites are edited in place, so a job's address may now hold another job
+
     if (it != favorites.end()) {
         favorites.erase(it);
         // If the job is found in favorites, remove it
@@ -68,31 +99,109 @@ void UserInterface::toggleFavorite(const Job& job) {
         // If the job is not in favorites, add it
     }
 
-    favoritesManager.saveFavorites(favorites);
-    // Save the updated favorites list
+    favoritesManager.saveFavoritesAsync(favorites);
+    // Save the updated favorites list on a background task
+
+    publishFavorites();
+    // Refresh the favorite flags in the results table
 }
 
-std::string formatSalary(double salary, const std::string& currency) {
-    // Function to format a salary with thousands separators and currency symbol
+void UserInterface::publishFavorites() {
+    // Function to rebuild the set of favorite URLs used by the results table (favorites are identified by URL)
+    std::shared_ptr<std::unordered_set<std::string>> favoriteUrls = std::make_shared<std::unordered_set<std::string>>();
+    for (const Job& fav : favorites) {
+        favoriteUrls->insert(fav.url);
+    }
+    resultsTable.setFavorites(favoriteUrls);
+    // The favorite flags of the rows are refreshed on the view-model worker
+}
 
-    std::string strSalary = std::to_string((int)(salary));
+std::vector<UserInterface::CountryInfo> UserInterface::getCountries() {
+    // Function to list the countries the API serves
+    return { {"Please select a country"},
+        {"All countries", "", ""},
+        {"Great Britain", "gb", "GBP"},
+        {"Australia", "au", "AUD"},
+        {"Belgium", "be", "EUR"},
+        {"Brazil", "br", "BRL"},
+        {"Canada", "ca", "CAD"},
+        {"Switzerland", "ch", "CHF"},
+        {"Germany", "de", "EUR"},
+        {"Spain", "es", "EUR"},
+        {"France", "fr", "EUR"},
+        {"United Kingdom", "gb", "GBP"},
+        {"India", "in", "INR"},
+        {"Italy", "it", "EUR"},
+        {"Mexico", "mx", "MXN"},
+        {"Netherlands", "nl", "EUR"},
+        {"New Zealand", "nz", "NZD"},
+        {"Poland", "pl", "PLN"},
+        {"Singapore", "sg", "SGD"},
+        {"United States", "us", "USD"},
+        {"South Africa", "za", "ZAR"}
+    };
+    // Each entry contains the country name, country code, and currency symbol
+    // "All countries" has no code: it searches every country and shows the salaries in the currency chosen for it
+}
 
-    int length = (int)strSalary.length();
-    int insertPosition = length - 3;
-    while (insertPosition > 0) {
-        strSalary.insert(insertPosition, ",");
-        insertPosition -= 3;
+std::vector<CountryTarget> UserInterface::getSearchTargets(const std::vector<CountryInfo>& countries) {
+    // Function to collect the distinct country codes; "Great Britain" and "United Kingdom" are both gb
+    std::vector<CountryTarget> targets;
+    std::unordered_set<std::string> codes;
+    for (const CountryInfo& country : countries) {
+        if (!country.code.empty() && codes.insert(country.code).second) {
+            targets.push_back({ country.code, country.currencySymbol });
+        }
     }
-    // Inserts thousands separators (commas) into the salary string
+    return targets;
+}
 
-    return strSalary + " " + currency;
-    // Returns the formatted salary string with the currency symbol appended
+void UserInterface::indexStoredJobs() {
+    // Function to stream the stored jobs into the full-text index, once per session
+    if (storedJobsIndexed) return;
+    std::shared_ptr<std::atomic<bool>> done = std::make_shared<std::atomic<bool>>(false);
+    storedJobsIndexed = done;
+
+    std::shared_ptr<JobIndex> index = fetchedJobs;
+    std::shared_ptr<JobStore> store = jobStore;
+    TaskScheduler::shared().submit([index, store, done]() {
+        store->readRecent(SIZE_MAX, 1000, [&index](std::vector<Job>& batch) {
+            index->add(batch);
+        });
+        // One batch decoded at a time, so the store is never held in memory, and a local search typed meanwhile
+        // waits for one batch at most
+        done->store(true, std::memory_order_release);
+    }, TaskPriorityLow);
 }
 
 void UserInterface::render() {
     // Function to render the user interface
+    PROFILE_SCOPE("UserInterface::render");
+    TRACE_SCOPE("UserInterface::render", "ui");
 
-    isSearching = jobSearch.getSearchRequested();
+    if (activeSearch && activeSearch->isDone()) {
+        showResults(activeSearch->getResults());
+        searchError = activeSearch->getError();
+        activeSearch.reset();
+    }
+    // Pick up the results once the search finished; a lock-free status check, no polling of the engine
+
+    if (activeMultiSearch && activeMultiSearch->getVersion() != shownMultiSearchVersion) {
+        shownMultiSearchVersion = activeMultiSearch->getVersion();
+        showResults(activeMultiSearch->getResults());
+        if (shownMultiSearchVersion == activeMultiSearch->getCountryCount()) {
+            searchError = currentSearchResults->empty() ? activeMultiSearch->getError() : std::string();
+            activeMultiSearch.reset();
+        }
+    }
+    // Show the merged results each time another country arrives; the snapshot is at least as new as the version
+
+    if (storedJobsRead && storedJobsRead->done.load(std::memory_order_acquire)) {
+        showResults(storedJobsRead->jobs);
+        storedJobsRead.reset();
+    }
+    // Show the stored jobs once the worker has read them
+    isSearching = activeSearch != nullptr || activeMultiSearch != nullptr || storedJobsRead != nullptr;
 
     ImGui::SetNextWindowPos(ImVec2(0, 0));
     ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
@@ -144,6 +253,14 @@ void UserInterface::render() {
             ImGui::EndCombo();
         }
 
+        static const char* currencies[] = { "USD", "EUR", "GBP", "AUD", "CAD", "CHF", "INR", "NZD", "PLN", "SGD", "ZAR", "BRL", "MXN" };
+        static int currencyIndex = 0;
+        const bool allCountries = countryIndex != 0 && countries[countryIndex].code.empty();
+        if (allCountries) {
+            ImGui::Combo("Currency", &currencyIndex, currencies, IM_ARRAYSIZE(currencies));
+        }
+        // Salaries from every country are converted to one currency, which the salary range is also given in
+
         ImGui::Combo("Salary Range", &salaryIndex, salaryRanges, IM_ARRAYSIZE(salaryRanges));
         // Create a combo box for salary range selection
 
@@ -155,9 +272,33 @@ void UserInterface::render() {
             // If the Search button is clicked
             if (strlen(searchBuffer) > 0 && countryIndex != 0) {
                 // If a job title is entered and a country is selected
-                std::string salaryRange = salaryRanges[salaryIndex];
-                jobSearch.searchJobs(searchBuffer, countries[countryIndex].code, salaryRange, resultsPerPage, countries[countryIndex].currencySymbol);
+                SearchRequest request;
+                request.query = searchBuffer;
+                request.country = countries[countryIndex].code;
+                request.salaryRange = salaryRanges[salaryIndex];
+                request.resultsPerPage = resultsPerPage;
+                request.currencySymbol = countries[countryIndex].currencySymbol;
+
+                if (activeSearch) {
+                    activeSearch->cancel();
+                    activeSearch.reset();
+                }
+                activeMultiSearch.reset();
+                storedJobsRead.reset();
+                // The new search supersedes the one still in flight (dropping a multi-country search cancels it)
+
+                if (allCountries) {
+                    activeMultiSearch = std::make_shared<MultiCountrySearch>(jobSearch, request, getSearchTargets(countries), currencies[currencyIndex]);
+                    shownMultiSearchVersion = 0;
+                }
+                // Search every country at once and merge the results as they arrive
+                else {
+                    activeSearch = jobSearch.searchJobs(request);
+                }
                 // Initiate a job search with the specified parameters
+                showResults(std::make_shared<const std::vector<Job>>());
+                searchError.clear();
+                // Clear the previous search results
                 selectedJob = -1;  // Reset selected job
             }
             else {
@@ -178,36 +319,175 @@ void UserInterface::render() {
             selectedJob = -1;  // Reset selected job
         }
 
+        static const char* refreshIntervals[] = { "Every 15 minutes", "Every hour", "Every 6 hours", "Every day" };
+        static const int refreshMinutes[] = { 15, 60, 360, 1440 };
+        static int refreshIndex = 1;
+        ImGui::SameLine();
+        ImGui::BeginDisabled(allCountries);
+        if (ImGui::Button("Save Search")) {
+            if (strlen(searchBuffer) > 0 && countryIndex != 0) {
+                SearchRequest request;
+                request.query = searchBuffer;
+                request.country = countries[countryIndex].code;
+                request.salaryRange = salaryRanges[salaryIndex];
+                request.currencySymbol = countries[countryIndex].currencySymbol;
+                std::string name = std::string(searchBuffer) + " in " + countries[countryIndex].name;
+                if (request.salaryRange != "Any") {
+                    name += " (" + request.salaryRange + " " + request.currencySymbol + ")";
+                }
+                savedSearches.add(name, request, refreshMinutes[refreshIndex]);
+            }
+            else if (strlen(searchBuffer) == 0) {
+                ImGui::OpenPopup("Search Error");
+            }
+            else {
+                ImGui::OpenPopup("Country Error");
+            }
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(150);
+        ImGui::Combo("##RefreshInterval", &refreshIndex, refreshIntervals, IM_ARRAYSIZE(refreshIntervals));
+        ImGui::EndDisabled();
+        // Save the search to be refreshed in the background; each refresh fetches only the postings published
+        // since the last one (one country at a time)
+
+        static char localQueryBuffer[256] = "";
+        ImGui::InputText("Fetched Jobs", localQueryBuffer, 256);
+        if (ImGui::IsItemActivated()) {
+            indexStoredJobs();
+        }
+        // Opening the store only mapped its files; the jobs of earlier sessions are indexed when a local search is
+        // first typed, so a session that never searches locally never decodes them
+        ImGui::SameLine();
+        if (ImGui::Button("Search Fetched") && strlen(localQueryBuffer) > 0) {
+            indexStoredJobs();
+            if (activeSearch) {
+                activeSearch->cancel();
+                activeSearch.reset();
+            }
+            activeMultiSearch.reset();
+            storedJobsRead.reset();
+            // The local results replace whatever was in flight
+
+            showResults(std::make_shared<const std::vector<Job>>(fetchedJobs->search(localQueryBuffer, 500)));
+            searchError.clear();
+            selectedJob = -1;
+        }
+        // Search the title, company, category and description of every job fetched so far, ranked by BM25,
+        // without an API request
+        if (storedJobsIndexed && !storedJobsIndexed->load(std::memory_order_acquire)) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("Indexing stored jobs...");
+        }
+        // Until then a local search covers the stored jobs indexed so far
+
+        if (ImGui::Button("Browse Stored")) {
+            if (activeSearch) {
+                activeSearch->cancel();
+                activeSearch.reset();
+            }
+            activeMultiSearch.reset();
+
+            std::shared_ptr<StoredJobsRead> read = std::make_shared<StoredJobsRead>();
+            std::shared_ptr<JobStore> store = jobStore;
+            TaskScheduler::shared().submit([read, store]() {
+                read->jobs = std::make_shared<const std::vector<Job>>(store->readRecent(SIZE_MAX));
+                read->done.store(true, std::memory_order_release);
+            }, TaskPriorityNormal);
+            storedJobsRead = read;
+            // Decoding a large store takes a moment, so it happens on a worker
+
+            showResults(std::make_shared<const std::vector<Job>>());
+            searchError.clear();
+            selectedJob = -1;
+        }
+        ImGui::SameLine();
+        ImGui::Text("%d jobs stored (%.1f MB)", (int)jobStore->getRecordCount(), jobStore->getByteCount() / 1048576.0);
+        // Every job fetched in any session, newest first, in the table with its filter, sort and facets: offline
+        // browsing and analysis without an API request
+
+        if (savedSearches.getVersion() != shownSavedSearchVersion) {
+            shownSavedSearchVersion = savedSearches.getVersion();
+            savedSearchList = savedSearches.list();
+        }
+        // Copied only when a saved search changed, not every frame
+
+        if (!savedSearchList.empty() && ImGui::CollapsingHeader("Saved Searches")) {
+            const std::time_t now = std::time(nullptr);
+            for (const SavedSearchInfo& saved : savedSearchList) {
+                ImGui::PushID((int)saved.id);
+                char label[64];
+                std::snprintf(label, sizeof(label), saved.newCount > 0 ? "%d new###Show" : "No new jobs###Show", (int)saved.newCount);
+                ImGui::BeginDisabled(saved.newCount == 0);
+                if (ImGui::Button(label)) {
+                    if (activeSearch) {
+                        activeSearch->cancel();
+                        activeSearch.reset();
+                    }
+                    activeMultiSearch.reset();
+                    storedJobsRead.reset();
+
+                    showResults(savedSearches.takeNewJobs(saved.id));
+                    searchError.clear();
+                    selectedJob = -1;
+                }
+                // Show the postings found since they were last shown, newest first
+                ImGui::EndDisabled();
+
+                ImGui::SameLine();
+                ImGui::TextUnformatted(saved.name.c_str());
+                ImGui::SameLine();
+                if (saved.refreshing) {
+                    ImGui::TextDisabled("(checking...)");
+                }
+                else if (!saved.error.empty()) {
+                    ImGui::TextDisabled("(last check failed: %s)", saved.error.c_str());
+                }
+                else if (saved.lastRefresh != 0) {
+                    ImGui::TextDisabled("(checked %d min ago, every %d min)", (int)(std::difftime(now, saved.lastRefresh) / 60), saved.intervalMinutes);
+                }
+
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Refresh")) {
+                    savedSearches.refreshNow(saved.id);
+                }
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Remove")) {
+                    savedSearches.remove(saved.id);
+                }
+                ImGui::PopID();
+            }
+        }
+        // Saved searches with the number of new postings their background refreshes found
+
         ImGui::Separator();
         // Add a separator line
 
         ImGui::Columns(2, "JobColumns", true);
 
         // Create two columns for the layout
-        if (isSearching) {
+        if (activeMultiSearch) {
+            ImGui::Text("Searching... %d of %d countries done, %d jobs so far", (int)shownMultiSearchVersion,
+                (int)activeMultiSearch->getCountryCount(), (int)currentSearchResults->size());
+        }
+        else if (storedJobsRead) {
+            ImGui::Text("Reading stored jobs...");
+        }
+        else if (isSearching) {
             ImGui::Text("Searching...");
         }
+        else if (!searchError.empty()) {
+            ImGui::Text("Search failed: %s", searchError.c_str());
+        }
         else {
-            currentSearchResults = jobSearch.getResults();
-            isSearching = false;
-            ImGui::Text("Displaying %d jobs", currentSearchResults.size());
+            ImGui::Text("Displaying %d jobs", (int)currentSearchResults->size());
         }
 
-        ImGui::BeginChild("JobList", ImVec2(0, 0), true);
-        for (int i = 0; i < currentSearchResults.size(); i++) {
-            const auto& job = currentSearchResults[i];
-            bool isFavorite = std::find_if(favorites.begin(), favorites.end(),
-                [&job](const Job& fav) { return fav.url == job.url; }) != favorites.end();
-            if (ImGui::Checkbox(("##" + std::to_string(i)).c_str(), &isFavorite)) {
-                toggleFavorite(job);
-            }
-            ImGui::SameLine();
-            if (ImGui::Selectable((job.title + "##" + std::to_string(i)).c_str(), selectedJob == i)) {
-                selectedJob = i;
-            }
+        {
+            PROFILE_SCOPE("ResultsTable::render");
+            resultsTable.render(selectedJob, [this](const Job& job) { toggleFavorite(job); });
         }
-        // Render the list of search results, allowing toggling of favorites and selection of jobs
-        ImGui::EndChild();
+        // Render the results table, allowing sorting, filtering, toggling of favorites and selection of jobs
     }
 
     else {
@@ -241,8 +521,12 @@ void UserInterface::render() {
                 }
             }
             // Remove selected favorites
-            favoritesManager.saveFavorites(favorites);
-            // Save the updated favorites list
+            descriptionLayout.invalidate();
+            // The remaining favorites moved inside the vector
+            favoritesManager.saveFavoritesAsync(favorites);
+            // Save the updated favorites list on a background task
+            publishFavorites();
+            // Refresh the favorite flags in the results table
             if (selectedJob >= favorites.size()) {
                 selectedJob = -1;
             }
@@ -275,8 +559,8 @@ void UserInterface::render() {
     if (showFavorites && selectedJob >= 0 && selectedJob < favorites.size()) {
         selectedJobPtr = &favorites[selectedJob];
     }
-    else if (!showFavorites && selectedJob >= 0 && selectedJob < currentSearchResults.size()) {
-        selectedJobPtr = &currentSearchResults[selectedJob];
+    else if (!showFavorites && selectedJob >= 0 && selectedJob < (int)currentSearchResults->size()) {
+        selectedJobPtr = &(*currentSearchResults)[selectedJob];
     }
     // Determine which job is currently selected
 
@@ -296,7 +580,11 @@ void UserInterface::render() {
         ImGui::Separator();
 
         ImGui::TextWrapped("Description:");
-        ImGui::TextWrapped("%s", job.description.c_str());
+        {
+            PROFILE_SCOPE("Description layout");
+            descriptionLayout.render(job.description, selectedJobPtr);
+        }
+        // Render the description from the cached layout instead of re-wrapping it every frame
 
         if (ImGui::Button("Apply for this job")) {
             ShellExecuteA(0, "open", job.url.c_str(), 0, 0, SW_SHOW);
@@ -313,4 +601,34 @@ void UserInterface::render() {
 
     ImGui::End();
     // End the main ImGui window
+
+    bool profilerWasShown = showProfiler;
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+        showProfiler = !showProfiler;
+    }
+    if (showProfiler) {
+        Profiler::renderOverlay(&showProfiler);
+    }
+    if (showProfiler != profilerWasShown) {
+        Profiler::setEnabled(showProfiler);
+    }
+    // Toggle the profiler overlay with F3; profiling only runs while the overlay is open
+
+    if (ImGui::IsKeyPressed(ImGuiKey_F4, false)) {
+        if (!Trace::isEnabled()) {
+            Trace::start();
+            std::cout << "Tracing started, press F4 again to save trace.json" << std::endl;
+        }
+        else {
+            Trace::stop();
+            if (Trace::writeChromeJson("trace.json")) {
+                std::cout << "Saved " << Trace::getEventCount() << " trace events to trace.json ("
+                    << Trace::getDroppedCount() << " dropped). Open it in ui.perfetto.dev or chrome://tracing" << std::endl;
+            }
+            else {
+                std::cerr << "Failed to write trace.json" << std::endl;
+            }
+        }
+    }
+    // Start and stop tracing with F4; the timeline is written when tracing stops
 }
@@ -2,19 +2,38 @@
 // Prevents multiple inclusions of this header file
 #include "JobSearch.h"
 // Includes the JobSearch header file - contains the JobSearch class definition
+#include "MultiCountrySearch.h"
+// Includes the MultiCountrySearch header file - searches every country at once and merges the results
 #include "FavoritesManager.h"
 // Includes the FavoritesManager header file - contains the FavoritesManager class definition
+#include "TextLayoutCache.h"
+// Includes the TextLayoutCache header file - caches the wrapped layout of long job descriptions
+#include "ResultsTable.h"
+// Includes the ResultsTable header file - sortable, filterable table of search results
+#include "SavedSearches.h"
+// Includes the SavedSearches header file - saved searches refreshed in the background
 #include <vector>
 #include <string>
 
 class UserInterface {
 public:
-    UserInterface();
-    // Constructor for the UserInterface class
+    explicit UserInterface(const std::string& favoritesPath = "favorites.json", const std::string& storePath = "jobstore",
+        const std::string& savedSearchesPath = "saved_searches.json");
+    // Constructor for the UserInterface class, with the file used for saving/loading favorites, the directory
+    // every fetched job is stored in and the file the saved searches are kept in
 
     void render();
     // Function to render the user interface
 
+    void showResults(std::shared_ptr<const std::vector<Job>> jobs);
+    // Function to show a result set in search mode (also used by the headless benchmark to inject results)
+
+    bool isResultsViewReady() const;
+    // Function to check whether the results table shows the latest results
+
+    void toggleFavorite(const Job& job);
+    // Function to toggle a job's favorite status (public for the benchmarks)
+
 private:
     struct CountryInfo {
         std::string name;
@@ -29,8 +48,55 @@ private:
     JobSearch jobSearch;
     // Instance of the JobSearch class to perform job searches
 
-    std::vector<Job> currentSearchResults;
-    // Vector to store the current search results
+    std::shared_ptr<SearchHandle> activeSearch;
+    // Search in flight, if any
+
+    std::shared_ptr<JobIndex> fetchedJobs;
+    // Full-text index of every job fetched, this session and stored from earlier ones, for searches that need no
+    // API request
+
+    std::shared_ptr<JobStore> jobStore;
+    // Every job fetched in any session, on disk, for offline browsing
+
+    struct StoredJobsRead {
+        std::atomic<bool> done;
+        // Set once jobs is filled
+        std::shared_ptr<const std::vector<Job>> jobs;
+        // The stored jobs, most recently stored first
+
+        StoredJobsRead() : done(false) {}
+    };
+    // Stored jobs being read on a worker
+
+    std::shared_ptr<StoredJobsRead> storedJobsRead;
+    // Read of the stored jobs in flight, if any
+
+    std::shared_ptr<std::atomic<bool>> storedJobsIndexed;
+    // Set once the stored jobs are in fetchedJobs; nullptr until the first local search asks for them
+
+    SavedSearches savedSearches;
+    // Saved searches and their background refreshes; declared after jobSearch, which must outlive it
+
+    std::vector<SavedSearchInfo> savedSearchList;
+    // Copy of the saved searches shown in the list
+
+    size_t shownSavedSearchVersion;
+    // Version of the saved searches savedSearchList was copied at
+
+    std::shared_ptr<MultiCountrySearch> activeMultiSearch;
+    // All-countries search in flight, if any
+
+    size_t shownMultiSearchVersion;
+    // Number of countries merged into the results shown
+
+    std::string searchError;
+    // Error of the last search, empty if it succeeded
+
+    std::shared_ptr<const std::vector<Job>> currentSearchResults;
+    // Snapshot of the current search results
+
+    ResultsTable resultsTable;
+    // Table view of the current search results
 
     FavoritesManager favoritesManager;
     // Instance of the FavoritesManager class to manage favorite jobs
@@ -45,9 +111,24 @@ private:
     // Index of the currently selected job
 
     bool isSearching;
-    // Flag to indicate if a search is in progress
+    // Flag to indicate if a search is in flight
 
-    void toggleFavorite(const Job& job);
-    // Function to toggle a job's favorite status
+    TextLayoutCache descriptionLayout;
+    // Wrapped layout of the selected job's description, reused across frames
+
+    bool showProfiler;
+    // Flag to indicate whether the profiler overlay is open (toggled with F3)
+
+    void publishFavorites();
+    // Function to hand the current favorites set to the results table
+
+    void indexStoredJobs();
+    // Function to start adding the stored jobs to fetchedJobs in the background, the first time it is called
+
+    static std::vector<CountryInfo> getCountries();
+    // Function to list the countries of the country combo, in the order shown
+
+    static std::vector<CountryTarget> getSearchTargets(const std::vector<CountryInfo>& countries);
+    // Function to get the countries an all-countries search covers, each code once
 
 };
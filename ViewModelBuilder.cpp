@@ -0,0 +1,341 @@
+#include "ViewModelBuilder.h"
+// Includes the header file for the ViewModelBuilder class
+
+#include "Collation.h"
+// Includes the collation key helpers used for case-insensitive sorting and filtering
+
+#include "Trace.h"
+// Includes the tracer, which records view-model builds in the timeline
+
+#include "TaskScheduler.h"
+// Includes the shared task scheduler the builds run on
+
+#include <algorithm>
+// Includes the C++ Standard Template Library algorithms
+
+#include <atomic>
+// Includes the atomic shared_ptr functions used to publish view models
+
+std::string formatSalary(double salary, const std::string& currency) {
+    // Function to format a salary with thousands separators and currency symbol
+
+    std::string strSalary = std::to_string((int)(salary));
+
+    int length = (int)strSalary.length();
+    int insertPosition = length - 3;
+    while (insertPosition > 0) {
+        strSalary.insert(insertPosition, ",");
+        insertPosition -= 3;
+    }
+    // Inserts thousands separators (commas) into the salary string
+
+    return strSalary + " " + currency;
+    // Returns the formatted salary string with the currency symbol appended
+}
+
+ViewModelBuilder::ViewModelBuilder() : buildScheduled(false), inputsChanged(false) {
+    // Constructor for the ViewModelBuilder class
+    // Starts in API order (no sort column) with an empty filter
+    inputs.sortColumn = -1;
+    inputs.ascending = true;
+    inputs.collapseDuplicates = true;
+    keys.fuzzyIndexed = false;
+}
+
+ViewModelBuilder::~ViewModelBuilder() {
+    // Destructor: drop pending inputs and wait for a running build to finish
+    std::unique_lock<std::mutex> lock(inputMutex);
+    inputsChanged = false;
+    cv.wait(lock, [this] { return !buildScheduled; });
+}
+
+void ViewModelBuilder::setJobs(std::shared_ptr<const std::vector<Job>> jobs) {
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        inputs.jobs = std::move(jobs);
+        inputsChanged = true;
+    }
+    scheduleBuild();
+}
+
+void ViewModelBuilder::setFavorites(std::shared_ptr<const std::unordered_set<std::string>> favoriteUrls) {
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        inputs.favoriteUrls = std::move(favoriteUrls);
+        inputsChanged = true;
+    }
+    scheduleBuild();
+}
+
+void ViewModelBuilder::setSort(int column, bool ascending) {
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        inputs.sortColumn = column;
+        inputs.ascending = ascending;
+        inputsChanged = true;
+    }
+    scheduleBuild();
+}
+
+void ViewModelBuilder::setFilter(const std::string& filter) {
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        inputs.filter = filter;
+        inputsChanged = true;
+    }
+    scheduleBuild();
+}
+
+void ViewModelBuilder::setFacets(const FacetSelection& selection) {
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        inputs.facets = selection;
+        inputsChanged = true;
+    }
+    scheduleBuild();
+}
+
+void ViewModelBuilder::setCollapseDuplicates(bool collapse) {
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        inputs.collapseDuplicates = collapse;
+        inputsChanged = true;
+    }
+    scheduleBuild();
+}
+
+void ViewModelBuilder::scheduleBuild() {
+    // Function to queue a build task unless one is already queued or running
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        if (buildScheduled) return;
+        // The running build picks up the new inputs when it finishes
+        buildScheduled = true;
+    }
+    TaskScheduler::shared().submit([this]() { runBuilds(); }, TaskPriorityNormal);
+}
+
+std::shared_ptr<const ResultsViewModel> ViewModelBuilder::getViewModel() const {
+    // Function to get the latest view model with an atomic pointer load (no lock shared with the worker)
+    return std::atomic_load(&published);
+}
+
+void ViewModelBuilder::runBuilds() {
+    // Function that runs as a task on the scheduler
+    while (true) {
+        std::unique_lock<std::mutex> lock(inputMutex);
+        if (!inputsChanged) {
+            buildScheduled = false;
+            cv.notify_all();
+            return;
+        }
+        // Nothing new: let the next input change queue a new task
+
+        Inputs current = inputs;
+        inputsChanged = false;
+        lock.unlock();
+        // Build from a copy of the inputs; changes made meanwhile are coalesced into the next build
+
+        std::shared_ptr<const ResultsViewModel> viewModel = buildViewModel(current);
+        std::atomic_store(&published, viewModel);
+        // Publish the new view model by swapping the pointer
+    }
+}
+
+std::shared_ptr<ResultsViewModel> ViewModelBuilder::buildViewModel(const Inputs& current) {
+    // Function to turn the inputs into render-ready rows
+    TRACE_SCOPE("ViewModelBuilder::buildViewModel", "view model");
+    std::shared_ptr<ResultsViewModel> viewModel = std::make_shared<ResultsViewModel>();
+    viewModel->jobs = current.jobs;
+    if (!current.jobs) return viewModel;
+
+    if (current.jobs != keyedJobs) {
+        buildSortKeys(*current.jobs);
+        keyedJobs = current.jobs;
+        // Keys are computed once per snapshot and reused for every sort and filter change
+    }
+    if (!keys.fuzzyIndexed && TrigramIndex::getMaxEdits(makeCollationKey(current.filter).size()) > 0) {
+        buildFuzzyIndex();
+    }
+    // Most snapshots are never filtered with a long enough needle, so the trigrams wait for the first one
+
+    const std::vector<Job>& jobs = *current.jobs;
+    std::vector<int> order = buildOrder(current, viewModel->facets);
+
+    std::vector<int> similarCounts;
+    if (current.collapseDuplicates) {
+        std::vector<int> groupRow(jobs.size(), -1);
+        similarCounts.assign(jobs.size(), 0);
+        size_t kept = 0;
+        for (size_t i = 0; i < order.size(); i++) {
+            uint32_t group = keys.duplicateOf[order[i]];
+            if (groupRow[group] >= 0) {
+                similarCounts[groupRow[group]]++;
+                continue;
+            }
+            groupRow[group] = (int)kept;
+            order[kept++] = order[i];
+        }
+        order.resize(kept);
+    }
+    // The first row of a group in display order stands for the group; the others are counted on it, so the
+    // badge counts only the postings that pass the filter
+
+    viewModel->rows.reserve(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        const Job& job = jobs[order[i]];
+        JobRow row;
+        row.jobIndex = order[i];
+        row.job = &job;
+        row.salaryText = job.salary == 0.0 ? "Not Specified" : formatSalary(job.salary, job.salaryCurrency);
+        row.favorite = current.favoriteUrls && current.favoriteUrls->count(job.url) > 0;
+        row.similarCount = similarCounts.empty() ? 0 : similarCounts[i];
+        if (row.similarCount > 0) {
+            row.similarText = std::to_string(row.similarCount) + (row.similarCount == 1 ? " similar posting" : " similar postings");
+        }
+        viewModel->rows.push_back(std::move(row));
+    }
+    // Formatting and favorite lookups are done here once, not per frame
+
+    return viewModel;
+}
+
+void ViewModelBuilder::buildSortKeys(const std::vector<Job>& source) {
+    // Function to precompute the sort keys of every job in a snapshot
+    const size_t count = source.size();
+    for (int column = 0; column < ColumnCount; column++) {
+        keys.text[column].clear();
+        keys.prefix[column].clear();
+    }
+    keys.salary.resize(count);
+    keys.fuzzy.clear();
+    keys.fuzzyIndexed = false;
+
+    const int textColumns[] = { ColumnTitle, ColumnCompany, ColumnLocation, ColumnContractType, ColumnCategory };
+    for (int column : textColumns) {
+        keys.text[column].resize(count);
+        keys.prefix[column].resize(count);
+    }
+
+    std::vector<std::string> descriptions(count);
+    parallelFor(count, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Job& job = source[i];
+            keys.text[ColumnTitle][i] = makeCollationKey(job.title);
+            keys.text[ColumnCompany][i] = makeCollationKey(job.company);
+            keys.text[ColumnLocation][i] = makeCollationKey(job.location);
+            keys.text[ColumnContractType][i] = makeCollationKey(job.contractType);
+            keys.text[ColumnCategory][i] = makeCollationKey(job.category);
+            for (int column : textColumns) {
+                keys.prefix[column][i] = collationPrefix(keys.text[column][i]);
+            }
+            keys.salary[i] = job.salary;
+            descriptions[i] = makeCollationKey(job.description);
+        }
+    });
+    // Every job writes only its own slots, so chunks of jobs are keyed in parallel across the workers
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        for (int column : textColumns) {
+            bytes += keys.text[column][i].size() + 1;
+        }
+        bytes += descriptions[i].size() + 1;
+    }
+    keys.filterText.clear();
+    keys.filterText.reserve(count, bytes);
+    for (size_t i = 0; i < count; i++) {
+        keys.filterText.addRecord();
+        for (int column : textColumns) {
+            keys.filterText.addField(keys.text[column][i]);
+        }
+        keys.filterText.addField(descriptions[i]);
+    }
+    // Copied into one block so a filter is a single sequential scan instead of a search per field
+
+    keys.duplicateOf = duplicates.group(source);
+    keys.facets.build(source);
+}
+
+void ViewModelBuilder::buildFuzzyIndex() {
+    // Function to index the title and company keys of the snapshot, in job order
+    TRACE_SCOPE("ViewModelBuilder::buildFuzzyIndex", "view model");
+    const size_t count = keys.text[ColumnTitle].size();
+    for (size_t i = 0; i < count; i++) {
+        keys.fuzzy.add(keys.text[ColumnTitle][i]);
+        keys.fuzzy.add(keys.text[ColumnCompany][i]);
+    }
+    keys.fuzzyIndexed = true;
+}
+
+std::vector<int> ViewModelBuilder::buildOrder(const Inputs& current, std::vector<FacetValue> (&facets)[FacetCount]) {
+    // Function to filter and sort the job indices of the current snapshot
+    const int count = (int)current.jobs->size();
+    std::vector<int> rows;
+    rows.reserve(count);
+
+    RoaringBitmap matching;
+    if (current.filter.empty()) {
+        matching = keys.facets.apply(nullptr, current.facets, 8, facets);
+        // Unfiltered: the matches and counts of a selection come from the facet cache
+    }
+    else {
+        const std::string needle = makeCollationKey(current.filter);
+        std::vector<uint32_t> fuzzy;
+        int maxEdits = TrigramIndex::getMaxEdits(needle.size());
+        if (maxEdits > 0 && keys.fuzzyIndexed) {
+            fuzzy = keys.fuzzy.find(needle, maxEdits);
+        }
+        // Titles and companies within a typo or two of the filter ("sofware engineer", "goggle")
+
+        const std::vector<uint32_t> exact = keys.filterText.findRecords(needle);
+        // Rows where any text column or the description contains the filter, case-insensitively
+
+        size_t nextExact = 0;
+        size_t nextFuzzy = 0;
+        for (int i = 0; i < count; i++) {
+            while (nextFuzzy < fuzzy.size() && fuzzy[nextFuzzy] < 2 * (uint32_t)i) {
+                nextFuzzy++;
+            }
+            bool matched = nextFuzzy < fuzzy.size() && fuzzy[nextFuzzy] / 2 == (uint32_t)i;
+            if (nextExact < exact.size() && exact[nextExact] == (uint32_t)i) {
+                matched = true;
+                nextExact++;
+            }
+            if (matched) {
+                rows.push_back(i);
+            }
+        }
+        // Both lists are in job order, so one pass merges them
+
+        const RoaringBitmap candidates = RoaringBitmap::fromSorted(std::vector<uint32_t>(rows.begin(), rows.end()));
+        matching = keys.facets.apply(&candidates, current.facets, 8, facets);
+        rows.clear();
+        // Narrow the filtered rows by the selected facet values; the counts are of the filtered rows
+    }
+    matching.forEach([&rows](uint32_t i) { rows.push_back((int)i); });
+
+    const int column = current.sortColumn;
+    const bool ascending = current.ascending;
+    if (column == ColumnSalary) {
+        const std::vector<double>& salary = keys.salary;
+        std::sort(rows.begin(), rows.end(), [&](int a, int b) {
+            if (salary[a] != salary[b]) return ascending ? salary[a] < salary[b] : salary[a] > salary[b];
+            return a < b;
+        });
+    }
+    else if (column > ColumnFavorite && column < ColumnCount) {
+        const std::vector<uint64_t>& prefix = keys.prefix[column];
+        const std::vector<std::string>& text = keys.text[column];
+        std::sort(rows.begin(), rows.end(), [&](int a, int b) {
+            if (prefix[a] != prefix[b]) return ascending ? prefix[a] < prefix[b] : prefix[a] > prefix[b];
+            int order = text[a].compare(text[b]);
+            if (order != 0) return ascending ? order < 0 : order > 0;
+            return a < b;
+        });
+        // Compare the integer prefixes first and only fall back to the full keys on ties
+    }
+    // Ties keep API order so the result is deterministic
+
+    return rows;
+}
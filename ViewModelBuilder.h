@@ -0,0 +1,174 @@
+#pragma once
+// Prevents multiple inclusions of this header file
+
+#include "Job.h"
+// Includes the Job header file - contains the Job struct definition
+
+#include "TrigramIndex.h"
+// Includes the trigram index used for typo-tolerant filtering
+
+#include "TextArena.h"
+// Includes the text arena scanned by the results filter
+
+#include "DuplicateDetector.h"
+// Includes the near-duplicate detection that collapses reposted jobs
+
+#include "FacetEngine.h"
+// Includes the facet counts shown next to the results
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+std::string formatSalary(double salary, const std::string& currency);
+// Function to format a salary with thousands separators and currency symbol
+
+struct JobRow {
+    int jobIndex;
+    // Index of the job inside the view model's snapshot
+    const Job* job;
+    // The job itself (owned by the view model's snapshot)
+    std::string salaryText;
+    // Preformatted salary, or "Not Specified"
+    bool favorite;
+    // Whether the job is in the favorites set
+    int similarCount;
+    // Number of near-duplicate postings collapsed into this row
+    std::string similarText;
+    // Preformatted "N similar postings" badge, empty when similarCount is 0
+};
+// One render-ready row of the results table
+
+struct ResultsViewModel {
+    std::shared_ptr<const std::vector<Job>> jobs;
+    // Result snapshot the rows point into
+    std::vector<JobRow> rows;
+    // Filtered rows in display order
+    std::vector<FacetValue> facets[FacetCount];
+    // Most frequent values of each facet field among the filtered jobs, with their counts
+};
+// Everything the UI needs to draw the results table, built off the UI thread
+
+class ViewModelBuilder {
+public:
+    enum Column {
+        ColumnFavorite,
+        ColumnTitle,
+        ColumnCompany,
+        ColumnLocation,
+        ColumnSalary,
+        ColumnContractType,
+        ColumnCategory,
+        ColumnCount
+    };
+    // Columns of the results table, also used as ImGui column user ids
+
+    ViewModelBuilder();
+    // Constructor for the ViewModelBuilder class
+
+    ~ViewModelBuilder();
+    // Destructor: waits for a build still running on the task scheduler
+
+    void setJobs(std::shared_ptr<const std::vector<Job>> jobs);
+    // Sets the result snapshot to show
+
+    void setFavorites(std::shared_ptr<const std::unordered_set<std::string>> favoriteUrls);
+    // Sets the favorites set (job URLs)
+
+    void setSort(int column, bool ascending);
+    // Sets the sort column (-1 for API order) and direction
+
+    void setFilter(const std::string& filter);
+    // Sets the local filter text
+
+    void setFacets(const FacetSelection& selection);
+    // Sets the selected facet values
+
+    void setCollapseDuplicates(bool collapse);
+    // Sets whether near-duplicate postings are shown as one row
+
+    std::shared_ptr<const ResultsViewModel> getViewModel() const;
+    // Returns the latest published view model; never blocks on a build
+
+private:
+    struct SortKeys {
+        std::vector<std::string> text[ColumnCount];
+        // Collation keys of the string columns
+        std::vector<uint64_t> prefix[ColumnCount];
+        // Integer prefixes of the collation keys
+        std::vector<double> salary;
+        // Numeric salary column
+        TextArena filterText;
+        // Collation keys of every text column and the description, one record per job, for the filter
+        TrigramIndex fuzzy;
+        // Trigrams of the title and company keys (text 2 * job is the title, 2 * job + 1 the company)
+        bool fuzzyIndexed;
+        // Flag to indicate fuzzy has been built; it is built on the first filter that needs it
+        std::vector<uint32_t> duplicateOf;
+        // First job of each job's group of near-duplicate postings (the job itself if it has none)
+        FacetEngine facets;
+        // Interned facet fields
+    };
+    // Precomputed keys of one result snapshot, one entry per job
+
+    struct Inputs {
+        std::shared_ptr<const std::vector<Job>> jobs;
+        std::shared_ptr<const std::unordered_set<std::string>> favoriteUrls;
+        int sortColumn;
+        bool ascending;
+        std::string filter;
+        FacetSelection facets;
+        bool collapseDuplicates;
+    };
+    // Everything a view model is derived from
+
+    std::mutex inputMutex;
+    // Mutex for the inputs shared with the build task
+
+    std::condition_variable cv;
+    // Condition variable signalled when the build task finishes
+
+    bool buildScheduled;
+    // Flag to indicate a build task is queued or running; builds never overlap
+
+    bool inputsChanged;
+    // Flag to indicate inputs that have not been built yet
+
+    Inputs inputs;
+    // Latest inputs from the UI thread
+
+    std::shared_ptr<const ResultsViewModel> published;
+    // Latest view model, swapped atomically by the build task and read atomically by the UI
+
+    std::shared_ptr<const std::vector<Job>> keyedJobs;
+    // Snapshot the sort keys belong to (build task only)
+
+    SortKeys keys;
+    // Sort keys of keyedJobs (build task only)
+
+    DuplicateDetector duplicates;
+    // Fingerprints of the jobs of recent snapshots (build task only)
+
+    void scheduleBuild();
+    // Queues a build task after an input change, unless one is already queued or running
+
+    void runBuilds();
+    // Function that runs as a task: builds view models until the inputs stop changing
+
+    void buildSortKeys(const std::vector<Job>& source);
+    // Computes the sort keys of a snapshot
+
+    void buildFuzzyIndex();
+    // Indexes the trigrams of the title and company keys
+
+    std::vector<int> buildOrder(const Inputs& current, std::vector<FacetValue> (&facets)[FacetCount]);
+    // Filters and sorts the job indices of a snapshot, and counts the facet values of the filtered jobs (not
+    // const: the facet engine caches the job sets of recent selections)
+
+    std::shared_ptr<ResultsViewModel> buildViewModel(const Inputs& current);
+    // Builds the render-ready rows
+};
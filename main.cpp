@@ -12,6 +12,15 @@
 #include <backends/imgui_impl_glfw.h>
 // Include the ImGui implementation for GLFW
 
+#include "FontAtlasCache.h"
+// Include the on-disk cache for the baked font atlas
+
+#include "Profiler.h"
+// Include the profiler, which measures the CPU time of each frame
+
+#include "Trace.h"
+// Include the tracer, which records each frame as a span in the timeline
+
 int main() {
     // The main function, entry point of the program
 
@@ -28,6 +37,9 @@ int main() {
     glfwMakeContextCurrent(window);
     // Make the created window's OpenGL context current
 
+    Profiler::installImGuiAllocator();
+    // Count ImGui's allocations in the profiler overlay too
+
     ImGui::CreateContext();
     // Create an ImGui context
 
@@ -58,8 +70,12 @@ int main() {
         return 1;
     }
 
-    // Build the font atlas
-    io.Fonts->Build();
+    // Build the font atlas, reusing the baked copy from a previous launch when possible
+    FontAtlasCache fontAtlasCache("fontatlas.cache");
+    bool atlasFromCache = fontAtlasCache.build(io.Fonts);
+    std::cout << "Font atlas built in " << fontAtlasCache.getLastBuildMs() << " ms ("
+        << (atlasFromCache ? "warm start, loaded from cache" : "cold start, rasterized") << ")" << std::endl;
+    // Log the build time so cold and warm startups can be compared
 
 
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
@@ -88,14 +104,23 @@ int main() {
     ImGui_ImplOpenGL3_Init("#version 130");
     // Initialize ImGui for use with GLFW and OpenGL
 
+    Trace::setThreadName("UI");
+    // Name the main thread in traces
+
     UserInterface ui;
     // Create an instance of the UserInterface class
 
     while (!glfwWindowShouldClose(window)) {
         // Main application loop, continue until the window should close
+        TRACE_SCOPE("Frame", "ui");
+        // The whole frame, including event polling and the buffer swap
+
         glfwPollEvents();
         // Process any pending events (keyboard, mouse, etc.)
 
+        Profiler::beginFrame();
+        // Start measuring the CPU work of this frame (no-op unless the overlay is open)
+
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -107,6 +132,9 @@ int main() {
         ImGui::Render();
         // Finish the ImGui frame
 
+        Profiler::endFrame();
+        // Stop measuring before the buffer swap, which waits for vsync
+
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         // Render the ImGui draw data
 